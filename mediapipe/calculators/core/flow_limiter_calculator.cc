@@ -0,0 +1,149 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <deque>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/calculators/core/flow_limiter_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+
+namespace mediapipe {
+
+    // Keeps a real-time pipeline from building latency: passes frames on only
+    // while fewer than max_in_flight of them are being worked on downstream,
+    // and drops the oldest frames beyond that rather than queueing them. The
+    // pipeline's final output, fed back as FINISHED, tells which frames are
+    // done:
+    //
+    // node {
+    //   calculator: "FlowLimiterCalculator"
+    //   input_stream: "input_frames"
+    //   input_stream: "FINISHED:detections"
+    //   input_stream_info { tag_index: "FINISHED" back_edge: true }
+    //   input_stream_handler {
+    //     input_stream_handler: "ImmediateInputStreamHandler"
+    //   }
+    //   output_stream: "frames"
+    //   node_options {
+    //     [type.googleapis.com/mediapipe.FlowLimiterCalculatorOptions] {
+    //       max_in_flight: 1
+    //     }
+    //   }
+    // }
+    //
+    // A FINISHED packet at a timestamp finishes every frame in flight up to
+    // it, so the pipeline may skip outputs for some frames. Set
+    // in_flight_timeout_us if it may skip the last ones, which would
+    // otherwise stay in flight. Timeouts are checked whenever a frame or a
+    // FINISHED packet arrives; with neither, timed-out frames wait for the
+    // next one.
+    //
+    // Dropped frames, and frames still waiting at the end of the run, are
+    // counted in Node/<node>/dropped_frames. The output's timestamp bound
+    // moves past them, so synchronized nodes downstream need not wait.
+    class FlowLimiterCalculator : public CalculatorBase {
+      public:
+        absl::Status Open(CalculatorContext* cc) override {
+          const auto& inputs = cc->Inputs().TagMap();
+          const auto& outputs = cc->Outputs().TagMap();
+          if (inputs->NumEntries() != 2 || inputs->GetId("", 0) < 0 ||
+              !inputs->HasTag("FINISHED") || outputs->NumEntries() != 1 ||
+              outputs->GetId("", 0) < 0) {
+            return absl::InvalidArgumentError(absl::StrCat(
+                "Node \"", cc->NodeName(), "\" must have one untagged input ",
+                "stream, a FINISHED input stream and one untagged output "
+                "stream."));
+          }
+          options_ = cc->Options<FlowLimiterCalculatorOptions>();
+          if (options_.max_in_flight() < 0 || options_.max_in_queue() < 0) {
+            return absl::InvalidArgumentError(absl::StrCat(
+                "max_in_flight and max_in_queue of node \"", cc->NodeName(),
+                "\" must not be negative."));
+          }
+          max_in_flight_ = std::max(1, options_.max_in_flight());
+          in_flight_timeout_ =
+              absl::Microseconds(options_.in_flight_timeout_us());
+          dropped_frames_ = cc->GetCounter("dropped_frames");
+          return absl::OkStatus();
+        }
+
+        absl::Status Process(CalculatorContext* cc) override {
+          InputStreamShard& finished = cc->Inputs().Tag("FINISHED");
+          if (!finished.IsEmpty()) {
+            Timestamp timestamp = finished.Value().Timestamp();
+            while (!in_flight_.empty() &&
+                   in_flight_.front().first <= timestamp) {
+              in_flight_.pop_front();
+            }
+          }
+          if (in_flight_timeout_ > absl::ZeroDuration()) {
+            const absl::Time expired = absl::Now() - in_flight_timeout_;
+            while (!in_flight_.empty() &&
+                   in_flight_.front().second < expired) {
+              in_flight_.pop_front();
+            }
+          }
+
+          InputStreamShard& frame = cc->Inputs().Index(0);
+          Timestamp dropped = Timestamp::Unset();
+          if (!frame.IsEmpty()) {
+            waiting_.push_back(frame.Consume());
+            if (static_cast<int>(waiting_.size()) > options_.max_in_queue() &&
+                static_cast<int>(in_flight_.size()) >= max_in_flight_) {
+              dropped = waiting_.front().Timestamp();
+              waiting_.pop_front();
+              dropped_frames_->Increment();
+            }
+          }
+
+          OutputStreamShard& output = cc->Outputs().Index(0);
+          while (!waiting_.empty() &&
+                 static_cast<int>(in_flight_.size()) < max_in_flight_) {
+            in_flight_.emplace_back(waiting_.front().Timestamp(), absl::Now());
+            output.AddPacket(std::move(waiting_.front()));
+            waiting_.pop_front();
+          }
+          if (dropped != Timestamp::Unset()) {
+            output.SetNextTimestampBound(waiting_.empty()
+                                             ? dropped.NextAllowedInStream()
+                                             : waiting_.front().Timestamp());
+          }
+          return absl::OkStatus();
+        }
+
+        absl::Status Close(CalculatorContext* /*cc*/) override {
+          dropped_frames_->IncrementBy(static_cast<int>(waiting_.size()));
+          waiting_.clear();
+          return absl::OkStatus();
+        }
+
+      private:
+        FlowLimiterCalculatorOptions options_;
+        int max_in_flight_ = 1;
+        absl::Duration in_flight_timeout_;
+        Counter* dropped_frames_ = nullptr;
+        // Frames passed on and not finished yet, with the time they were
+        // passed on, oldest first.
+        std::deque<std::pair<Timestamp, absl::Time>> in_flight_;
+        // Frames waiting to be passed on, oldest first.
+        std::deque<Packet> waiting_;
+    };
+    REGISTER_CALCULATOR(FlowLimiterCalculator);
+
+}  // namespace mediapipe
@@ -0,0 +1,139 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// End-to-end latency of a camera pipeline under overload: frames arrive
+// every millisecond at a node that takes three. Compares queueing every
+// frame, a FlowLimiterCalculator in front of the node, and a deadline on
+// the node. Latency runs from a frame's capture time to its output, so it
+// includes any time spent waiting to enter the graph.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/calculators/core/flow_limiter_calculator.pb.h"
+#include "mediapipe/framework/benchmark_util.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_graph.h"
+#include "mediapipe/framework/port/benchmark.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kNumFrames = 100;
+constexpr absl::Duration kFramePeriod = absl::Milliseconds(1);
+constexpr absl::Duration kWork = absl::Milliseconds(3);
+
+// Stands in for inference: takes kWork per frame and forwards it.
+class SlowCalculator : public CalculatorBase {
+ public:
+  absl::Status Process(CalculatorContext* cc) override {
+    absl::SleepFor(kWork);
+    cc->Outputs().Index(0).AddPacket(cc->Inputs().Index(0).Consume());
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(SlowCalculator);
+
+enum class Limit { kNone, kFlowLimiter, kDeadline };
+
+// in -> [limiter ->] slow -> out. Frames carry their capture time. A
+// second thread lets the limiter run while the slow node works.
+CalculatorGraphConfig OverloadConfig(Limit limit) {
+  CalculatorGraphConfig config;
+  config.set_num_threads(2);
+  config.add_input_stream("in");
+  std::string frames = "in";
+  if (limit == Limit::kFlowLimiter) {
+    CalculatorGraphConfig::Node* node = config.add_node();
+    node->set_name("limiter");
+    node->set_calculator("FlowLimiterCalculator");
+    node->add_input_stream("in");
+    node->add_input_stream("FINISHED:out");
+    InputStreamInfo* finished = node->add_input_stream_info();
+    finished->set_tag_index("FINISHED");
+    finished->set_back_edge(true);
+    node->mutable_input_stream_handler()->set_input_stream_handler(
+        "ImmediateInputStreamHandler");
+    node->add_output_stream("frames");
+    FlowLimiterCalculatorOptions options;
+    options.set_max_in_flight(1);
+    node->add_node_options()->PackFrom(options);
+    frames = "frames";
+  }
+  CalculatorGraphConfig::Node* node = config.add_node();
+  node->set_name("slow");
+  node->set_calculator("SlowCalculator");
+  node->add_input_stream(frames);
+  node->add_output_stream("out");
+  if (limit == Limit::kDeadline) {
+    node->set_deadline_us(absl::ToInt64Microseconds(2 * kWork));
+  }
+  return config;
+}
+
+void BM_Overload(benchmark::State& state, Limit limit) {
+  const CalculatorGraphConfig config = OverloadConfig(limit);
+  absl::Mutex mu;
+  std::vector<absl::Duration> latencies;
+  for (auto _ : state) {
+    CalculatorGraph graph;
+    ABSL_CHECK_OK(graph.Initialize(config));
+    ABSL_CHECK_OK(graph.ObserveOutputStream("out", [&](const Packet& packet) {
+      const absl::Duration latency =
+          absl::Now() - absl::FromUnixMicros(packet.Get<int64_t>());
+      absl::MutexLock lock(&mu);
+      latencies.push_back(latency);
+      return absl::OkStatus();
+    }));
+    ABSL_CHECK_OK(graph.StartRun());
+    const absl::Time start = absl::Now();
+    for (int i = 0; i < kNumFrames; ++i) {
+      const absl::Time capture = start + i * kFramePeriod;
+      absl::SleepFor(capture - absl::Now());
+      ABSL_CHECK_OK(graph.AddPacketToInputStream(
+          "in", MakePacket<int64_t>(absl::ToUnixMicros(capture))
+                    .At(Timestamp(i))));
+    }
+    ABSL_CHECK_OK(graph.CloseAllInputStreams());
+    ABSL_CHECK_OK(graph.WaitUntilDone());
+  }
+  absl::MutexLock lock(&mu);
+  state.counters["p50_latency_ms"] = PercentileMs(latencies, 0.5);
+  state.counters["p99_latency_ms"] = PercentileMs(latencies, 0.99);
+  state.counters["delivered_fraction"] =
+      static_cast<double>(latencies.size()) /
+      (static_cast<double>(state.iterations()) * kNumFrames);
+}
+BENCHMARK_CAPTURE(BM_Overload, QueueAll, Limit::kNone)
+    ->Iterations(5)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Overload, FlowLimiter, Limit::kFlowLimiter)
+    ->Iterations(5)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Overload, Deadline, Limit::kDeadline)
+    ->Iterations(5)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace mediapipe
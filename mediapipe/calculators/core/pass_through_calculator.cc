@@ -0,0 +1,72 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/calculator_framework.h"
+
+namespace mediapipe {
+
+    // Forwards every input packet, unchanged, to the output stream with the
+    // same tag and index. Any number of streams is supported:
+    //
+    // node {
+    //   calculator: "PassThroughCalculator"
+    //   input_stream: "VIDEO:frames"
+    //   input_stream: "boxes"
+    //   output_stream: "VIDEO:frames_out"
+    //   output_stream: "boxes_out"
+    // }
+    //
+    // Packets are moved from the inputs to the outputs, so forwarding never
+    // copies a payload nor touches its reference count. The outputs have an
+    // offset of 0, which forwards the timestamp bounds of the inputs as well.
+    //
+    // Supports batches: with max_batch_size set on the node, a single
+    // Process() call forwards all ready timestamps, up to that many.
+    class PassThroughCalculator : public CalculatorBase {
+      public:
+        absl::Status Open(CalculatorContext* cc) override {
+          const auto& inputs = cc->Inputs().TagMap();
+          const auto& outputs = cc->Outputs().TagMap();
+          bool matches = inputs->NumEntries() == outputs->NumEntries();
+          for (int id = 0; matches && id < inputs->NumEntries(); ++id) {
+            matches = inputs->TagAndIndexFromId(id) ==
+                      outputs->TagAndIndexFromId(id);
+          }
+          if (!matches) {
+            return absl::InvalidArgumentError(absl::StrCat(
+                "The output streams of node \"", cc->NodeName(),
+                "\" must have the same tags and indices as its input streams."));
+          }
+          cc->SetOffset(TimestampDiff(0));
+          return absl::OkStatus();
+        }
+
+        absl::Status Process(CalculatorContext* cc) override {
+          for (int i = 0; i < cc->BatchSize(); ++i) {
+            InputStreamShardSet& inputs = cc->Inputs(i);
+            for (int id = 0; id < inputs.NumEntries(); ++id) {
+              if (inputs.Get(id).IsEmpty()) continue;
+              cc->Outputs().Get(id).AddPacket(inputs.Get(id).Consume());
+            }
+          }
+          return absl::OkStatus();
+        }
+
+        bool SupportsBatches() const override { return true; }
+    };
+    REGISTER_CALCULATOR(PassThroughCalculator);
+
+}  // namespace mediapipe
@@ -0,0 +1,87 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// A simple example to print out "Hello World!" from a MediaPipe graph, and
+// how long each greeting took to get through it.
+
+#include <string>
+
+#include "absl/log/absl_check.h"
+#include "absl/log/absl_log.h"
+#include "absl/status/status.h"
+#include "google/protobuf/text_format.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_graph.h"
+
+namespace mediapipe {
+
+    absl::Status PrintHelloWorld() {
+      // Configures a simple graph, which concatenates 2 PassThroughCalculators,
+      // and traces the latency of its packets.
+      CalculatorGraphConfig config;
+      ABSL_CHECK(google::protobuf::TextFormat::ParseFromString(R"pb(
+        input_stream: "in"
+        output_stream: "out"
+        node {
+          calculator: "PassThroughCalculator"
+          input_stream: "in"
+          output_stream: "out1"
+        }
+        node {
+          calculator: "PassThroughCalculator"
+          input_stream: "out1"
+          output_stream: "out"
+        }
+        profiler_config { trace_packet_latency: true }
+      )pb", &config));
+
+      CalculatorGraph graph;
+      absl::Status status = graph.Initialize(config);
+      if (!status.ok()) return status;
+      status = graph.ObserveOutputStream("out", [](const Packet& packet) {
+        ABSL_LOG(INFO) << packet.Get<std::string>();
+        return absl::OkStatus();
+      });
+      if (!status.ok()) return status;
+      status = graph.StartRun();
+      if (!status.ok()) return status;
+      // Gives 10 input packets that contain the same string "Hello World!".
+      for (int i = 0; i < 10; ++i) {
+        status = graph.AddPacketToInputStream(
+            "in", MakePacket<std::string>("Hello World!").At(Timestamp(i)));
+        if (!status.ok()) return status;
+      }
+      // Closes the input stream "in".
+      status = graph.CloseInputStream("in");
+      if (!status.ok()) return status;
+      status = graph.WaitUntilDone();
+      if (!status.ok()) return status;
+
+      HistogramSnapshot latency =
+          graph.GetCounterFactory()
+              ->GetHistogram("OutputStream/out/end_to_end_latency_us")
+              ->Snapshot();
+      ABSL_LOG(INFO) << "End-to-end latency: p50 " << latency.P50()
+                     << " us, p99 " << latency.P99() << " us, max "
+                     << latency.max() << " us over " << latency.count()
+                     << " packets.";
+      return absl::OkStatus();
+    }
+
+}  // namespace mediapipe
+
+int main() {
+  ABSL_CHECK(mediapipe::PrintHelloWorld().ok());
+  return 0;
+}
@@ -0,0 +1,154 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// A chain of 10 calculators that each draw on a 720p frame, copying it
+// before drawing or modifying it through GetMutable(), which copies only
+// if the frame is shared. Reports the bytes copied per frame.
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_graph.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/benchmark.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kNumStages = 10;
+constexpr int kNumFrames = 50;
+constexpr int kWidth = 1280;
+constexpr int kHeight = 720;
+
+std::atomic<int64_t> bytes_copied{0};
+
+int64_t FrameBytes(const ImageFrame& frame) {
+  return static_cast<int64_t>(frame.WidthStep()) * frame.Height();
+}
+
+// Draws a line across the frame, at a row that depends on the node.
+void Annotate(CalculatorContext* cc, ImageFrame* frame) {
+  const int y = static_cast<int>(cc->NodeName().back() - '0') % kHeight;
+  uint8_t* row = frame->MutableRow(y);
+  for (int x = 0; x < frame->Width() * 3; ++x) row[x] = 255;
+}
+
+// Copies its input before drawing, as it must with Get() alone.
+class CopyAnnotatorCalculator : public CalculatorBase {
+ public:
+  absl::Status Process(CalculatorContext* cc) override {
+    const ImageFrame& input = cc->Inputs().Index(0).Get<ImageFrame>();
+    Packet packet = MakePacket<ImageFrame>();
+    ImageFrame* frame = packet.GetMutable<ImageFrame>();
+    frame->CopyFrom(input);
+    bytes_copied.fetch_add(FrameBytes(*frame), std::memory_order_relaxed);
+    Annotate(cc, frame);
+    cc->Outputs().Index(0).AddPacket(
+        std::move(packet).At(cc->InputTimestamp()));
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(CopyAnnotatorCalculator);
+
+// Draws on its input in place unless it is shared, and forwards it.
+class InPlaceAnnotatorCalculator : public CalculatorBase {
+ public:
+  absl::Status Process(CalculatorContext* cc) override {
+    bool copied = false;
+    ImageFrame* frame =
+        cc->Inputs().Index(0).GetMutable<ImageFrame>(&copied);
+    if (copied) {
+      bytes_copied.fetch_add(FrameBytes(*frame), std::memory_order_relaxed);
+    }
+    Annotate(cc, frame);
+    cc->Outputs().Index(0).AddPacket(cc->Inputs().Index(0).Consume());
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(InPlaceAnnotatorCalculator);
+
+// Holds on to its latest input, as a display does until the next frame,
+// so the chain shares that frame.
+class DisplayCalculator : public CalculatorBase {
+ public:
+  absl::Status Process(CalculatorContext* cc) override {
+    shown_ = cc->Inputs().Index(0).Value();
+    return absl::OkStatus();
+  }
+
+ private:
+  Packet shown_;
+};
+REGISTER_CALCULATOR(DisplayCalculator);
+
+// A chain of kNumStages annotators on "in", and with fan_out a display of
+// "in" as well; GetMutable() then copies the frames the display still shows
+// when the first annotator gets them. Only sending the frames and draining
+// the graph is timed.
+void BM_AnnotationChain(benchmark::State& state, const char* annotator,
+                        bool fan_out) {
+  CalculatorGraphConfig config;
+  config.set_num_threads(1);
+  config.add_input_stream("in");
+  std::string input = "in";
+  for (int i = 0; i < kNumStages; ++i) {
+    CalculatorGraphConfig::Node* node = config.add_node();
+    node->set_name(absl::StrCat("annotate_", i));
+    node->set_calculator(annotator);
+    node->add_input_stream(input);
+    input = absl::StrCat("annotated_", i);
+    node->add_output_stream(input);
+  }
+  if (fan_out) {
+    CalculatorGraphConfig::Node* node = config.add_node();
+    node->set_calculator("DisplayCalculator");
+    node->add_input_stream("in");
+  }
+  bytes_copied = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    CalculatorGraph graph;
+    ABSL_CHECK_OK(graph.Initialize(config));
+    ABSL_CHECK_OK(graph.StartRun());
+    state.ResumeTiming();
+    for (int i = 0; i < kNumFrames; ++i) {
+      ABSL_CHECK_OK(graph.AddPacketToInputStream(
+          "in", MakePacket<ImageFrame>(ImageFormat::kSrgb, kWidth, kHeight)
+                    .At(Timestamp(i))));
+    }
+    ABSL_CHECK_OK(graph.CloseAllInputStreams());
+    ABSL_CHECK_OK(graph.WaitUntilDone());
+  }
+  const double num_frames = static_cast<double>(state.iterations()) * kNumFrames;
+  state.SetItemsProcessed(state.iterations() * kNumFrames);
+  state.counters["bytes_copied_per_frame"] = bytes_copied / num_frames;
+}
+BENCHMARK_CAPTURE(BM_AnnotationChain, Copy, "CopyAnnotatorCalculator", false)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(BM_AnnotationChain, GetMutable, "InPlaceAnnotatorCalculator",
+                  false)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(BM_AnnotationChain, GetMutableFanOut,
+                  "InPlaceAnnotatorCalculator", true)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,27 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/benchmark_util.h"
+
+#include <algorithm>
+
+namespace mediapipe {
+    double PercentileMs(std::vector<absl::Duration> latencies, double fraction) {
+      if (latencies.empty()) return 0;
+      auto nth = latencies.begin() +
+                 static_cast<int>(fraction * (latencies.size() - 1));
+      std::nth_element(latencies.begin(), nth, latencies.end());
+      return absl::ToDoubleMilliseconds(*nth);
+    }
+}  // namespace mediapipe
@@ -0,0 +1,30 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Helpers shared by the *_benchmark.cc binaries.
+
+#ifndef CUSTOM_MEDIAPIPE_BENCHMARK_UTIL_H
+#define CUSTOM_MEDIAPIPE_BENCHMARK_UTIL_H
+
+#include <vector>
+
+#include "absl/time/time.h"
+
+namespace mediapipe {
+    // Returns the latency at fraction (0.5 for the median, 0.99 for p99) of
+    // latencies, in milliseconds, or 0 if latencies is empty.
+    double PercentileMs(std::vector<absl::Duration> latencies, double fraction);
+}  // namespace mediapipe
+
+#endif  // CUSTOM_MEDIAPIPE_BENCHMARK_UTIL_H
@@ -0,0 +1,182 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/buffer_pool.h"
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace mediapipe {
+
+    namespace {
+        constexpr std::align_val_t kAlign{BufferPool::kAlignment};
+
+        uint8_t* AllocateAligned(size_t bytes) {
+          return static_cast<uint8_t*>(::operator new(bytes, kAlign));
+        }
+
+        void FreeAligned(uint8_t* data) { ::operator delete(data, kAlign); }
+
+        // bytes_held changes by one buffer at a time, which Counter's int
+        // increments hold for every size class.
+        static_assert(BufferPool::kMaxPooledSize <=
+                      static_cast<size_t>(std::numeric_limits<int>::max()));
+
+        // A pool counter in a graph's counter set.
+        class ExportedCounter : public Counter {
+          public:
+            ExportedCounter(Counter* counter, std::shared_ptr<BufferPool> pool)
+                : counter_(counter), pool_(std::move(pool)) {}
+
+            void Increment() override { counter_->Increment(); }
+            void IncrementBy(int amount) override {
+              counter_->IncrementBy(amount);
+            }
+            int64_t Get() override { return counter_->Get(); }
+
+          private:
+            Counter* const counter_;
+            const std::shared_ptr<BufferPool> pool_;
+        };
+    }  // namespace
+
+    BufferPool::Buffer& BufferPool::Buffer::operator=(Buffer&& other) noexcept {
+      if (this != &other) {
+        Release();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        pool_ = std::move(other.pool_);
+      }
+      return *this;
+    }
+
+    void BufferPool::Buffer::Release() {
+      if (data_ == nullptr) return;
+      if (pool_ != nullptr) {
+        pool_->Release(data_, size_);
+        pool_.reset();
+      } else {
+        FreeAligned(data_);
+      }
+      data_ = nullptr;
+      size_ = 0;
+    }
+
+    std::shared_ptr<BufferPool> BufferPool::Create(Options options) {
+      return std::shared_ptr<BufferPool>(new BufferPool(options));
+    }
+
+    BufferPool::BufferPool(Options options)
+        : options_(options),
+          hits_(counter_factory_.GetCounter("BufferPool/hits")),
+          misses_(counter_factory_.GetCounter("BufferPool/misses")),
+          bytes_held_(counter_factory_.GetCounter("BufferPool/bytes_held")) {}
+
+    BufferPool::~BufferPool() { Trim(); }
+
+    void BufferPool::ExportCounters(CounterSet* counter_set) {
+      CounterSet* own_counters = GetCounterSet();
+      for (const auto& [name, value] : own_counters->GetCountersValues()) {
+        counter_set->Emplace<ExportedCounter>(name, own_counters->Get(name),
+                                              shared_from_this());
+      }
+    }
+
+    // Size classes: 64 bytes, then four per power of two: 80, 96, 112, 128,
+    // 160, 192, 224, 256, 320, ...
+    int BufferPool::SizeClassIndex(size_t size) {
+      if (size <= 64) return 0;
+      const size_t n = size - 1;
+      const int log2 = 63 - __builtin_clzll(n);
+      const int quarter = static_cast<int>(n >> (log2 - 2)) & 3;
+      return 1 + (log2 - 6) * 4 + quarter;
+    }
+
+    size_t BufferPool::SizeClassBytes(int index) {
+      if (index == 0) return 64;
+      const int log2 = 6 + (index - 1) / 4;
+      const int quarter = (index - 1) % 4;
+      return static_cast<size_t>(5 + quarter) << (log2 - 2);
+    }
+
+    BufferPool::Buffer BufferPool::Acquire(size_t size) {
+      if (size > kMaxPooledSize) {
+        misses_->Increment();
+        return AcquireUnpooled(size);
+      }
+      const int index = SizeClassIndex(size);
+      Buffer buffer;
+      {
+        SizeClass& size_class = size_classes_[index];
+        absl::MutexLock lock(&size_class.mu);
+        if (!size_class.free_buffers.empty()) {
+          buffer.data_ = size_class.free_buffers.back();
+          size_class.free_buffers.pop_back();
+        }
+      }
+      if (buffer.data_ != nullptr) {
+        hits_->Increment();
+      } else {
+        misses_->Increment();
+        const size_t bytes = SizeClassBytes(index);
+        buffer.data_ = AllocateAligned(bytes);
+        bytes_held_->IncrementBy(static_cast<int>(bytes));
+      }
+      buffer.size_ = size;
+      buffer.pool_ = shared_from_this();
+      return buffer;
+    }
+
+    BufferPool::Buffer BufferPool::AcquireUnpooled(size_t size) {
+      Buffer buffer;
+      buffer.data_ = AllocateAligned(size == 0 ? 1 : size);
+      buffer.size_ = size;
+      return buffer;
+    }
+
+    void BufferPool::Release(uint8_t* data, size_t size) {
+      const int index = SizeClassIndex(size);
+      {
+        SizeClass& size_class = size_classes_[index];
+        absl::MutexLock lock(&size_class.mu);
+        if (static_cast<int>(size_class.free_buffers.size()) <
+            options_.max_free_buffers) {
+          size_class.free_buffers.push_back(data);
+          return;
+        }
+      }
+      FreeAligned(data);
+      bytes_held_->IncrementBy(-static_cast<int>(SizeClassBytes(index)));
+    }
+
+    void BufferPool::Trim() {
+      for (int index = 0; index < kNumSizeClasses; ++index) {
+        std::vector<uint8_t*> free_buffers;
+        {
+          SizeClass& size_class = size_classes_[index];
+          absl::MutexLock lock(&size_class.mu);
+          free_buffers.swap(size_class.free_buffers);
+        }
+        const int bytes = static_cast<int>(SizeClassBytes(index));
+        for (uint8_t* data : free_buffers) {
+          FreeAligned(data);
+          bytes_held_->IncrementBy(-bytes);
+        }
+      }
+    }
+
+}  // namespace mediapipe
@@ -0,0 +1,151 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// A pool of large, aligned byte buffers for payloads such as tensors, which
+// calculators allocate anew for every frame. Once a pipeline has warmed up,
+// every buffer it acquires is one an earlier frame released, so a steady
+// stream of frames of the same sizes does not allocate.
+
+#ifndef CUSTOM_MEDIAPIPE_BUFFER_POOL_H
+#define CUSTOM_MEDIAPIPE_BUFFER_POOL_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/counter.h"
+#include "mediapipe/framework/counter_factory.h"
+#include "mediapipe/framework/graph_service.h"
+
+namespace mediapipe {
+    // Buffers are grouped in size classes, four per power of two, so a buffer
+    // is at most 25% larger than requested. Each class keeps up to
+    // max_free_buffers released buffers for reuse; a buffer released to a full
+    // class goes back to the heap.
+    //
+    // A buffer keeps its pool alive, so buffers may outlive the graph that
+    // made them, e.g. in packets the application holds on to.
+    //
+    // The pool reports to GetCounterSet(), and through ExportCounters() to
+    // the counter set of every graph that uses it:
+    //   BufferPool/hits        acquisitions served with a released buffer
+    //   BufferPool/misses      acquisitions that went to the heap
+    //   BufferPool/bytes_held  bytes of all buffers the pool allocated and has
+    //                          not freed, in use or not
+    //
+    // This class is thread safe.
+    class BufferPool : public std::enable_shared_from_this<BufferPool> {
+      public:
+        // Buffers start on a cache line.
+        static constexpr size_t kAlignment = 64;
+        // Larger buffers are allocated and freed every time, and not counted
+        // in bytes_held.
+        static constexpr size_t kMaxPooledSize = size_t{1} << 30;
+
+        struct Options {
+          // Released buffers kept per size class.
+          int max_free_buffers = 16;
+        };
+
+        // A buffer of at least size() bytes. Moving it is cheap; destroying it
+        // returns the memory to the pool.
+        class Buffer {
+          public:
+            Buffer() = default;
+            Buffer(Buffer&& other) noexcept { *this = std::move(other); }
+            Buffer& operator=(Buffer&& other) noexcept;
+            Buffer(const Buffer&) = delete;
+            Buffer& operator=(const Buffer&) = delete;
+            ~Buffer() { Release(); }
+
+            uint8_t* data() const { return data_; }
+            // The size requested.
+            size_t size() const { return size_; }
+            bool empty() const { return data_ == nullptr; }
+            // The pool the buffer returns to; null for unpooled buffers.
+            BufferPool* pool() const { return pool_.get(); }
+
+          private:
+            friend class BufferPool;
+
+            void Release();
+
+            uint8_t* data_ = nullptr;
+            size_t size_ = 0;
+            std::shared_ptr<BufferPool> pool_;
+        };
+
+        static std::shared_ptr<BufferPool> Create(Options options);
+        static std::shared_ptr<BufferPool> Create() {
+          return Create(Options());
+        }
+        ~BufferPool();
+
+        BufferPool(const BufferPool&) = delete;
+        BufferPool& operator=(const BufferPool&) = delete;
+
+        // Returns an uninitialized buffer of size bytes.
+        Buffer Acquire(size_t size);
+
+        // Returns an uninitialized buffer of size bytes that is freed on
+        // release, for callers without a pool.
+        static Buffer AcquireUnpooled(size_t size);
+
+        // Frees all released buffers, e.g. after the frame size changed.
+        void Trim();
+
+        CounterSet* GetCounterSet() { return counter_factory_.GetCounterSet(); }
+        // Adds the pool's counters to counter_set, which then reads and
+        // updates the pool's own. They keep the pool alive while counter_set
+        // exists. Counters counter_set already has by those names are kept.
+        void ExportCounters(CounterSet* counter_set);
+
+      private:
+        // Size classes up to kMaxPooledSize.
+        static constexpr int kNumSizeClasses = 97;
+
+        struct SizeClass {
+          absl::Mutex mu;
+          std::vector<uint8_t*> free_buffers ABSL_GUARDED_BY(mu);
+        };
+
+        explicit BufferPool(Options options);
+
+        static int SizeClassIndex(size_t size);
+        static size_t SizeClassBytes(int index);
+
+        void Release(uint8_t* data, size_t size);
+
+        const Options options_;
+        // Hits are counted on every acquisition, so the counters must not
+        // contend between threads.
+        ShardedCounterFactory counter_factory_;
+        Counter* const hits_;
+        Counter* const misses_;
+        Counter* const bytes_held_;
+        std::array<SizeClass, kNumSizeClasses> size_classes_;
+    };
+
+    // The BufferPool of a graph; see CalculatorContext::GetBufferPool(). Unless
+    // the application sets its own, the graph creates one.
+    inline constexpr GraphService<BufferPool> kBufferPoolService(
+        "mediapipe::kBufferPoolService");
+}  // namespace mediapipe
+
+#endif  // CUSTOM_MEDIAPIPE_BUFFER_POOL_H
@@ -1,3 +0,0 @@
-//
-// Created by MSD on 27/07/2024.
-//
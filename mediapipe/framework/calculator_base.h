@@ -1,8 +1,75 @@
+// Copyright 2019 The MediaPipe Authors.
 //
-// Created by MSD on 27/07/2024.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
 //
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
 
 #ifndef CUSTOM_MEDIAPIPE_CALCULATOR_BASE_H
 #define CUSTOM_MEDIAPIPE_CALCULATOR_BASE_H
 
-#endif //CUSTOM_MEDIAPIPE_CALCULATOR_BASE_H
+#include <memory>
+
+#include "absl/status/status.h"
+#include "mediapipe/framework/calculator_context.h"
+#include "mediapipe/framework/deps/registration.h"
+
+namespace mediapipe {
+    // The base class of all calculators. A calculator is created for each run
+    // of a graph and goes through Open(), any number of Process() calls and
+    // Close(), in that order and never concurrently, except that Process()
+    // calls may overlap if the node sets max_in_flight above 1.
+    //
+    // Returning an error from any of the methods fails the graph run.
+    class CalculatorBase {
+      public:
+        CalculatorBase() = default;
+        virtual ~CalculatorBase() = default;
+
+        // Called before any packet is processed. Packets output here precede
+        // all packets output by Process().
+        virtual absl::Status Open(CalculatorContext* /*cc*/) {
+          return absl::OkStatus();
+        }
+
+        // Called once per input timestamp, with the packets of all input
+        // streams at that timestamp (some of which may be empty).
+        virtual absl::Status Process(CalculatorContext* cc) = 0;
+
+        // Called after all input streams are done.
+        virtual absl::Status Close(CalculatorContext* /*cc*/) {
+          return absl::OkStatus();
+        }
+
+        // Calculators whose Process() handles every item of a batch (see
+        // CalculatorContext::BatchSize()) return true. Only their nodes may
+        // set Node.max_batch_size above 1.
+        virtual bool SupportsBatches() const { return false; }
+    };
+
+    using CalculatorBaseRegistry =
+        GlobalFactoryRegistry<std::unique_ptr<CalculatorBase>>;
+
+    namespace internal {
+        template <typename T>
+        std::unique_ptr<CalculatorBase> CreateCalculator() {
+          return std::make_unique<T>();
+        }
+    }  // namespace internal
+}  // namespace mediapipe
+
+// Makes a calculator class available to graphs under its class name. Use at
+// namespace scope, in the namespace of the calculator.
+#define REGISTER_CALCULATOR(name)                                        \
+  MEDIAPIPE_STATIC_REGISTER_FACTORY_FUNCTION_QUALIFIED(                  \
+      ::mediapipe::CalculatorBaseRegistry, calculator_registration, name, \
+      &::mediapipe::internal::CreateCalculator<name>)
+
+#endif  // CUSTOM_MEDIAPIPE_CALCULATOR_BASE_H
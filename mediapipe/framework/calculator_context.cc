@@ -1,3 +1,39 @@
+// Copyright 2019 The MediaPipe Authors.
 //
-// Created by MSD on 27/07/2024.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
 //
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/calculator_context.h"
+
+#include <utility>
+
+namespace mediapipe {
+
+    CalculatorContext::CalculatorContext(
+        CalculatorState* state, std::shared_ptr<tool::TagMap> input_tag_map,
+        std::shared_ptr<tool::TagMap> output_tag_map)
+        : state_(state),
+          input_tag_map_(std::move(input_tag_map)),
+          outputs_(std::move(output_tag_map)) {}
+
+    InputStreamShardSet* CalculatorContext::AddInputSet(
+        Timestamp input_timestamp) {
+      input_timestamps_.push_back(input_timestamp);
+      inputs_.emplace_back(input_tag_map_);
+      InputStreamShardSet& inputs = inputs_.back();
+      for (int id = 0; id < inputs.NumEntries(); ++id) {
+        inputs.Get(id).name_ = &input_tag_map_->Names()[id];
+      }
+      return &inputs;
+    }
+
+}  // namespace mediapipe
@@ -1,8 +1,140 @@
+// Copyright 2019 The MediaPipe Authors.
 //
-// Created by MSD on 27/07/2024.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
 //
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
 
 #ifndef CUSTOM_MEDIAPIPE_CALCULATOR_CONTEXT_H
 #define CUSTOM_MEDIAPIPE_CALCULATOR_CONTEXT_H
 
-#endif //CUSTOM_MEDIAPIPE_CALCULATOR_CONTEXT_H
+#include <memory>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/buffer_pool.h"
+#include "mediapipe/framework/calculator_state.h"
+#include "mediapipe/framework/counter.h"
+#include "mediapipe/framework/deps/arena.h"
+#include "mediapipe/framework/graph_service.h"
+#include "mediapipe/framework/input_stream_shard.h"
+#include "mediapipe/framework/output_stream_shard.h"
+#include "mediapipe/framework/resources.h"
+#include "mediapipe/framework/timestamp.h"
+#include "mediapipe/framework/tool/tag_map.h"
+
+namespace mediapipe {
+    // What a calculator sees of the graph during a single Open(), Process()
+    // or Close() call: the input packets at one timestamp and the output
+    // streams to send results to. Every call that may run concurrently has
+    // its own context.
+    //
+    // Nodes with Node.max_batch_size above 1 may get the input packets of
+    // several timestamps in one Process() call: consecutive ready timestamps,
+    // in the order the node would otherwise have processed them; see
+    // BatchSize(). The items share Outputs(), to which Process() adds the
+    // outputs of all of them in timestamp order, typically stamped with
+    // InputTimestamp(i). Outputs with an offset follow the last item.
+    class CalculatorContext {
+      public:
+        CalculatorContext(const CalculatorContext&) = delete;
+        CalculatorContext& operator=(const CalculatorContext&) = delete;
+
+        absl::string_view NodeName() const { return state_->NodeName(); }
+
+        // Returns the first of the node's node_options that is a T, e.g. a
+        // FlowLimiterCalculatorOptions, or a default T if there is none.
+        // Unpacks it on every call; read it once in Open().
+        template <typename T>
+        T Options() const {
+          return state_->Options<T>();
+        }
+
+        // Returns the node's counter Node/<node>/<name>; see
+        // CalculatorState::GetCounter().
+        Counter* GetCounter(absl::string_view name) {
+          return state_->GetCounter(name);
+        }
+
+        // Returns the object the application set for service, or null. A
+        // lock-free lookup, cheap enough for every Process() call.
+        template <typename T>
+        T* Service(const GraphService<T>& service) const {
+          return state_->GetServiceObject(service);
+        }
+
+        // Loads resources such as model files; see kResourcesService. Loading
+        // a resource that is loaded already, by any graph, shares its data.
+        const Resources& GetResources() const {
+          return *Service(kResourcesService);
+        }
+
+        // Pools the storage of large per-frame payloads, such as Tensors,
+        // across all calculators of the graph; see kBufferPoolService.
+        BufferPool& GetBufferPool() const {
+          return *Service(kBufferPoolService);
+        }
+
+        // Memory for temporaries of this call, e.g. through ArenaAllocator.
+        // It is reset as soon as the call returns, so nothing allocated here
+        // may be kept or output. Reused across calls, so that steady-state
+        // calls do not call malloc.
+        Arena* Scratch() { return scratch_.get(); }
+
+        // The number of input timestamps of this call. Always 1 in Open(),
+        // Close(), and for calculators that do not support batches.
+        int BatchSize() const { return static_cast<int>(inputs_.size()); }
+
+        // The timestamp of the input packets. Unstarted() in Open() and Done()
+        // in Close(). In a batch, the timestamp of the first item.
+        Timestamp InputTimestamp() const { return input_timestamps_.front(); }
+        Timestamp InputTimestamp(int i) const { return input_timestamps_[i]; }
+
+        // The input packets, of the first item in a batch. Calculators may
+        // move packets out of their inputs, e.g. to forward them.
+        const InputStreamShardSet& Inputs() const { return inputs_.front(); }
+        InputStreamShardSet& Inputs() { return inputs_.front(); }
+        const InputStreamShardSet& Inputs(int i) const { return inputs_[i]; }
+        InputStreamShardSet& Inputs(int i) { return inputs_[i]; }
+        OutputStreamShardSet& Outputs() { return outputs_; }
+
+        // Calls SetOffset(offset) on every output stream. In Open() only.
+        void SetOffset(TimestampDiff offset) {
+          for (OutputStreamShard& output : outputs_) output.SetOffset(offset);
+        }
+
+      private:
+        friend class CalculatorNode;
+
+        // Starts with an empty batch; see AddInputSet().
+        CalculatorContext(CalculatorState* state,
+                          std::shared_ptr<tool::TagMap> input_tag_map,
+                          std::shared_ptr<tool::TagMap> output_tag_map);
+
+        // Appends an item at input_timestamp to the batch and returns its
+        // input set.
+        InputStreamShardSet* AddInputSet(Timestamp input_timestamp);
+
+        CalculatorState* const state_;
+        const std::shared_ptr<tool::TagMap> input_tag_map_;
+        // One entry per item of the batch.
+        std::vector<Timestamp> input_timestamps_;
+        std::vector<InputStreamShardSet> inputs_;
+        OutputStreamShardSet outputs_;
+        // Owned by the node between calls.
+        std::unique_ptr<Arena> scratch_;
+        // The earliest ingestion time of the input packets, which outputs
+        // without one inherit; see Packet::IngestionTime().
+        absl::Time ingestion_time_ = absl::InfinitePast();
+    };
+}  // namespace mediapipe
+
+#endif  // CUSTOM_MEDIAPIPE_CALCULATOR_CONTEXT_H
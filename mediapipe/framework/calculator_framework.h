@@ -56,4 +56,15 @@
 #ifndef CUSTOM_MEDIAPIPE_CALCULATOR_FRAMEWORK_H
 #define CUSTOM_MEDIAPIPE_CALCULATOR_FRAMEWORK_H
 
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_base.h"
+#include "mediapipe/framework/calculator_context.h"
+#include "mediapipe/framework/calculator_graph.h"
+#include "mediapipe/framework/counter_factory.h"
+#include "mediapipe/framework/input_stream_shard.h"
+#include "mediapipe/framework/output_stream_shard.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port.h"
+#include "mediapipe/framework/timestamp.h"
+
 #endif //CUSTOM_MEDIAPIPE_CALCULATOR_FRAMEWORK_H
@@ -0,0 +1,445 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/calculator_graph.h"
+
+#include <algorithm>
+#include <deque>
+#include <thread>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/tool/tag_map.h"
+
+namespace mediapipe {
+
+    namespace {
+        constexpr int kDefaultMaxQueueSize = 100;
+
+        // The stream name in "TAG:index:name", "TAG:name" or "name".
+        absl::Status StreamName(const std::string& tag_index_name,
+                                std::string* name) {
+          std::string tag;
+          int index;
+          return tool::ParseTagIndexName(tag_index_name, &tag, &index, name);
+        }
+    }  // namespace
+
+    CalculatorGraph::CalculatorGraph() = default;
+
+    CalculatorGraph::~CalculatorGraph() {
+      if (started_ && !done_) {
+        Cancel();
+        WaitUntilDone().IgnoreError();
+      }
+    }
+
+    absl::Status CalculatorGraph::Initialize(CalculatorGraphConfig config) {
+      if (initialized_) {
+        return absl::FailedPreconditionError("CalculatorGraph is already initialized.");
+      }
+      config_ = std::move(config);
+      counter_factory_ = std::make_unique<ShardedCounterFactory>();
+      absl::Status scheduler_status = CreateScheduler();
+      if (!scheduler_status.ok()) return scheduler_status;
+      scheduler_->SetIdleCallback([this] {
+        // Lets AddPacketToInputStream() re-evaluate CanAddPackets().
+        { absl::MutexLock lock(&full_streams_mu_); }
+        if (scheduler_->HasError()) return;
+        for (const auto& node : nodes_) node->Unthrottle();
+      });
+      profiler_ = std::make_unique<GraphProfiler>(config_.profiler_config(),
+                                                  counter_factory_.get());
+      int max_queue_size = config_.max_queue_size();
+      if (max_queue_size == 0) max_queue_size = kDefaultMaxQueueSize;
+
+      Resources* resources = service_manager_.GetServiceObject(kResourcesService);
+      if (resources == nullptr) {
+        std::shared_ptr<Resources> default_resources = CreateDefaultResources();
+        resources = default_resources.get();
+        absl::Status status = service_manager_.SetServiceObject(
+            kResourcesService, std::move(default_resources));
+        if (!status.ok()) return status;
+      }
+      BufferPool* buffer_pool =
+          service_manager_.GetServiceObject(kBufferPoolService);
+      if (buffer_pool == nullptr) {
+        std::shared_ptr<BufferPool> default_buffer_pool = BufferPool::Create();
+        buffer_pool = default_buffer_pool.get();
+        absl::Status status = service_manager_.SetServiceObject(
+            kBufferPoolService, std::move(default_buffer_pool));
+        if (!status.ok()) return status;
+      }
+      buffer_pool->ExportCounters(counter_factory_->GetCounterSet());
+      Resources::Options prefetch_options;
+      prefetch_options.prefetch = true;
+      for (const std::string& resource_id : config_.prefetch_resource()) {
+        absl::StatusOr<Resource> resource =
+            resources->Get(resource_id, prefetch_options);
+        if (!resource.ok()) return resource.status();
+        prefetched_resources_.push_back(*std::move(resource));
+      }
+
+      for (const std::string& tag_index_name : config_.input_stream()) {
+        std::string name;
+        absl::Status status = StreamName(tag_index_name, &name);
+        if (!status.ok()) return status;
+        if (!streams_.emplace(name, std::make_unique<OutputStreamManager>(name))
+                 .second) {
+          return absl::InvalidArgumentError(absl::StrCat(
+              "Graph input stream \"", name, "\" is specified twice."));
+        }
+        graph_input_streams_.push_back(name);
+      }
+
+      // Deadlines are measured from the time packets entered the graph.
+      tracks_ingestion_time_ = profiler_->TracesPacketLatency();
+      for (const CalculatorGraphConfig::Node& node : config_.node()) {
+        if (node.deadline_us() > 0) tracks_ingestion_time_ = true;
+      }
+
+      for (int id = 0; id < config_.node_size(); ++id) {
+        auto node = std::make_unique<CalculatorNode>();
+        absl::Status status = node->Initialize(
+            id, config_.node(id), max_queue_size, scheduler_.get(),
+            counter_factory_.get(), &arena_, &service_manager_, profiler_.get());
+        if (!status.ok()) return status;
+        const std::string& executor_name = config_.node(id).executor();
+        auto executor = executor_ids_.find(
+            executor_name.empty() ? kDefaultExecutor : executor_name);
+        if (executor == executor_ids_.end()) {
+          return absl::InvalidArgumentError(absl::StrCat(
+              "Node \"", node->DebugName(), "\" runs on executor \"",
+              executor_name, "\", which the graph does not define."));
+        }
+        node->SetExecutor(executor->second);
+        node->SetTracksIngestionTime(tracks_ingestion_time_);
+        const std::vector<std::string>& names = node->OutputTagMap()->Names();
+        for (int output_id = 0; output_id < static_cast<int>(names.size());
+             ++output_id) {
+          auto inserted = streams_.emplace(
+              names[output_id],
+              std::make_unique<OutputStreamManager>(names[output_id]));
+          if (!inserted.second) {
+            return absl::InvalidArgumentError(absl::StrCat(
+                "Stream \"", names[output_id], "\" is produced more than once; ",
+                "found again as an output of node \"", node->DebugName(), "\"."));
+          }
+          node->SetOutputStream(output_id, inserted.first->second.get());
+          producers_[names[output_id]] = id;
+        }
+        nodes_.push_back(std::move(node));
+      }
+
+      for (const auto& node : nodes_) {
+        const std::vector<std::string>& names = node->InputTagMap()->Names();
+        for (int input_id = 0; input_id < static_cast<int>(names.size());
+             ++input_id) {
+          OutputStreamManager* stream = FindStream(names[input_id]);
+          if (stream == nullptr) {
+            return absl::InvalidArgumentError(absl::StrCat(
+                "Input stream \"", names[input_id], "\" of node \"",
+                node->DebugName(), "\" is not produced by any node and is not a ",
+                "graph input stream."));
+          }
+          InputStreamManager* input = node->InputStream(input_id);
+          stream->AddMirror(input);
+          auto producer = producers_.find(names[input_id]);
+          CalculatorNode* producer_node = producer == producers_.end()
+                                              ? nullptr
+                                              : nodes_[producer->second].get();
+          input->SetBecomesFullCallback([this, producer_node](bool full) {
+            UpdateFullStreams(full);
+            if (producer_node != nullptr) producer_node->OutputQueueFull(full);
+          });
+        }
+      }
+      for (const std::string& tag_index_name : config_.output_stream()) {
+        std::string name;
+        absl::Status status = StreamName(tag_index_name, &name);
+        if (!status.ok()) return status;
+        OutputStreamManager* stream = FindStream(name);
+        if (stream == nullptr) {
+          return absl::InvalidArgumentError(absl::StrCat(
+              "Graph output stream \"", name, "\" is not produced by any node."));
+        }
+        if (profiler_->TracesPacketLatency()) {
+          stream->SetLatencyHistogram(counter_factory_->GetHistogram(
+              absl::StrCat("OutputStream/", name, "/end_to_end_latency_us")));
+        }
+      }
+
+      absl::Status status = SortNodes();
+      if (!status.ok()) return status;
+      initialized_ = true;
+      return absl::OkStatus();
+    }
+
+    absl::Status CalculatorGraph::CreateScheduler() {
+      std::vector<internal::ExecutorOptions> executors(1);
+      executors[0].name = kDefaultExecutor;
+      executors[0].num_threads = config_.num_threads();
+      if (executors[0].num_threads <= 0) {
+        executors[0].num_threads =
+            std::max(1u, std::thread::hardware_concurrency());
+      }
+      executor_ids_[kDefaultExecutor] = 0;
+      for (const ExecutorConfig& config : config_.executor()) {
+        if (config.name().empty() || config.num_threads() < 0 ||
+            config.nice() < -20 || config.nice() > 19) {
+          return absl::InvalidArgumentError(absl::StrCat(
+              "Executor \"", config.name(), "\" needs a name, a non-negative ",
+              "num_threads and a nice value from -20 to 19."));
+        }
+        for (int cpu : config.cpu()) {
+          if (cpu < 0 || cpu >= kMaxCpus) {
+            return absl::InvalidArgumentError(absl::StrCat(
+                "CPU ", cpu, " of executor \"", config.name(),
+                "\" is out of range."));
+          }
+        }
+        internal::ExecutorOptions* options;
+        const int id = static_cast<int>(executors.size());
+        if (config.name() == kDefaultExecutor) {
+          options = &executors[0];
+        } else if (executor_ids_.emplace(config.name(), id).second) {
+          options = &executors.emplace_back();
+          options->name = config.name();
+          options->num_threads = 1;
+        } else {
+          return absl::InvalidArgumentError(absl::StrCat(
+              "Executor \"", config.name(), "\" is defined twice."));
+        }
+        if (config.num_threads() > 0) {
+          options->num_threads = config.num_threads();
+        }
+        options->thread_options.cpus.assign(config.cpu().begin(),
+                                            config.cpu().end());
+        options->thread_options.nice = config.nice();
+      }
+      scheduler_ = std::make_unique<internal::Scheduler>(
+          executors, counter_factory_.get());
+      return absl::OkStatus();
+    }
+
+    absl::Status CalculatorGraph::SortNodes() {
+      const int num_nodes = static_cast<int>(nodes_.size());
+      std::vector<std::vector<int>> consumers(num_nodes);
+      std::vector<int> num_producers(num_nodes, 0);
+      for (const auto& node : nodes_) {
+        std::vector<int> producers;
+        const std::vector<std::string>& names = node->InputTagMap()->Names();
+        for (int input_id = 0; input_id < static_cast<int>(names.size());
+             ++input_id) {
+          if (node->IsBackEdge(input_id)) continue;
+          auto it = producers_.find(names[input_id]);
+          if (it != producers_.end()) producers.push_back(it->second);
+        }
+        std::sort(producers.begin(), producers.end());
+        producers.erase(std::unique(producers.begin(), producers.end()),
+                        producers.end());
+        for (int producer : producers) {
+          consumers[producer].push_back(node->Id());
+          ++num_producers[node->Id()];
+        }
+      }
+
+      // Kahn's algorithm, in config order among independent nodes.
+      std::deque<int> ready;
+      for (int id = 0; id < num_nodes; ++id) {
+        if (num_producers[id] == 0) ready.push_back(id);
+      }
+      while (!ready.empty()) {
+        int id = ready.front();
+        ready.pop_front();
+        node_order_.push_back(id);
+        for (int consumer : consumers[id]) {
+          if (--num_producers[consumer] == 0) ready.push_back(consumer);
+        }
+      }
+      if (static_cast<int>(node_order_.size()) != num_nodes) {
+        return absl::InvalidArgumentError(
+            "The graph contains a cycle; mark the input stream that closes it "
+            "as a back edge in input_stream_info.");
+      }
+
+      std::vector<int> sink_distance(num_nodes, 0);
+      for (auto it = node_order_.rbegin(); it != node_order_.rend(); ++it) {
+        for (int consumer : consumers[*it]) {
+          sink_distance[*it] =
+              std::max(sink_distance[*it], sink_distance[consumer] + 1);
+        }
+        nodes_[*it]->SetPriority(-sink_distance[*it]);
+      }
+      return absl::OkStatus();
+    }
+
+    OutputStreamManager* CalculatorGraph::FindStream(const std::string& name) const {
+      auto it = streams_.find(name);
+      return it == streams_.end() ? nullptr : it->second.get();
+    }
+
+    absl::Status CalculatorGraph::ObserveOutputStream(
+        const std::string& stream_name,
+        std::function<absl::Status(const Packet&)> packet_callback) {
+      if (!initialized_ || started_) {
+        return absl::FailedPreconditionError(
+            "ObserveOutputStream() must be called after Initialize() and before "
+            "StartRun().");
+      }
+      OutputStreamManager* stream = FindStream(stream_name);
+      if (stream == nullptr) {
+        return absl::NotFoundError(
+            absl::StrCat("Unknown stream \"", stream_name, "\"."));
+      }
+      stream->AddObserver(std::move(packet_callback));
+      return absl::OkStatus();
+    }
+
+    absl::Status CalculatorGraph::StartRun() {
+      if (!initialized_) {
+        return absl::FailedPreconditionError("CalculatorGraph is not initialized.");
+      }
+      if (started_) {
+        return absl::FailedPreconditionError("CalculatorGraph has already run.");
+      }
+      started_ = true;
+      service_manager_.Freeze();
+      scheduler_->Start(static_cast<int>(nodes_.size()));
+      for (int id : node_order_) {
+        absl::Status status = nodes_[id]->OpenNode();
+        if (!status.ok()) {
+          scheduler_->RecordError(status);
+          return status;
+        }
+      }
+      return absl::OkStatus();
+    }
+
+    absl::Status CalculatorGraph::Run() {
+      absl::Status status = StartRun();
+      if (!status.ok()) {
+        WaitUntilDone().IgnoreError();
+        return status;
+      }
+      return WaitUntilDone();
+    }
+
+    absl::Status CalculatorGraph::AddPacketToInputStream(
+        const std::string& stream_name, Packet packet) {
+      if (!started_) {
+        return absl::FailedPreconditionError(
+            "AddPacketToInputStream() must be called after StartRun().");
+      }
+      if (tracks_ingestion_time_ &&
+          packet.IngestionTime() == absl::InfinitePast()) {
+        packet = std::move(packet).WithIngestionTime(absl::Now());
+      }
+      if (scheduler_->HasError()) return scheduler_->WaitUntilIdle();
+      auto it = producers_.find(stream_name);
+      OutputStreamManager* stream = FindStream(stream_name);
+      if (stream == nullptr || it != producers_.end()) {
+        return absl::NotFoundError(
+            absl::StrCat("Unknown graph input stream \"", stream_name, "\"."));
+      }
+      {
+        absl::MutexLock lock(&full_streams_mu_);
+        full_streams_mu_.Await(absl::Condition(this, &CalculatorGraph::CanAddPackets));
+      }
+      // Not an initializer list, which would copy the packet and keep a
+      // second reference to the payload while the graph runs; see
+      // Packet::GetMutable().
+      std::vector<Packet> packets;
+      packets.push_back(std::move(packet));
+      absl::MutexLock lock(&input_mu_);
+      return stream->PropagatePackets(std::move(packets));
+    }
+
+    void CalculatorGraph::UpdateFullStreams(bool full) {
+      absl::MutexLock lock(&full_streams_mu_);
+      num_full_streams_ += full ? 1 : -1;
+    }
+
+    bool CalculatorGraph::CanAddPackets() const {
+      // An idle graph with a full queue is stuck until more input arrives,
+      // e.g. a node waiting on its other input streams.
+      return num_full_streams_ == 0 || scheduler_->IsIdleNow() ||
+             scheduler_->HasError();
+    }
+
+    absl::Status CalculatorGraph::SetInputStreamTimestampBound(
+        const std::string& stream_name, Timestamp bound) {
+      OutputStreamManager* stream = FindStream(stream_name);
+      if (stream == nullptr || producers_.count(stream_name) > 0) {
+        return absl::NotFoundError(
+            absl::StrCat("Unknown graph input stream \"", stream_name, "\"."));
+      }
+      absl::MutexLock lock(&input_mu_);
+      stream->SetNextTimestampBound(bound);
+      return absl::OkStatus();
+    }
+
+    absl::Status CalculatorGraph::CloseInputStream(const std::string& stream_name) {
+      OutputStreamManager* stream = FindStream(stream_name);
+      if (stream == nullptr || producers_.count(stream_name) > 0) {
+        return absl::NotFoundError(
+            absl::StrCat("Unknown graph input stream \"", stream_name, "\"."));
+      }
+      absl::MutexLock lock(&input_mu_);
+      stream->Close();
+      return absl::OkStatus();
+    }
+
+    absl::Status CalculatorGraph::CloseAllInputStreams() {
+      absl::MutexLock lock(&input_mu_);
+      for (const std::string& name : graph_input_streams_) {
+        streams_[name]->Close();
+      }
+      return absl::OkStatus();
+    }
+
+    absl::Status CalculatorGraph::WaitUntilIdle() {
+      if (!started_) return absl::OkStatus();
+      return scheduler_->WaitUntilIdle();
+    }
+
+    absl::Status CalculatorGraph::WaitUntilDone() {
+      if (!started_) return absl::OkStatus();
+      absl::Status status = scheduler_->WaitUntilDone();
+      if (!status.ok() && !done_) {
+        // Close whatever the error left open, so calculators can release
+        // their resources.
+        for (int id : node_order_) nodes_[id]->CloseAfterError();
+        scheduler_->WaitUntilIdle().IgnoreError();
+      }
+      const std::string& trace_path = config_.profiler_config().trace_path();
+      if (!done_ && profiler_->IsEnabled() && !trace_path.empty()) {
+        absl::Status trace_status = profiler_->WriteChromeTrace(trace_path);
+        if (status.ok()) status = trace_status;
+      }
+      done_ = true;
+      return status;
+    }
+
+    void CalculatorGraph::Cancel() {
+      if (scheduler_ != nullptr) {
+        scheduler_->RecordError(absl::CancelledError("CalculatorGraph run was cancelled."));
+      }
+    }
+
+    bool CalculatorGraph::HasError() const {
+      return scheduler_ != nullptr && scheduler_->HasError();
+    }
+
+}  // namespace mediapipe
@@ -0,0 +1,216 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Declares CalculatorGraph, which links Calculators into a directed acyclic
+// graph and runs them on a pool of worker threads.
+
+#ifndef CUSTOM_MEDIAPIPE_CALCULATOR_GRAPH_H
+#define CUSTOM_MEDIAPIPE_CALCULATOR_GRAPH_H
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/buffer_pool.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_node.h"
+#include "mediapipe/framework/counter_factory.h"
+#include "mediapipe/framework/deps/arena.h"
+#include "mediapipe/framework/graph_profiler.h"
+#include "mediapipe/framework/graph_service.h"
+#include "mediapipe/framework/graph_service_manager.h"
+#include "mediapipe/framework/output_stream_manager.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/resources.h"
+#include "mediapipe/framework/scheduler.h"
+
+namespace mediapipe {
+    // Runs a CalculatorGraphConfig.
+    //
+    // Ready nodes run on a fixed pool of worker threads (num_threads in the
+    // config) with a task queue per worker and work stealing. Nodes may run on
+    // pools of their own instead, with the config's executors, e.g. so that a
+    // slow node cannot delay the others. When several
+    // nodes are ready, nodes closer to the graph's sinks run first, which
+    // drains packets out of the graph before new ones are admitted and so
+    // bounds the number of packets in flight. Process() calls of one node
+    // never overlap unless the node sets max_in_flight.
+    //
+    // Usage:
+    //   CalculatorGraph graph;
+    //   MP_RETURN_IF_ERROR(graph.Initialize(config));
+    //   MP_RETURN_IF_ERROR(graph.ObserveOutputStream("out", callback));
+    //   MP_RETURN_IF_ERROR(graph.StartRun());
+    //   MP_RETURN_IF_ERROR(graph.AddPacketToInputStream(
+    //       "in", MakePacket<int>(1).At(Timestamp(0))));
+    //   MP_RETURN_IF_ERROR(graph.CloseAllInputStreams());
+    //   MP_RETURN_IF_ERROR(graph.WaitUntilDone());
+    //
+    // Input streams queue at most max_queue_size packets (see
+    // InputStreamInfo). While any BLOCK_UPSTREAM queue is full,
+    // AddPacketToInputStream() waits, and no new Process() call is scheduled
+    // for the node feeding it, unless the graph is idle: then the full queue
+    // can only drain with more input, so the packets are let through. Calls
+    // already running when a queue fills still add their packets, so a queue
+    // may exceed its limit by the output of max_in_flight calls.
+    // Per-stream drop and queue size counters are in GetCounterFactory().
+    //
+    // A graph runs once.
+    class CalculatorGraph {
+      public:
+        CalculatorGraph();
+        // Cancels the run, if any, and waits for it to finish.
+        ~CalculatorGraph();
+        CalculatorGraph(const CalculatorGraph&) = delete;
+        CalculatorGraph& operator=(const CalculatorGraph&) = delete;
+
+        // Validates the config, creates the calculators and loads the
+        // config's prefetch_resource. Unless kResourcesService is set by then,
+        // sets it to CreateDefaultResources(), and likewise kBufferPoolService
+        // to a new BufferPool, whose counters it adds to GetCounterFactory().
+        absl::Status Initialize(CalculatorGraphConfig config);
+
+        const CalculatorGraphConfig& Config() const { return config_; }
+
+        // Calls packet_callback, on a worker thread, with every packet of the
+        // given stream, in timestamp order. Must be called before StartRun().
+        absl::Status ObserveOutputStream(
+            const std::string& stream_name,
+            std::function<absl::Status(const Packet&)> packet_callback);
+
+        // Provides the object of a graph service to the calculators; see
+        // GraphService. Must be called before StartRun(), after which the
+        // services are immutable and calculators read them without locking.
+        template <typename T>
+        absl::Status SetServiceObject(const GraphService<T>& service,
+                                      std::shared_ptr<T> object) {
+          return service_manager_.SetServiceObject(service, std::move(object));
+        }
+        template <typename T>
+        T* GetServiceObject(const GraphService<T>& service) const {
+          return service_manager_.GetServiceObject(service);
+        }
+
+        // Opens all calculators on the calling thread, in topological order,
+        // and starts the workers.
+        absl::Status StartRun();
+
+        // StartRun(), then WaitUntilDone(). For graphs without input streams.
+        absl::Status Run();
+
+        // Sends a packet into a graph input stream. Packets of one stream must
+        // have increasing timestamps. Waits while input streams are full; see
+        // above.
+        absl::Status AddPacketToInputStream(const std::string& stream_name,
+                                            Packet packet)
+            ABSL_LOCKS_EXCLUDED(input_mu_, full_streams_mu_);
+        // Promises that no packet below bound will be added to the graph input
+        // stream, which lets nodes reading it process earlier timestamps
+        // without waiting for its next packet.
+        absl::Status SetInputStreamTimestampBound(const std::string& stream_name,
+                                                  Timestamp bound)
+            ABSL_LOCKS_EXCLUDED(input_mu_);
+        absl::Status CloseInputStream(const std::string& stream_name)
+            ABSL_LOCKS_EXCLUDED(input_mu_);
+        absl::Status CloseAllInputStreams() ABSL_LOCKS_EXCLUDED(input_mu_);
+
+        // Waits until no calculator is running or ready to run. Returns the
+        // error of the run, if any.
+        absl::Status WaitUntilIdle();
+        // Waits until all calculators are closed, or an error stopped the run,
+        // then writes the trace to profiler_config.trace_path, if set.
+        // Returns the error of the run, if any.
+        absl::Status WaitUntilDone();
+
+        // Stops the run with a CANCELLED error.
+        void Cancel();
+        bool HasError() const;
+
+        // The counters of the graph's input stream queues:
+        //   InputStream/<node>/<stream>/dropped_packets
+        //   InputStream/<node>/<stream>/queue_high_water_mark
+        // of its nodes, Node/<node>/..., see CalculatorState, and of its
+        // executors, Executor/<name>/..., see internal::Scheduler.
+        CounterFactory* GetCounterFactory() { return counter_factory_.get(); }
+
+        // Times the calculator calls if the config's profiler_config enables
+        // it; see GraphProfiler. Available after Initialize().
+        GraphProfiler* GetProfiler() { return profiler_.get(); }
+
+      private:
+        // The executor of nodes that set none.
+        static constexpr char kDefaultExecutor[] = "default";
+        // Highest CPU number an executor may be pinned to, plus one.
+        static constexpr int kMaxCpus = 1024;
+
+        // Creates the scheduler with the config's executors.
+        absl::Status CreateScheduler();
+        // Orders the nodes, leaving out back edges, and derives their
+        // priorities from the distance to the nearest graph sink along the
+        // longest path.
+        absl::Status SortNodes();
+        OutputStreamManager* FindStream(const std::string& name) const;
+
+        void UpdateFullStreams(bool full) ABSL_LOCKS_EXCLUDED(full_streams_mu_);
+        bool CanAddPackets() const ABSL_SHARED_LOCKS_REQUIRED(full_streams_mu_);
+
+        CalculatorGraphConfig config_;
+        bool initialized_ = false;
+        bool started_ = false;
+        bool done_ = false;
+
+        // Number of BLOCK_UPSTREAM input streams at their size limit. Declared
+        // before the scheduler, whose tasks may still report while it shuts
+        // down.
+        absl::Mutex full_streams_mu_;
+        int num_full_streams_ ABSL_GUARDED_BY(full_streams_mu_) = 0;
+
+        std::unique_ptr<CounterFactory> counter_factory_;
+        std::unique_ptr<GraphProfiler> profiler_;
+        // Whether graph input packets get their ingestion time: for the
+        // profiler's packet latency, or for node deadlines.
+        bool tracks_ingestion_time_ = false;
+        // Holds the CalculatorStates of the nodes.
+        Arena arena_;
+        GraphServiceManager service_manager_;
+        // The config's prefetch_resource, kept loaded.
+        std::vector<Resource> prefetched_resources_;
+        // Scheduler executor ids, by name.
+        std::map<std::string, int> executor_ids_;
+        // Nodes in config order.
+        std::vector<std::unique_ptr<CalculatorNode>> nodes_;
+        // Node ids in topological order.
+        std::vector<int> node_order_;
+        // Every stream of the graph, by name. Graph input streams have no
+        // producer node.
+        std::map<std::string, std::unique_ptr<OutputStreamManager>> streams_;
+        // Producer node of each stream; absent for graph input streams.
+        std::map<std::string, int> producers_;
+        std::vector<std::string> graph_input_streams_;
+        // Declared after the nodes and streams, which its tasks and idle
+        // callback use, so that its workers are joined before they go away.
+        std::unique_ptr<internal::Scheduler> scheduler_;
+
+        // Serializes producers of graph input streams.
+        absl::Mutex input_mu_;
+    };
+}  // namespace mediapipe
+
+#endif  // CUSTOM_MEDIAPIPE_CALCULATOR_GRAPH_H
@@ -0,0 +1,165 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Frames per second through synthetic graphs: a fan-out/fan-in graph run on 1
+// to 16 worker threads, and a batching node by batch size.
+
+#include <string>
+
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_graph.h"
+#include "mediapipe/framework/port/benchmark.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kNumFrames = 200;
+
+void Spin(absl::Duration duration) {
+  const absl::Time end = absl::Now() + duration;
+  while (absl::Now() < end) {
+  }
+}
+
+// Forwards its input after spinning for the number of microseconds given by
+// the node name's suffix, e.g. "branch0_50", to stand in for real work.
+class SpinCalculator : public CalculatorBase {
+ public:
+  absl::Status Open(CalculatorContext* cc) override {
+    absl::string_view name = cc->NodeName();
+    int64_t us = 0;
+    ABSL_CHECK(absl::SimpleAtoi(name.substr(name.rfind('_') + 1), &us));
+    work_ = absl::Microseconds(us);
+    cc->SetOffset(TimestampDiff(0));
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    Spin(work_);
+    cc->Outputs().Index(0).AddPacket(cc->Inputs().Index(0).Consume());
+    return absl::OkStatus();
+  }
+
+ private:
+  absl::Duration work_;
+};
+REGISTER_CALCULATOR(SpinCalculator);
+
+// Stands in for an inference calculator: every Process() call costs 200us,
+// e.g. to hand the inputs to an accelerator, plus 20us per frame.
+class FakeInferenceCalculator : public CalculatorBase {
+ public:
+  absl::Status Open(CalculatorContext* cc) override {
+    cc->SetOffset(TimestampDiff(0));
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    Spin(absl::Microseconds(200 + 20 * cc->BatchSize()));
+    for (int i = 0; i < cc->BatchSize(); ++i) {
+      cc->Outputs().Index(0).AddPacket(cc->Inputs(i).Index(0).Consume());
+    }
+    return absl::OkStatus();
+  }
+
+  bool SupportsBatches() const override { return true; }
+};
+REGISTER_CALCULATOR(FakeInferenceCalculator);
+
+// Runs kNumFrames packets through config per iteration. Only adding the
+// packets and draining the graph is timed.
+void RunFrames(benchmark::State& state, const CalculatorGraphConfig& config) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    CalculatorGraph graph;
+    ABSL_CHECK_OK(graph.Initialize(config));
+    ABSL_CHECK_OK(graph.StartRun());
+    state.ResumeTiming();
+    for (int i = 0; i < kNumFrames; ++i) {
+      ABSL_CHECK_OK(graph.AddPacketToInputStream(
+          "in", MakePacket<int>(i).At(Timestamp(i))));
+    }
+    ABSL_CHECK_OK(graph.CloseAllInputStreams());
+    ABSL_CHECK_OK(graph.WaitUntilDone());
+  }
+  state.SetItemsProcessed(state.iterations() * kNumFrames);
+}
+
+// "in" fans out to width branches that join in one node with width inputs:
+//
+//   in -> branch_0 --+
+//   in -> branch_1 --+--> join -> out_0 ... out_<width - 1>
+//   ...              |
+//
+// Branches are PassThroughCalculators when spin_us is 0 and SpinCalculators
+// otherwise.
+CalculatorGraphConfig FanOutFanIn(int num_threads, int width, int spin_us) {
+  CalculatorGraphConfig config;
+  config.set_num_threads(num_threads);
+  config.add_input_stream("in");
+  CalculatorGraphConfig::Node* join = config.add_node();
+  join->set_name("join");
+  join->set_calculator("PassThroughCalculator");
+  for (int i = 0; i < width; ++i) {
+    CalculatorGraphConfig::Node* branch = config.add_node();
+    branch->set_name(absl::StrCat("branch", i, "_", spin_us));
+    branch->set_calculator(spin_us > 0 ? "SpinCalculator"
+                                       : "PassThroughCalculator");
+    branch->add_input_stream("in");
+    branch->add_output_stream(absl::StrCat("branch_", i));
+    join->add_input_stream(absl::StrCat("branch_", i));
+    join->add_output_stream(absl::StrCat("out_", i));
+  }
+  config.add_output_stream("out_0");
+  return config;
+}
+
+void BM_FanOutFanIn(benchmark::State& state) {
+  RunFrames(state, FanOutFanIn(state.range(0), /*width=*/8, state.range(1)));
+}
+BENCHMARK(BM_FanOutFanIn)
+    ->ArgNames({"threads", "spin_us"})
+    ->ArgsProduct({{1, 2, 4, 8, 16}, {0, 50}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// Per-frame cost of FakeInferenceCalculator by max_batch_size. Frames are
+// sent as fast as the graph takes them, so batches fill up without waiting.
+void BM_BatchSize(benchmark::State& state) {
+  CalculatorGraphConfig config;
+  config.add_input_stream("in");
+  CalculatorGraphConfig::Node* node = config.add_node();
+  node->set_calculator("FakeInferenceCalculator");
+  node->set_max_batch_size(state.range(0));
+  node->add_input_stream("in");
+  node->add_output_stream("out");
+  RunFrames(state, config);
+}
+BENCHMARK(BM_BatchSize)
+    ->ArgName("max_batch_size")
+    ->RangeMultiplier(2)
+    ->Range(1, 32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,438 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/calculator_graph.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "google/protobuf/text_format.h"
+#include "mediapipe/framework/buffer_pool.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/histogram.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kRepeats = 10;
+
+CalculatorGraphConfig ParseConfig(const std::string& text) {
+  CalculatorGraphConfig config;
+  EXPECT_TRUE(google::protobuf::TextFormat::ParseFromString(text, &config));
+  return config;
+}
+
+// Outputs kRepeats packets for every input packet.
+class RepeatCalculator : public CalculatorBase {
+ public:
+  absl::Status Process(CalculatorContext* cc) override {
+    const int64_t base = cc->InputTimestamp().Value() * kRepeats;
+    for (int i = 0; i < kRepeats; ++i) {
+      cc->Outputs().Index(0).AddPacket(
+          cc->Inputs().Index(0).Value().At(Timestamp(base + i)));
+    }
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(RepeatCalculator);
+
+// Takes a millisecond per packet.
+class SlowSinkCalculator : public CalculatorBase {
+ public:
+  absl::Status Process(CalculatorContext* /*cc*/) override {
+    absl::SleepFor(absl::Milliseconds(1));
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(SlowSinkCalculator);
+
+// Forwards its input to its first output and never touches the second, whose
+// bound only moves when the node closes.
+class FirstOutputCalculator : public CalculatorBase {
+ public:
+  absl::Status Process(CalculatorContext* cc) override {
+    cc->Outputs().Index(0).AddPacket(cc->Inputs().Index(0).Value());
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(FirstOutputCalculator);
+
+std::atomic<int> num_sink_calls{0};
+
+class CountingSinkCalculator : public CalculatorBase {
+ public:
+  absl::Status Process(CalculatorContext* /*cc*/) override {
+    ++num_sink_calls;
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(CountingSinkCalculator);
+
+absl::Mutex record_mu;
+// The input timestamps of every Process() call, in call order.
+std::vector<std::vector<int64_t>> batches ABSL_GUARDED_BY(record_mu);
+std::vector<int64_t> joined ABSL_GUARDED_BY(record_mu);
+
+// Forwards its first input, for every item of a batch, and records the
+// batch. Its second output has an offset and never gets a packet.
+class BatchRecorderCalculator : public CalculatorBase {
+ public:
+  absl::Status Open(CalculatorContext* cc) override {
+    cc->Outputs().Index(1).SetOffset(TimestampDiff(0));
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    std::vector<int64_t> batch;
+    for (int i = 0; i < cc->BatchSize(); ++i) {
+      batch.push_back(cc->InputTimestamp(i).Value());
+      const Packet& packet = cc->Inputs(i).Index(0).Value();
+      if (!packet.IsEmpty()) cc->Outputs().Index(0).AddPacket(packet);
+    }
+    absl::MutexLock lock(&record_mu);
+    batches.push_back(std::move(batch));
+    return absl::OkStatus();
+  }
+
+  bool SupportsBatches() const override { return true; }
+};
+REGISTER_CALCULATOR(BatchRecorderCalculator);
+
+class JoinRecorderCalculator : public CalculatorBase {
+ public:
+  absl::Status Process(CalculatorContext* cc) override {
+    absl::MutexLock lock(&record_mu);
+    joined.push_back(cc->InputTimestamp().Value());
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(JoinRecorderCalculator);
+
+TEST(CalculatorGraphTest, BatchesKeepTimestampOrder) {
+  {
+    absl::MutexLock lock(&record_mu);
+    batches.clear();
+    joined.clear();
+  }
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(ParseConfig(R"pb(
+    input_stream: "a"
+    input_stream: "b"
+    num_threads: 4
+    max_queue_size: -1
+    node {
+      name: "batch"
+      calculator: "BatchRecorderCalculator"
+      input_stream: "a"
+      input_stream: "b"
+      output_stream: "out"
+      output_stream: "offset_out"
+      max_batch_size: 4
+      max_batch_wait_us: 1000
+    }
+    node {
+      name: "join"
+      calculator: "JoinRecorderCalculator"
+      input_stream: "out"
+      input_stream: "offset_out"
+    }
+  )pb")));
+  MP_ASSERT_OK(graph.StartRun());
+  // "a" runs a chunk ahead of "b", which only has even timestamps, so that
+  // the batch node sees timestamps settle several at a time and out of the
+  // order their packets arrived in.
+  constexpr int kChunk = 10;
+  constexpr int kNumTimestamps = 40;
+  for (int chunk = 0; chunk <= kNumTimestamps / kChunk; ++chunk) {
+    for (int t = chunk * kChunk; t < (chunk + 1) * kChunk; ++t) {
+      if (t >= kNumTimestamps) break;
+      MP_ASSERT_OK(graph.AddPacketToInputStream(
+          "a", MakePacket<int>(t).At(Timestamp(t))));
+    }
+    for (int t = (chunk - 1) * kChunk; t < chunk * kChunk; t += 2) {
+      if (t < 0) continue;
+      MP_ASSERT_OK(graph.AddPacketToInputStream(
+          "b", MakePacket<int>(t).At(Timestamp(t))));
+    }
+  }
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+
+  {
+    absl::MutexLock lock(&record_mu);
+    // Everything but the last timestamp, which "b" may still send a packet
+    // at, is processed in order, each timestamp once.
+    std::vector<int64_t> processed;
+    bool batched = false;
+    for (const std::vector<int64_t>& batch : batches) {
+      EXPECT_LE(batch.size(), 4u);
+      batched = batched || batch.size() > 1;
+      processed.insert(processed.end(), batch.begin(), batch.end());
+    }
+    EXPECT_TRUE(batched);
+    std::vector<int64_t> expected;
+    for (int t = 0; t < kNumTimestamps - 1; ++t) expected.push_back(t);
+    EXPECT_EQ(processed, expected);
+    // The join only got there through the bounds of the offset output,
+    // which has no packets.
+    EXPECT_EQ(joined, expected);
+  }
+
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  absl::MutexLock lock(&record_mu);
+  ASSERT_FALSE(batches.empty());
+  EXPECT_EQ(batches.back().back(), kNumTimestamps - 1);
+  EXPECT_EQ(joined.back(), kNumTimestamps - 1);
+}
+
+constexpr absl::Duration kSleep = absl::Milliseconds(20);
+// Generous, for loaded test machines.
+constexpr absl::Duration kLatencyTolerance = absl::Milliseconds(100);
+
+// Outputs a new packet, without an ingestion time of its own, at every
+// input timestamp, kSleep after the inputs arrived.
+class SleepCalculator : public CalculatorBase {
+ public:
+  absl::Status Process(CalculatorContext* cc) override {
+    absl::SleepFor(kSleep);
+    cc->Outputs().Index(0).AddPacket(
+        MakePacket<int>(0).At(cc->InputTimestamp()));
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(SleepCalculator);
+
+// Outputs a new packet at every input timestamp, whatever its inputs.
+class MergeCalculator : public CalculatorBase {
+ public:
+  absl::Status Process(CalculatorContext* cc) override {
+    cc->Outputs().Index(0).AddPacket(
+        MakePacket<int>(0).At(cc->InputTimestamp()));
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(MergeCalculator);
+
+HistogramSnapshot Latency(CalculatorGraph* graph, const std::string& stream) {
+  return graph->GetCounterFactory()
+      ->GetHistogram(
+          absl::StrCat("OutputStream/", stream, "/end_to_end_latency_us"))
+      ->Snapshot();
+}
+
+TEST(CalculatorGraphTest, LatencyIsInheritedThroughNodes) {
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(ParseConfig(R"pb(
+    input_stream: "in"
+    output_stream: "slept"
+    output_stream: "passed"
+    profiler_config { trace_packet_latency: true }
+    node {
+      calculator: "SleepCalculator"
+      input_stream: "in"
+      output_stream: "slept"
+    }
+    node {
+      calculator: "PassThroughCalculator"
+      input_stream: "slept"
+      output_stream: "passed"
+    }
+  )pb")));
+  MP_ASSERT_OK(graph.StartRun());
+  constexpr int kNumFrames = 5;
+  for (int i = 0; i < kNumFrames; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "in", MakePacket<int>(i).At(Timestamp(i))));
+    // One frame at a time, so that frames do not queue behind each other.
+    MP_ASSERT_OK(graph.WaitUntilIdle());
+  }
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  // The new packets of the sleeping node take the ingestion time of its
+  // inputs, and the pass-through node keeps it.
+  for (const char* stream : {"slept", "passed"}) {
+    HistogramSnapshot latency = Latency(&graph, stream);
+    EXPECT_EQ(latency.count(), kNumFrames) << stream;
+    EXPECT_GE(latency.min(), absl::ToInt64Microseconds(kSleep)) << stream;
+    EXPECT_LE(latency.max(),
+              absl::ToInt64Microseconds(kSleep + kLatencyTolerance))
+        << stream;
+  }
+}
+
+TEST(CalculatorGraphTest, FanInTakesEarliestIngestionTime) {
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(ParseConfig(R"pb(
+    input_stream: "early"
+    input_stream: "late"
+    output_stream: "joined"
+    profiler_config { trace_packet_latency: true }
+    node {
+      calculator: "MergeCalculator"
+      input_stream: "early"
+      input_stream: "late"
+      output_stream: "joined"
+    }
+  )pb")));
+  MP_ASSERT_OK(graph.StartRun());
+  constexpr int kNumFrames = 3;
+  for (int i = 0; i < kNumFrames; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "early", MakePacket<int>(i).At(Timestamp(i))));
+    absl::SleepFor(kSleep);
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "late", MakePacket<int>(i).At(Timestamp(i))));
+    MP_ASSERT_OK(graph.WaitUntilIdle());
+  }
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  // The merged packets measure from the earliest input of their Process()
+  // call.
+  HistogramSnapshot latency = Latency(&graph, "joined");
+  EXPECT_EQ(latency.count(), kNumFrames);
+  EXPECT_GE(latency.min(), absl::ToInt64Microseconds(kSleep));
+  EXPECT_LE(latency.max(),
+            absl::ToInt64Microseconds(kSleep + kLatencyTolerance));
+}
+
+TEST(CalculatorGraphTest, FullQueueThrottlesProducingNode) {
+  // "burst" queues kRepeats packets for "repeat" at once, past the graph
+  // input stream, whose own throttle would otherwise pace "repeat". With a
+  // single thread the sink, which runs first, would pace it as well.
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(ParseConfig(R"pb(
+    input_stream: "in"
+    num_threads: 4
+    max_queue_size: 4
+    node {
+      name: "burst"
+      calculator: "RepeatCalculator"
+      input_stream: "in"
+      output_stream: "burst"
+    }
+    node {
+      name: "repeat"
+      calculator: "RepeatCalculator"
+      input_stream: "burst"
+      output_stream: "repeated"
+      input_stream_info { tag_index: ":0" max_queue_size: -1 }
+    }
+    node {
+      name: "sink"
+      calculator: "SlowSinkCalculator"
+      input_stream: "repeated"
+    }
+  )pb")));
+  MP_ASSERT_OK(graph.StartRun());
+  MP_ASSERT_OK(
+      graph.AddPacketToInputStream("in", MakePacket<int>(0).At(Timestamp(0))));
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  // Unthrottled, "repeat" would queue all kRepeats * kRepeats packets well
+  // before the sink is done with the first few. Throttled, the queue only
+  // overshoots by the output of one call.
+  int64_t high_water_mark =
+      graph.GetCounterFactory()
+          ->GetCounter("InputStream/sink/repeated/queue_high_water_mark")
+          ->Get();
+  EXPECT_GE(high_water_mark, 4);
+  EXPECT_LT(high_water_mark, 4 + kRepeats);
+}
+
+TEST(CalculatorGraphTest, ThrottledNodeIsReleasedWhenGraphIsIdle) {
+  // The join needs the bound of "second", which only moves once "split"
+  // closes, so the full "first" queue can only drain if "split" runs on.
+  num_sink_calls = 0;
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(ParseConfig(R"pb(
+    input_stream: "in"
+    max_queue_size: 2
+    node {
+      name: "split"
+      calculator: "FirstOutputCalculator"
+      input_stream: "in"
+      output_stream: "first"
+      output_stream: "second"
+    }
+    node {
+      name: "join"
+      calculator: "CountingSinkCalculator"
+      input_stream: "first"
+      input_stream: "second"
+    }
+  )pb")));
+  MP_ASSERT_OK(graph.StartRun());
+  for (int i = 0; i < 10; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "in", MakePacket<int>(i).At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  EXPECT_EQ(num_sink_calls, 10);
+}
+
+// Acquires a buffer of the graph's pool per packet.
+class BufferCalculator : public CalculatorBase {
+ public:
+  absl::Status Process(CalculatorContext* cc) override {
+    BufferPool::Buffer buffer = cc->GetBufferPool().Acquire(4096);
+    buffer.data()[0] = 0;
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(BufferCalculator);
+
+TEST(CalculatorGraphTest, ReportsBufferPoolCounters) {
+  // The application's pool, shared by two graphs run one after the other.
+  std::shared_ptr<BufferPool> pool = BufferPool::Create();
+  for (int run = 1; run <= 2; ++run) {
+    CalculatorGraph graph;
+    MP_ASSERT_OK(graph.SetServiceObject(kBufferPoolService, pool));
+    MP_ASSERT_OK(graph.Initialize(ParseConfig(R"pb(
+      input_stream: "in"
+      node { calculator: "BufferCalculator" input_stream: "in" }
+    )pb")));
+    MP_ASSERT_OK(graph.StartRun());
+    for (int i = 0; i < 10; ++i) {
+      MP_ASSERT_OK(graph.AddPacketToInputStream(
+          "in", MakePacket<int>(i).At(Timestamp(i))));
+    }
+    MP_ASSERT_OK(graph.CloseAllInputStreams());
+    MP_ASSERT_OK(graph.WaitUntilDone());
+
+    CounterSet* counters = graph.GetCounterFactory()->GetCounterSet();
+    ASSERT_NE(counters->Get("BufferPool/hits"), nullptr);
+    EXPECT_EQ(counters->Get("BufferPool/misses")->Get(), 1);
+    EXPECT_EQ(counters->Get("BufferPool/hits")->Get(), 10 * run - 1);
+    EXPECT_EQ(counters->Get("BufferPool/bytes_held")->Get(), 4096);
+    EXPECT_EQ(counters->GetCountersValues().at("BufferPool/hits"),
+              10 * run - 1);
+  }
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,455 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/calculator_node.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+
+namespace mediapipe {
+
+    absl::Status CalculatorNode::Initialize(
+        int id, const CalculatorGraphConfig::Node& config, int max_queue_size,
+        internal::Scheduler* scheduler, CounterFactory* counter_factory,
+        Arena* arena, const GraphServiceManager* service_manager,
+        GraphProfiler* profiler) {
+      id_ = id;
+      state_ = arena->Create<CalculatorState>(
+          arena,
+          config.name().empty() ? absl::StrCat(config.calculator(), "_", id)
+                                : config.name(),
+          &config, counter_factory, service_manager);
+      absl::string_view node_name = state_->NodeName();
+      max_in_flight_ = std::max(1, config.max_in_flight());
+      max_batch_size_ = std::max(1, config.max_batch_size());
+      max_batch_wait_ = absl::Microseconds(config.max_batch_wait_us());
+      deadline_ = absl::Microseconds(config.deadline_us());
+      deadline_dropped_ = state_->GetCounter("deadline_dropped_timestamps");
+      scheduler_ = scheduler;
+      profiler_ = profiler;
+      profiler_->AddNode(id, node_name);
+
+      auto calculator =
+          CalculatorBaseRegistry::CreateByNameInNamespace("", config.calculator());
+      if (!calculator.ok()) {
+        return absl::NotFoundError(absl::StrCat(
+            "Unable to find Calculator \"", config.calculator(), "\" for node \"",
+            node_name, "\"."));
+      }
+      calculator_ = std::move(calculator).value();
+      if (max_batch_size_ > 1 && !calculator_->SupportsBatches()) {
+        return absl::InvalidArgumentError(absl::StrCat(
+            "Node \"", node_name, "\" sets max_batch_size, but Calculator \"",
+            config.calculator(), "\" does not support batches."));
+      }
+
+      auto input_tag_map = tool::TagMap::Create(
+          {config.input_stream().begin(), config.input_stream().end()});
+      if (!input_tag_map.ok()) return input_tag_map.status();
+      input_tag_map_ = std::move(input_tag_map).value();
+      auto output_tag_map = tool::TagMap::Create(
+          {config.output_stream().begin(), config.output_stream().end()});
+      if (!output_tag_map.ok()) return output_tag_map.status();
+      output_tag_map_ = std::move(output_tag_map).value();
+
+      for (const std::string& name : input_tag_map_->Names()) {
+        std::string prefix =
+            absl::StrCat("InputStream/", node_name, "/", name, "/");
+        inputs_.push_back(std::make_unique<InputStreamManager>(
+            name,
+            [this, id = static_cast<int>(inputs_.size())] { InputChanged(id); },
+            counter_factory->GetCounter(absl::StrCat(prefix, "dropped_packets")),
+            counter_factory->GetCounter(
+                absl::StrCat(prefix, "queue_high_water_mark"))));
+        inputs_.back()->SetMaxQueueSize(max_queue_size,
+                                        InputStreamInfo::BLOCK_UPSTREAM);
+      }
+      back_edges_.assign(inputs_.size(), false);
+      for (const InputStreamInfo& info : config.input_stream_info()) {
+        std::string tag;
+        int index;
+        absl::Status status = tool::ParseTagIndex(info.tag_index(), &tag, &index);
+        if (!status.ok()) return status;
+        int input_id = input_tag_map_->GetId(tag, index);
+        if (input_id < 0) {
+          return absl::InvalidArgumentError(absl::StrCat(
+              "input_stream_info \"", info.tag_index(), "\" of node \"",
+              node_name, "\" does not match any input stream."));
+        }
+        if (info.back_edge()) {
+          // A back edge that blocked its producer could stall the loop.
+          back_edges_[input_id] = true;
+          has_back_edges_ = true;
+          inputs_[input_id]->SetMaxQueueSize(-1, info.queue_full_policy());
+          continue;
+        }
+        inputs_[input_id]->SetMaxQueueSize(
+            info.max_queue_size() != 0 ? info.max_queue_size() : max_queue_size,
+            info.queue_full_policy());
+      }
+
+      std::string handler_name =
+          config.input_stream_handler().input_stream_handler();
+      if (handler_name.empty()) handler_name = "DefaultInputStreamHandler";
+      auto handler =
+          InputStreamHandlerRegistry::CreateByNameInNamespace("", handler_name);
+      if (!handler.ok()) {
+        return absl::NotFoundError(absl::StrCat(
+            "Unable to find input stream handler \"", handler_name,
+            "\" for node \"", node_name, "\"."));
+      }
+      std::vector<InputStreamManager*> inputs;
+      for (const auto& input : inputs_) inputs.push_back(input.get());
+      {
+        absl::MutexLock lock(&mu_);
+        input_stream_handler_ = std::move(handler).value();
+        input_stream_handler_->Initialize(std::move(inputs));
+      }
+
+      outputs_.assign(output_tag_map_->NumEntries(), nullptr);
+      offsets_.assign(output_tag_map_->NumEntries(), std::nullopt);
+      return absl::OkStatus();
+    }
+
+    std::unique_ptr<CalculatorContext> CalculatorNode::NewContext(
+        Timestamp input_timestamp) {
+      auto cc = std::unique_ptr<CalculatorContext>(
+          new CalculatorContext(state_, input_tag_map_, output_tag_map_));
+      cc->AddInputSet(input_timestamp);
+      for (int id = 0; id < cc->outputs_.NumEntries(); ++id) {
+        cc->outputs_.Get(id).name_ = &output_tag_map_->Names()[id];
+      }
+      return cc;
+    }
+
+    absl::Status CalculatorNode::OpenNode() {
+      std::unique_ptr<CalculatorContext> cc = NewContext(Timestamp::Unstarted());
+      {
+        absl::MutexLock lock(&mu_);
+        cc->scratch_ = AcquireScratch();
+      }
+      int64_t start = profiler_->StartEvent(TraceEvent::kOpen);
+      absl::Status status = calculator_->Open(cc.get());
+      profiler_->EndEvent(id_, TraceEvent::kOpen, cc->InputTimestamp(), start);
+      state_->ResetScratch(cc->scratch_.get());
+      if (!status.ok()) return Annotate(status, "Open");
+      for (int id = 0; id < cc->outputs_.NumEntries(); ++id) {
+        offsets_[id] = cc->outputs_.Get(id).offset_;
+        has_offsets_ = has_offsets_ || offsets_[id].has_value();
+      }
+      status = PropagateOutputs(cc.get());
+      if (!status.ok()) return Annotate(status, "Open");
+      {
+        absl::MutexLock lock(&mu_);
+        free_scratch_.push_back(std::move(cc->scratch_));
+        opened_ = true;
+      }
+      CheckIfReady();
+      return absl::OkStatus();
+    }
+
+    void CalculatorNode::CheckIfReady() {
+      Timestamp settled;
+      {
+        absl::MutexLock lock(&mu_);
+        settled = ScheduleReadyInvocations();
+      }
+      if (settled != Timestamp::Unset()) PropagateOffsetBounds(settled);
+    }
+
+    void CalculatorNode::InputChanged(int id) {
+      Timestamp settled;
+      {
+        absl::MutexLock lock(&mu_);
+        inputs_[id]->DropOldestPackets();
+        input_stream_handler_->InputChanged(id);
+        settled = ScheduleReadyInvocations();
+      }
+      if (settled != Timestamp::Unset()) PropagateOffsetBounds(settled);
+    }
+
+    void CalculatorNode::DetachBackEdgesIfDone() {
+      for (int id = 0; id < static_cast<int>(inputs_.size()); ++id) {
+        if (back_edges_[id]) continue;
+        bool has_packet;
+        if (inputs_[id]->NextTimestamp(&has_packet) != Timestamp::Done()) {
+          return;
+        }
+      }
+      for (int id = 0; id < static_cast<int>(inputs_.size()); ++id) {
+        if (!back_edges_[id]) continue;
+        inputs_[id]->Detach();
+        input_stream_handler_->InputChanged(id);
+      }
+      back_edges_detached_ = true;
+    }
+
+    Timestamp CalculatorNode::ScheduleReadyInvocations() {
+      if (!opened_ || closing_) return Timestamp::Unset();
+      if (has_back_edges_ && !back_edges_detached_) DetachBackEdgesIfDone();
+      while (num_in_flight_ < max_in_flight_ && !scheduler_->HasError()) {
+        if (num_full_outputs_.load(std::memory_order_acquire) > 0 &&
+            !unthrottled_.load(std::memory_order_acquire)) {
+          // OutputQueueFull() checks again once the queues drain.
+          return Timestamp::Unset();
+        }
+        Timestamp next;
+        InputStreamHandler::NodeReadiness readiness =
+            input_stream_handler_->GetNodeReadiness(&next);
+        if (readiness == InputStreamHandler::NodeReadiness::kReadyForProcess) {
+          if (batch_ == nullptr) {
+            batch_ = NewContext(next);
+            batch_deadline_ = absl::Now() + max_batch_wait_;
+            input_stream_handler_->FillInputSet(next, &batch_->Inputs());
+          } else {
+            input_stream_handler_->FillInputSet(next, batch_->AddInputSet(next));
+          }
+          if (batch_->BatchSize() < max_batch_size_) continue;
+        } else if (batch_ != nullptr &&
+                   readiness == InputStreamHandler::NodeReadiness::kNotReady &&
+                   absl::Now() < batch_deadline_) {
+          // Wait for the batch to fill up, at most until the deadline.
+          if (batch_timer_ < 0) {
+            batch_timer_ = scheduler_->ScheduleAfter(
+                batch_deadline_ - absl::Now(), [this] { CheckIfReady(); },
+                priority_, executor_);
+          }
+          return Timestamp::Unset();
+        }
+        if (batch_ != nullptr) {
+          ScheduleProcess(std::move(batch_));
+          if (batch_timer_ >= 0) {
+            // Lets the run become idle without waiting for the deadline.
+            scheduler_->CancelDelayed(batch_timer_);
+            batch_timer_ = -1;
+          }
+          continue;
+        }
+
+        switch (readiness) {
+          case InputStreamHandler::NodeReadiness::kReadyForClose:
+            if (num_in_flight_ == 0) {
+              closing_ = true;
+              scheduler_->Schedule([this] { RunClose(); }, priority_,
+                                   executor_);
+            }
+            return Timestamp::Unset();
+          case InputStreamHandler::NodeReadiness::kNotReady:
+            // Every timestamp below next is processed and published.
+            return num_in_flight_ == 0 && has_offsets_ ? next
+                                                        : Timestamp::Unset();
+          case InputStreamHandler::NodeReadiness::kReadyForProcess:
+            break;  // Handled above.
+        }
+      }
+      return Timestamp::Unset();
+    }
+
+    void CalculatorNode::ScheduleProcess(std::unique_ptr<CalculatorContext> cc) {
+      cc->scratch_ = AcquireScratch();
+      int64_t invocation = next_invocation_++;
+      ++num_in_flight_;
+      // std::function must be copyable; RunProcess takes ownership back.
+      CalculatorContext* raw_cc = cc.release();
+      scheduler_->Schedule(
+          [this, raw_cc, invocation] {
+            RunProcess(std::unique_ptr<CalculatorContext>(raw_cc), invocation);
+          },
+          priority_, executor_);
+    }
+
+    void CalculatorNode::RunProcess(std::unique_ptr<CalculatorContext> cc,
+                                    int64_t invocation) {
+      if (!scheduler_->HasError() && PrepareInputs(cc.get())) {
+        int64_t start = profiler_->StartEvent(TraceEvent::kProcess);
+        absl::Status status = calculator_->Process(cc.get());
+        profiler_->EndEvent(id_, TraceEvent::kProcess, cc->InputTimestamp(),
+                            start);
+        if (!status.ok()) scheduler_->RecordError(Annotate(status, "Process"));
+      }
+      state_->ResetScratch(cc->scratch_.get());
+      {
+        absl::MutexLock lock(&mu_);
+        free_scratch_.push_back(std::move(cc->scratch_));
+        finished_.emplace(invocation, std::move(cc));
+      }
+      PublishFinished();
+      CheckIfReady();
+    }
+
+    bool CalculatorNode::PrepareInputs(CalculatorContext* cc) {
+      if (!tracks_ingestion_time_) return true;
+      const bool has_deadline = deadline_ > absl::ZeroDuration();
+      const absl::Time now = has_deadline ? absl::Now() : absl::InfinitePast();
+      absl::Time earliest = absl::InfiniteFuture();
+      int kept = 0;
+      for (int i = 0; i < cc->BatchSize(); ++i) {
+        absl::Time item_earliest = absl::InfiniteFuture();
+        for (const InputStreamShard& input : cc->Inputs(i)) {
+          absl::Time ingestion_time = input.Value().IngestionTime();
+          if (ingestion_time == absl::InfinitePast()) continue;
+          item_earliest = std::min(item_earliest, ingestion_time);
+        }
+        if (has_deadline && item_earliest != absl::InfiniteFuture() &&
+            now - item_earliest > deadline_) {
+          deadline_dropped_->Increment();
+          continue;
+        }
+        earliest = std::min(earliest, item_earliest);
+        if (kept != i) {
+          cc->inputs_[kept] = std::move(cc->inputs_[i]);
+          cc->input_timestamps_[kept] = cc->input_timestamps_[i];
+        }
+        ++kept;
+      }
+      if (earliest != absl::InfiniteFuture()) cc->ingestion_time_ = earliest;
+      if (kept == 0) {
+        // Keeps the timestamps, from which outputs with an offset take their
+        // bounds, as if Process() had output nothing.
+        cc->inputs_.clear();
+        return false;
+      }
+      // Outputs with an offset follow the last item kept; a later
+      // CheckIfReady() raises them further.
+      cc->inputs_.erase(cc->inputs_.begin() + kept, cc->inputs_.end());
+      cc->input_timestamps_.erase(cc->input_timestamps_.begin() + kept,
+                                  cc->input_timestamps_.end());
+      return true;
+    }
+
+    void CalculatorNode::PublishFinished() {
+      absl::MutexLock publish_lock(&publish_mu_);
+      while (true) {
+        std::unique_ptr<CalculatorContext> cc;
+        {
+          absl::MutexLock lock(&mu_);
+          if (finished_.empty() || finished_.begin()->first != next_to_publish_) {
+            return;
+          }
+          cc = std::move(finished_.begin()->second);
+          finished_.erase(finished_.begin());
+          ++next_to_publish_;
+        }
+        if (!scheduler_->HasError()) {
+          absl::Status status = PropagateOutputs(cc.get());
+          if (!status.ok()) scheduler_->RecordError(Annotate(status, "Process"));
+        }
+        absl::MutexLock lock(&mu_);
+        --num_in_flight_;
+      }
+    }
+
+    void CalculatorNode::RunClose() {
+      // Keeps the output streams single-producer; see publish_mu_.
+      absl::MutexLock publish_lock(&publish_mu_);
+      std::unique_ptr<CalculatorContext> cc = NewContext(Timestamp::Done());
+      {
+        absl::MutexLock lock(&mu_);
+        cc->scratch_ = AcquireScratch();
+      }
+      int64_t start = profiler_->StartEvent(TraceEvent::kClose);
+      absl::Status status = calculator_->Close(cc.get());
+      profiler_->EndEvent(id_, TraceEvent::kClose, cc->InputTimestamp(), start);
+      state_->ResetScratch(cc->scratch_.get());
+      if (!status.ok()) {
+        scheduler_->RecordError(Annotate(status, "Close"));
+      } else if (!scheduler_->HasError()) {
+        status = PropagateOutputs(cc.get());
+        if (!status.ok()) scheduler_->RecordError(Annotate(status, "Close"));
+      }
+      for (OutputStreamManager* output : outputs_) output->Close();
+      scheduler_->NodeClosed();
+    }
+
+    void CalculatorNode::OutputQueueFull(bool full) {
+      if (full) {
+        num_full_outputs_.fetch_add(1, std::memory_order_acq_rel);
+        return;
+      }
+      if (num_full_outputs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        unthrottled_.store(false, std::memory_order_release);
+        // The caller may hold locks of the downstream node.
+        scheduler_->Schedule([this] { CheckIfReady(); }, priority_, executor_);
+      }
+    }
+
+    void CalculatorNode::Unthrottle() {
+      if (num_full_outputs_.load(std::memory_order_acquire) == 0 ||
+          unthrottled_.exchange(true, std::memory_order_acq_rel)) {
+        return;
+      }
+      scheduler_->Schedule([this] { CheckIfReady(); }, priority_, executor_);
+    }
+
+    void CalculatorNode::CloseAfterError() {
+      {
+        absl::MutexLock lock(&mu_);
+        if (!opened_ || closing_) return;
+        closing_ = true;
+      }
+      RunClose();
+    }
+
+    std::unique_ptr<Arena> CalculatorNode::AcquireScratch() {
+      if (free_scratch_.empty()) return std::make_unique<Arena>();
+      std::unique_ptr<Arena> scratch = std::move(free_scratch_.back());
+      free_scratch_.pop_back();
+      return scratch;
+    }
+
+    absl::Status CalculatorNode::PropagateOutputs(CalculatorContext* cc) {
+      for (int id = 0; id < cc->outputs_.NumEntries(); ++id) {
+        OutputStreamShard& shard = cc->outputs_.Get(id);
+        if (cc->ingestion_time_ != absl::InfinitePast()) {
+          for (Packet& packet : shard.packets_) {
+            if (packet.IngestionTime() == absl::InfinitePast()) {
+              packet = std::move(packet).WithIngestionTime(cc->ingestion_time_);
+            }
+          }
+        }
+        absl::Status status =
+            outputs_[id]->PropagatePackets(std::move(shard.packets_));
+        if (!status.ok()) return status;
+        Timestamp bound = shard.next_timestamp_bound_;
+        Timestamp input_timestamp = cc->input_timestamps_.back();
+        if (offsets_[id].has_value() && input_timestamp.IsAllowedInStream()) {
+          bound = std::max(
+              bound, (input_timestamp + *offsets_[id]).NextAllowedInStream());
+        }
+        outputs_[id]->SetNextTimestampBound(bound);
+      }
+      return absl::OkStatus();
+    }
+
+    void CalculatorNode::PropagateOffsetBounds(Timestamp input_bound) {
+      absl::MutexLock publish_lock(&publish_mu_);
+      if (scheduler_->HasError()) return;
+      for (int id = 0; id < static_cast<int>(outputs_.size()); ++id) {
+        if (offsets_[id].has_value()) {
+          outputs_[id]->SetNextTimestampBound(input_bound + *offsets_[id]);
+        }
+      }
+    }
+
+    absl::Status CalculatorNode::Annotate(const absl::Status& status,
+                                          absl::string_view method) const {
+      return absl::Status(
+          status.code(), absl::StrCat("Calculator::", method, "() for node \"",
+                                      state_->NodeName(), "\" failed: ",
+                                      status.message()));
+    }
+
+}  // namespace mediapipe
@@ -0,0 +1,224 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CUSTOM_MEDIAPIPE_CALCULATOR_NODE_H
+#define CUSTOM_MEDIAPIPE_CALCULATOR_NODE_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_base.h"
+#include "mediapipe/framework/calculator_context.h"
+#include "mediapipe/framework/calculator_state.h"
+#include "mediapipe/framework/counter_factory.h"
+#include "mediapipe/framework/deps/arena.h"
+#include "mediapipe/framework/graph_profiler.h"
+#include "mediapipe/framework/graph_service_manager.h"
+#include "mediapipe/framework/input_stream_handler.h"
+#include "mediapipe/framework/input_stream_manager.h"
+#include "mediapipe/framework/output_stream_manager.h"
+#include "mediapipe/framework/scheduler.h"
+#include "mediapipe/framework/tool/tag_map.h"
+
+namespace mediapipe {
+    // Runs one calculator of a graph: decides when the calculator can run,
+    // gathers its inputs, schedules its Process() calls and sends the outputs
+    // downstream.
+    //
+    // The node's InputStreamHandler decides when it is ready and which
+    // packets a Process() call gets. Outputs with an offset
+    // (OutputStreamShard::SetOffset) forward the node's input bounds
+    // downstream without a Process() call. Input timestamps past the node's
+    // deadline_us are dropped before Process() sees them.
+    // This class is thread safe.
+    class CalculatorNode {
+      public:
+        CalculatorNode() = default;
+        CalculatorNode(const CalculatorNode&) = delete;
+        CalculatorNode& operator=(const CalculatorNode&) = delete;
+
+        // Creates the calculator and the input streams. Input streams queue at
+        // most max_queue_size packets (-1: no limit) unless the node's
+        // input_stream_info says otherwise; their counters are created in
+        // counter_factory. The node's CalculatorState is created in arena and
+        // reads services from service_manager. The calculator's calls are
+        // timed by profiler, to which the node is added.
+        absl::Status Initialize(int id, const CalculatorGraphConfig::Node& config,
+                                int max_queue_size, internal::Scheduler* scheduler,
+                                CounterFactory* counter_factory, Arena* arena,
+                                const GraphServiceManager* service_manager,
+                                GraphProfiler* profiler);
+
+        int Id() const { return id_; }
+        absl::string_view DebugName() const { return state_->NodeName(); }
+
+        const std::shared_ptr<tool::TagMap>& InputTagMap() const {
+          return input_tag_map_;
+        }
+        const std::shared_ptr<tool::TagMap>& OutputTagMap() const {
+          return output_tag_map_;
+        }
+        InputStreamManager* InputStream(int id) { return inputs_[id].get(); }
+        // Whether the input stream is a back edge; see
+        // InputStreamInfo.back_edge.
+        bool IsBackEdge(int id) const { return back_edges_[id]; }
+        // Must be set for every output id before OpenNode().
+        void SetOutputStream(int id, OutputStreamManager* output) {
+          outputs_[id] = output;
+        }
+
+        // Nodes with a higher priority are run first when several are ready.
+        void SetPriority(int priority) { priority_ = priority; }
+        // The scheduler's executor the node runs on; see Node.executor.
+        void SetExecutor(int executor) { executor_ = executor; }
+        // Whether the graph stamps its input packets with their ingestion
+        // time, which the node then passes on to its outputs. Must be set
+        // before OpenNode().
+        void SetTracksIngestionTime(bool tracks) {
+          tracks_ingestion_time_ = tracks;
+        }
+
+        // Calls Open() on the calling thread and starts scheduling the node.
+        absl::Status OpenNode() ABSL_LOCKS_EXCLUDED(mu_);
+
+        // Schedules Process() calls for as many ready timestamps as allowed in
+        // flight, batching up to max_batch_size of them per call, or Close()
+        // once all inputs are done. A partial batch waits for more timestamps
+        // until max_batch_wait_us after its first one became ready.
+        void CheckIfReady() ABSL_LOCKS_EXCLUDED(mu_);
+        // Same, after the input stream with the given id changed.
+        void InputChanged(int id) ABSL_LOCKS_EXCLUDED(mu_);
+
+        // Any thread, without locks held. Reports that a BLOCK_UPSTREAM input
+        // stream fed by one of the node's outputs became full (or no longer
+        // is). While any is full the node is throttled: no new calls are
+        // scheduled, though those already running still add their packets.
+        void OutputQueueFull(bool full);
+        // Called when the run is idle: a throttled node then stays throttled
+        // for good, e.g. when the full queue's node waits on another input
+        // that only this node can unblock. Lifts the throttle until the full
+        // queues drain.
+        void Unthrottle();
+
+        // After an error stopped the run: closes the calculator if it was
+        // opened and has not been closed yet. Outputs are discarded.
+        void CloseAfterError() ABSL_LOCKS_EXCLUDED(mu_);
+
+      private:
+        std::unique_ptr<CalculatorContext> NewContext(Timestamp input_timestamp);
+
+        // Does the work of CheckIfReady(). Returns the bound to pass to
+        // PropagateOffsetBounds(), or Timestamp::Unset().
+        Timestamp ScheduleReadyInvocations() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+        void ScheduleProcess(std::unique_ptr<CalculatorContext> cc)
+            ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+        // Returns a free scratch arena, or a new one.
+        std::unique_ptr<Arena> AcquireScratch()
+            ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+        // Once every input but the back edges is done, detaches the back
+        // edges so that the node can close.
+        void DetachBackEdgesIfDone() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+        // Sets cc's ingestion time and removes the batch items past the
+        // deadline. Returns false if none is left.
+        bool PrepareInputs(CalculatorContext* cc);
+
+        void RunProcess(std::unique_ptr<CalculatorContext> cc, int64_t invocation)
+            ABSL_LOCKS_EXCLUDED(mu_);
+        // Publishes finished invocations in invocation order.
+        void PublishFinished() ABSL_LOCKS_EXCLUDED(publish_mu_, mu_);
+        void RunClose() ABSL_LOCKS_EXCLUDED(publish_mu_, mu_);
+
+        // Moves the output packets out of cc.
+        absl::Status PropagateOutputs(CalculatorContext* cc);
+        // Raises the bounds of outputs with an offset to input_bound plus the
+        // offset, once every timestamp below input_bound is published.
+        void PropagateOffsetBounds(Timestamp input_bound)
+            ABSL_LOCKS_EXCLUDED(publish_mu_);
+        absl::Status Annotate(const absl::Status& status,
+                              absl::string_view method) const;
+
+        int id_ = -1;
+        // Owned by the graph's arena.
+        CalculatorState* state_ = nullptr;
+        int max_in_flight_ = 1;
+        int max_batch_size_ = 1;
+        absl::Duration max_batch_wait_;
+        int priority_ = 0;
+        int executor_ = 0;
+        bool tracks_ingestion_time_ = false;
+        // Zero for no deadline.
+        absl::Duration deadline_;
+        Counter* deadline_dropped_ = nullptr;
+        internal::Scheduler* scheduler_ = nullptr;
+        GraphProfiler* profiler_ = nullptr;
+        std::unique_ptr<CalculatorBase> calculator_;
+
+        std::shared_ptr<tool::TagMap> input_tag_map_;
+        std::shared_ptr<tool::TagMap> output_tag_map_;
+        std::vector<std::unique_ptr<InputStreamManager>> inputs_;
+        std::vector<bool> back_edges_;
+        bool has_back_edges_ = false;
+        // Owned by the graph.
+        std::vector<OutputStreamManager*> outputs_;
+        // Offsets of the outputs, as set in Open().
+        std::vector<std::optional<TimestampDiff>> offsets_;
+        bool has_offsets_ = false;
+
+        // Full BLOCK_UPSTREAM input streams fed by the node's outputs.
+        std::atomic<int> num_full_outputs_{0};
+        // Set by Unthrottle(), cleared once no output is full.
+        std::atomic<bool> unthrottled_{false};
+
+        absl::Mutex mu_;
+        std::unique_ptr<InputStreamHandler> input_stream_handler_
+            ABSL_GUARDED_BY(mu_);
+        bool opened_ ABSL_GUARDED_BY(mu_) = false;
+        bool back_edges_detached_ ABSL_GUARDED_BY(mu_) = false;
+        // Set once Close() has been scheduled or run.
+        bool closing_ ABSL_GUARDED_BY(mu_) = false;
+        // Invocations scheduled and not yet published.
+        int num_in_flight_ ABSL_GUARDED_BY(mu_) = 0;
+        // The batch being filled, if it waits for more timestamps.
+        std::unique_ptr<CalculatorContext> batch_ ABSL_GUARDED_BY(mu_);
+        absl::Time batch_deadline_ ABSL_GUARDED_BY(mu_);
+        // The scheduler's id of the task that flushes batch_ at its deadline,
+        // or -1.
+        int64_t batch_timer_ ABSL_GUARDED_BY(mu_) = -1;
+        int64_t next_invocation_ ABSL_GUARDED_BY(mu_) = 0;
+        int64_t next_to_publish_ ABSL_GUARDED_BY(mu_) = 0;
+        std::map<int64_t, std::unique_ptr<CalculatorContext>> finished_
+            ABSL_GUARDED_BY(mu_);
+        // Scratch arenas of calls that have returned, at most one per call
+        // that can be in flight at once.
+        std::vector<std::unique_ptr<Arena>> free_scratch_ ABSL_GUARDED_BY(mu_);
+
+        // Held while sending outputs downstream, so that output streams only
+        // ever have one producer at a time. Acquired before mu_.
+        absl::Mutex publish_mu_ ABSL_ACQUIRED_BEFORE(mu_);
+    };
+}  // namespace mediapipe
+
+#endif  // CUSTOM_MEDIAPIPE_CALCULATOR_NODE_H
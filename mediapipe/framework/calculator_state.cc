@@ -1,3 +1,50 @@
+// Copyright 2019 The MediaPipe Authors.
 //
-// Created by MSD on 27/07/2024.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
 //
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/calculator_state.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace mediapipe {
+
+    CalculatorState::CalculatorState(Arena* arena, absl::string_view node_name,
+                                     const CalculatorGraphConfig::Node* config,
+                                     CounterFactory* counter_factory,
+                                     const GraphServiceManager* service_manager)
+        : node_name_(arena->CopyString(node_name)),
+          calculator_type_(arena->CopyString(config->calculator())),
+          config_(config),
+          counter_factory_(counter_factory),
+          service_manager_(service_manager),
+          scratch_allocations_(GetCounter("scratch_allocations")),
+          scratch_heap_allocations_(GetCounter("scratch_heap_allocations")) {}
+
+    Counter* CalculatorState::GetCounter(absl::string_view name) {
+      return counter_factory_->GetCounter(
+          absl::StrCat("Node/", node_name_, "/", name));
+    }
+
+    void CalculatorState::ResetScratch(Arena* scratch) {
+      if (scratch->NumAllocations() > 0) {
+        scratch_allocations_->IncrementBy(
+            static_cast<int>(scratch->NumAllocations()));
+      }
+      if (scratch->NumHeapAllocations() > 0) {
+        scratch_heap_allocations_->IncrementBy(
+            static_cast<int>(scratch->NumHeapAllocations()));
+      }
+      scratch->Reset();
+    }
+
+}  // namespace mediapipe
@@ -1,31 +1,92 @@
+// Copyright 2019 The MediaPipe Authors.
 //
-// Created by MSD on 27/07/2024.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
 //
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
 
 #ifndef CUSTOM_MEDIAPIPE_CALCULATOR_STATE_H
 #define CUSTOM_MEDIAPIPE_CALCULATOR_STATE_H
 
-#include <map>
-#include <memory>
-#include <string>
-
-// TODO: Move protos in another CL after the C++ code migration.
-#include "absl/base/macros.h"
-#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "google/protobuf/any.pb.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/counter.h"
 #include "mediapipe/framework/counter_factory.h"
+#include "mediapipe/framework/deps/arena.h"
 #include "mediapipe/framework/graph_service.h"
 #include "mediapipe/framework/graph_service_manager.h"
-#include "mediapipe/framework/packet.h"
-#include "mediapipe/framework/packet_set.h"
-#include "mediapipe/framework/port.h"
-#include "mediapipe/framework/port/any_proto.h"
-#include "mediapipe/framework/resources.h"
-#include "mediapipe/framework/tool/options_map.h"
 
 namespace mediapipe {
- class ProfilingContext;
-}
+    // The state of a node that is shared by all calls of its calculator: the
+    // node's name, its calculator type, its options, its counters and the
+    // graph's services. The graph creates
+    // the states of all its nodes in one arena, so they sit next to each
+    // other rather than scattered over the heap.
+    //
+    // Every node counts the use of its scratch arenas
+    // (CalculatorContext::Scratch()) in
+    //   Node/<node>/scratch_allocations       Arena::Allocate() calls
+    //   Node/<node>/scratch_heap_allocations  blocks taken from the heap
+    // A node whose second counter stops growing runs without malloc.
+    // This class is thread safe.
+    class CalculatorState {
+      public:
+        // Copies the strings into arena, which must outlive the state, as
+        // must config, counter_factory and service_manager.
+        CalculatorState(Arena* arena, absl::string_view node_name,
+                        const CalculatorGraphConfig::Node* config,
+                        CounterFactory* counter_factory,
+                        const GraphServiceManager* service_manager);
+        CalculatorState(const CalculatorState&) = delete;
+        CalculatorState& operator=(const CalculatorState&) = delete;
+
+        absl::string_view NodeName() const { return node_name_; }
+        absl::string_view CalculatorType() const { return calculator_type_; }
+
+        // Returns the first of the node's node_options that is a T, or a
+        // default T if there is none. Unpacks it on every call.
+        template <typename T>
+        T Options() const {
+          T options;
+          for (const google::protobuf::Any& any : config_->node_options()) {
+            if (any.Is<T>()) {
+              any.UnpackTo(&options);
+              break;
+            }
+          }
+          return options;
+        }
+
+        // Returns the counter Node/<node>/<name>, creating it on first use.
+        // Looks the name up every time; keep the pointer.
+        Counter* GetCounter(absl::string_view name);
+
+        template <typename T>
+        T* GetServiceObject(const GraphService<T>& service) const {
+          return service_manager_->GetServiceObject(service);
+        }
+
+        // Adds the allocations made in scratch since its last Reset() to the
+        // scratch counters, then resets it.
+        void ResetScratch(Arena* scratch);
+
+      private:
+        const absl::string_view node_name_;
+        const absl::string_view calculator_type_;
+        const CalculatorGraphConfig::Node* const config_;
+        CounterFactory* const counter_factory_;
+        const GraphServiceManager* const service_manager_;
+        Counter* const scratch_allocations_;
+        Counter* const scratch_heap_allocations_;
+    };
+}  // namespace mediapipe
 
-#endif //CUSTOM_MEDIAPIPE_CALCULATOR_STATE_H
+#endif  // CUSTOM_MEDIAPIPE_CALCULATOR_STATE_H
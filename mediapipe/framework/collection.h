@@ -0,0 +1,91 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CUSTOM_MEDIAPIPE_COLLECTION_H
+#define CUSTOM_MEDIAPIPE_COLLECTION_H
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/log/absl_check.h"
+#include "absl/strings/string_view.h"
+#include "mediapipe/framework/tool/tag_map.h"
+
+namespace mediapipe {
+    namespace internal {
+        // One T per entry of a TagMap, addressable by tag and index or by id.
+        // Entries are stored contiguously in id order.
+        template <typename T>
+        class Collection {
+          public:
+            using iterator = typename std::vector<T>::iterator;
+            using const_iterator = typename std::vector<T>::const_iterator;
+
+            explicit Collection(std::shared_ptr<tool::TagMap> tag_map)
+                : tag_map_(std::move(tag_map)), data_(tag_map_->NumEntries()) {}
+
+            // The entry with the given tag and index, which must exist.
+            T& Get(absl::string_view tag, int index) {
+              return data_[CheckedId(tag, index)];
+            }
+            const T& Get(absl::string_view tag, int index) const {
+              return data_[CheckedId(tag, index)];
+            }
+            // Same as Get(tag, 0).
+            T& Tag(absl::string_view tag) { return Get(tag, 0); }
+            const T& Tag(absl::string_view tag) const { return Get(tag, 0); }
+            // Same as Get("", index).
+            T& Index(int index) { return Get("", index); }
+            const T& Index(int index) const { return Get("", index); }
+
+            T& Get(int id) { return data_[id]; }
+            const T& Get(int id) const { return data_[id]; }
+
+            bool HasTag(absl::string_view tag) const {
+              return tag_map_->HasTag(tag);
+            }
+            // Returns -1 if there is no such entry.
+            int GetId(absl::string_view tag, int index) const {
+              return tag_map_->GetId(tag, index);
+            }
+            int NumEntries() const { return static_cast<int>(data_.size()); }
+            int NumEntries(absl::string_view tag) const {
+              return tag_map_->NumEntries(tag);
+            }
+
+            const std::shared_ptr<tool::TagMap>& TagMap() const {
+              return tag_map_;
+            }
+
+            iterator begin() { return data_.begin(); }
+            iterator end() { return data_.end(); }
+            const_iterator begin() const { return data_.begin(); }
+            const_iterator end() const { return data_.end(); }
+
+          private:
+            int CheckedId(absl::string_view tag, int index) const {
+              int id = tag_map_->GetId(tag, index);
+              ABSL_CHECK_GE(id, 0) << "No entry with tag \"" << tag
+                                   << "\" and index " << index << ".";
+              return id;
+            }
+
+            std::shared_ptr<tool::TagMap> tag_map_;
+            std::vector<T> data_;
+        };
+    }  // namespace internal
+}  // namespace mediapipe
+
+#endif  // CUSTOM_MEDIAPIPE_COLLECTION_H
@@ -0,0 +1,253 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/counter_exporter.h"
+
+#include <cstdio>
+#include <fstream>
+#include <utility>
+
+#include "absl/log/absl_log.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "mediapipe/framework/counter_factory.h"
+
+namespace mediapipe {
+namespace {
+    // Maps a counter name onto the Prometheus metric name alphabet.
+    std::string PrometheusName(absl::string_view name) {
+      std::string result = absl::StrCat("mediapipe_", name);
+      for (char& c : result) {
+        const bool valid = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                           (c >= '0' && c <= '9') || c == '_' || c == ':';
+        if (!valid) c = '_';
+      }
+      return result;
+    }
+
+    // Escapes name for a HELP line.
+    std::string PrometheusHelp(absl::string_view name) {
+      std::string result;
+      for (char c : name) {
+        if (c == '\\') {
+          result += "\\\\";
+        } else if (c == '\n') {
+          result += "\\n";
+        } else {
+          result += c;
+        }
+      }
+      return result;
+    }
+
+    // Returns name as a quoted JSON string.
+    std::string JsonString(absl::string_view name) {
+      std::string result = "\"";
+      for (char c : name) {
+        switch (c) {
+          case '"':
+            result += "\\\"";
+            break;
+          case '\\':
+            result += "\\\\";
+            break;
+          case '\n':
+            result += "\\n";
+            break;
+          default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+              char escaped[8];
+              std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+              result += escaped;
+            } else {
+              result += c;
+            }
+        }
+      }
+      result += "\"";
+      return result;
+    }
+}  // namespace
+
+    const std::string& PrometheusTextFileSink::MetricName(
+        absl::flat_hash_map<std::string, std::string>& assigned,
+        const std::string& name, absl::string_view stem,
+        std::initializer_list<absl::string_view> suffixes) {
+      auto it = assigned.find(name);
+      if (it != assigned.end()) return it->second;
+      const std::string sanitized = PrometheusName(stem);
+      std::string metric_name = sanitized;
+      auto is_free = [this, &suffixes](const std::string& base) {
+        for (absl::string_view suffix : suffixes) {
+          if (series_names_.contains(absl::StrCat(base, suffix))) return false;
+        }
+        return true;
+      };
+      for (int n = 2; !is_free(metric_name); ++n) {
+        metric_name = absl::StrCat(sanitized, "_", n);
+      }
+      for (absl::string_view suffix : suffixes) {
+        series_names_.insert(absl::StrCat(metric_name, suffix));
+      }
+      return assigned.emplace(name, std::move(metric_name)).first->second;
+    }
+
+    absl::Status PrometheusTextFileSink::Write(const CounterSnapshot& snapshot) {
+      std::string text;
+      for (const auto& counter : snapshot.counters) {
+        absl::string_view stem = counter.first;
+        absl::ConsumeSuffix(&stem, "_total");
+        const std::string name = absl::StrCat(
+            MetricName(counter_names_, counter.first, stem, {"_total"}),
+            "_total");
+        absl::StrAppend(&text, "# HELP ", name, " ",
+                        PrometheusHelp(counter.first), "\n");
+        absl::StrAppend(&text, "# TYPE ", name, " counter\n", name, " ",
+                        counter.second.value, "\n");
+      }
+      for (const auto& histogram : snapshot.histograms) {
+        const std::string& name =
+            MetricName(histogram_names_, histogram.first, histogram.first,
+                       {"", "_sum", "_count"});
+        const HistogramSnapshot& values = histogram.second;
+        absl::StrAppend(&text, "# HELP ", name, " ",
+                        PrometheusHelp(histogram.first), "\n");
+        absl::StrAppend(&text, "# TYPE ", name, " summary\n");
+        absl::StrAppend(&text, name, "{quantile=\"0.5\"} ", values.P50(), "\n");
+        absl::StrAppend(&text, name, "{quantile=\"0.9\"} ", values.P90(), "\n");
+        absl::StrAppend(&text, name, "{quantile=\"0.99\"} ", values.P99(), "\n");
+        absl::StrAppend(&text, name, "{quantile=\"1\"} ", values.max(), "\n");
+        absl::StrAppend(&text, name, "_sum ", values.sum(), "\n");
+        absl::StrAppend(&text, name, "_count ", values.count(), "\n");
+      }
+
+      const std::string temp_path = absl::StrCat(path_, ".tmp");
+      {
+        std::ofstream file(temp_path, std::ios::trunc);
+        file << text;
+        if (!file.good()) {
+          return absl::UnavailableError(
+              absl::StrCat("Failed to write counters to ", temp_path));
+        }
+      }
+      if (std::rename(temp_path.c_str(), path_.c_str()) != 0) {
+        return absl::UnavailableError(
+            absl::StrCat("Failed to rename ", temp_path, " to ", path_));
+      }
+      return absl::OkStatus();
+    }
+
+    absl::Status JsonLinesFileSink::Write(const CounterSnapshot& snapshot) {
+      std::string line = absl::StrCat(
+          "{\"time_unix_ms\":", absl::ToUnixMillis(snapshot.time),
+          ",\"interval_ms\":", absl::ToInt64Milliseconds(snapshot.interval),
+          ",\"counters\":{");
+      const char* separator = "";
+      for (const auto& counter : snapshot.counters) {
+        absl::StrAppend(&line, separator, JsonString(counter.first),
+                        ":{\"value\":", counter.second.value,
+                        ",\"delta\":", counter.second.delta,
+                        ",\"rate\":", counter.second.rate_per_second, "}");
+        separator = ",";
+      }
+      absl::StrAppend(&line, "},\"histograms\":{");
+      separator = "";
+      for (const auto& histogram : snapshot.histograms) {
+        const HistogramSnapshot& values = histogram.second;
+        absl::StrAppend(&line, separator, JsonString(histogram.first),
+                        ":{\"count\":", values.count(), ",\"sum\":", values.sum(),
+                        ",\"min\":", values.min(), ",\"p50\":", values.P50(),
+                        ",\"p90\":", values.P90(), ",\"p99\":", values.P99(),
+                        ",\"max\":", values.max(), "}");
+        separator = ",";
+      }
+      absl::StrAppend(&line, "}}\n");
+
+      std::ofstream file(path_, std::ios::app);
+      file << line;
+      if (!file.good()) {
+        return absl::UnavailableError(
+            absl::StrCat("Failed to append counters to ", path_));
+      }
+      return absl::OkStatus();
+    }
+
+    CounterExporter::CounterExporter(const CounterSet* counter_set,
+                                     std::unique_ptr<CounterSink> sink)
+        : counter_set_(counter_set), sink_(std::move(sink)) {}
+
+    CounterExporter::~CounterExporter() { Stop(); }
+
+    void CounterExporter::Start(absl::Duration interval) {
+      absl::MutexLock lifecycle_lock(&lifecycle_mu_);
+      if (thread_.joinable() || interval <= absl::ZeroDuration()) return;
+      {
+        absl::MutexLock lock(&mu_);
+        stop_ = false;
+      }
+      thread_ = std::thread([this, interval] { Run(interval); });
+    }
+
+    void CounterExporter::Stop() {
+      absl::MutexLock lifecycle_lock(&lifecycle_mu_);
+      if (!thread_.joinable()) return;
+      {
+        absl::MutexLock lock(&mu_);
+        stop_ = true;
+      }
+      thread_.join();
+    }
+
+    void CounterExporter::Run(absl::Duration interval) {
+      absl::Time next = absl::Now() + interval;
+      while (true) {
+        {
+          absl::MutexLock lock(&mu_);
+          mu_.AwaitWithDeadline(absl::Condition(&stop_), next);
+          if (stop_) return;
+        }
+        absl::Status status = ExportNow();
+        ABSL_LOG_IF(WARNING, !status.ok()) << "Counter export failed: " << status;
+        // Keep a fixed cadence regardless of how long the export took.
+        next += interval;
+        const absl::Time now = absl::Now();
+        if (next < now) next = now + interval;
+      }
+    }
+
+    absl::Status CounterExporter::ExportNow() {
+      absl::MutexLock lock(&export_mu_);
+      CounterSnapshot snapshot;
+      snapshot.time = absl::Now();
+      if (previous_time_ != absl::InfinitePast()) {
+        snapshot.interval = snapshot.time - previous_time_;
+      }
+      const double seconds = absl::ToDoubleSeconds(snapshot.interval);
+      std::map<std::string, int64_t> values = counter_set_->GetCountersValues();
+      for (const auto& it : values) {
+        CounterSnapshot::CounterValue& counter = snapshot.counters[it.first];
+        counter.value = it.second;
+        auto previous = previous_values_.find(it.first);
+        counter.delta =
+            it.second - (previous != previous_values_.end() ? previous->second : 0);
+        if (seconds > 0) counter.rate_per_second = counter.delta / seconds;
+      }
+      snapshot.histograms = counter_set_->GetHistogramsValues();
+      previous_values_ = std::move(values);
+      previous_time_ = snapshot.time;
+      return sink_->Write(snapshot);
+    }
+
+}  // namespace mediapipe
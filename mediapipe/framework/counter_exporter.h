@@ -0,0 +1,161 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Periodic export of the counters and histograms of a CounterSet.
+//
+// Usage:
+//   counter_set->StartExporting(
+//       std::make_unique<PrometheusTextFileSink>("/var/metrics/graph.prom"),
+//       absl::Seconds(10));
+//
+// Snapshots are taken through the lock-free read paths of CounterSet, so
+// exporting never stalls threads that increment counters or record samples.
+
+#ifndef CUSTOM_MEDIAPIPE_COUNTER_EXPORTER_H
+#define CUSTOM_MEDIAPIPE_COUNTER_EXPORTER_H
+
+#include <cstdint>
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/histogram.h"
+
+namespace mediapipe {
+    class CounterSet;
+
+    // The values of all counters and histograms of a CounterSet at one point in
+    // time, with deltas and rates relative to the previous export.
+    struct CounterSnapshot {
+      struct CounterValue {
+        int64_t value = 0;
+        // Change since the previous snapshot; equals value for the first one.
+        int64_t delta = 0;
+        // delta divided by interval, in units per second. 0 for the first one.
+        double rate_per_second = 0.0;
+      };
+
+      absl::Time time;
+      // Time since the previous snapshot; zero for the first one.
+      absl::Duration interval;
+      std::map<std::string, CounterValue> counters;
+      std::map<std::string, HistogramSnapshot> histograms;
+    };
+
+    // Destination of exported snapshots. Write() is never called concurrently
+    // for the same sink.
+    class CounterSink {
+      public:
+        virtual ~CounterSink() = default;
+        virtual absl::Status Write(const CounterSnapshot& snapshot) = 0;
+    };
+
+    // Rewrites a file in the Prometheus text exposition format on every export,
+    // e.g. for the node_exporter textfile collector. The file is replaced
+    // atomically so scrapers never see a partial write. Counter and histogram
+    // names are prefixed with "mediapipe_" and sanitized to valid metric names;
+    // counters get the conventional "_total" suffix and histograms are
+    // exported as summaries. Sanitizing can map different names onto the same
+    // metric name ("a.b" and "a_b"); the later metric then gets a numeric
+    // suffix, which it keeps for the lifetime of the sink. The HELP line of
+    // every metric holds its original name.
+    class PrometheusTextFileSink : public CounterSink {
+      public:
+        explicit PrometheusTextFileSink(std::string path)
+            : path_(std::move(path)) {}
+        absl::Status Write(const CounterSnapshot& snapshot) override;
+
+      private:
+        // Returns the metric name assigned to the counter or histogram called
+        // name. On first use, assigns a unique one derived from stem. The
+        // metric exposes one series per suffix appended to the returned name.
+        const std::string& MetricName(
+            absl::flat_hash_map<std::string, std::string>& assigned,
+            const std::string& name, absl::string_view stem,
+            std::initializer_list<absl::string_view> suffixes);
+
+        const std::string path_;
+        absl::flat_hash_map<std::string, std::string> counter_names_;
+        absl::flat_hash_map<std::string, std::string> histogram_names_;
+        // All series names in use.
+        absl::flat_hash_set<std::string> series_names_;
+    };
+
+    // Appends one JSON object per export to a file.
+    class JsonLinesFileSink : public CounterSink {
+      public:
+        explicit JsonLinesFileSink(std::string path) : path_(std::move(path)) {}
+        absl::Status Write(const CounterSnapshot& snapshot) override;
+
+      private:
+        const std::string path_;
+    };
+
+    // Snapshots a CounterSet and writes the snapshot to a sink, either on
+    // demand or periodically from a background thread.
+    // This class is thread safe.
+    class CounterExporter {
+      public:
+        // counter_set must outlive the exporter.
+        CounterExporter(const CounterSet* counter_set,
+                        std::unique_ptr<CounterSink> sink);
+        // Stops the background thread, if any. Does not export.
+        ~CounterExporter();
+        CounterExporter(const CounterExporter&) = delete;
+        CounterExporter& operator=(const CounterExporter&) = delete;
+
+        // Starts exporting every interval from a background thread.
+        // Does nothing if already started or if interval is not positive.
+        void Start(absl::Duration interval)
+            ABSL_LOCKS_EXCLUDED(lifecycle_mu_, mu_);
+
+        // Stops the background thread and waits for it to finish.
+        void Stop() ABSL_LOCKS_EXCLUDED(lifecycle_mu_, mu_);
+
+        // Takes a snapshot and writes it to the sink from the calling thread.
+        absl::Status ExportNow() ABSL_LOCKS_EXCLUDED(export_mu_);
+
+      private:
+        void Run(absl::Duration interval) ABSL_LOCKS_EXCLUDED(mu_);
+
+        const CounterSet* const counter_set_;
+
+        // Serializes exports and guards the previous snapshot.
+        absl::Mutex export_mu_;
+        std::unique_ptr<CounterSink> sink_ ABSL_GUARDED_BY(export_mu_);
+        std::map<std::string, int64_t> previous_values_
+            ABSL_GUARDED_BY(export_mu_);
+        absl::Time previous_time_ ABSL_GUARDED_BY(export_mu_) =
+            absl::InfinitePast();
+
+        // Serializes Start() and Stop(), including the join.
+        absl::Mutex lifecycle_mu_;
+        std::thread thread_ ABSL_GUARDED_BY(lifecycle_mu_);
+
+        // Wakes the background thread up early when stopping.
+        absl::Mutex mu_;
+        bool stop_ ABSL_GUARDED_BY(mu_) = false;
+    };
+}  // namespace mediapipe
+
+#endif  // CUSTOM_MEDIAPIPE_COUNTER_EXPORTER_H
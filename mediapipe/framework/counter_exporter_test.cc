@@ -0,0 +1,83 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/counter_exporter.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+std::string ReadFile(const std::string& path) {
+  std::ifstream file(path);
+  std::stringstream contents;
+  contents << file.rdbuf();
+  return contents.str();
+}
+
+std::string TempPath(const std::string& name) {
+  return absl::StrCat(::testing::TempDir(), "/", name);
+}
+
+TEST(PrometheusTextFileSinkTest, CountersFollowNamingConvention) {
+  const std::string path = TempPath("counters.prom");
+  PrometheusTextFileSink sink(path);
+  CounterSnapshot snapshot;
+  snapshot.counters["Node/a/packets"].value = 3;
+  snapshot.counters["frames_total"].value = 5;
+  MP_ASSERT_OK(sink.Write(snapshot));
+
+  const std::string text = ReadFile(path);
+  EXPECT_THAT(text, ::testing::HasSubstr(
+                        "# TYPE mediapipe_Node_a_packets_total counter\n"
+                        "mediapipe_Node_a_packets_total 3\n"));
+  EXPECT_THAT(text, ::testing::HasSubstr("\nmediapipe_frames_total 5\n"));
+  EXPECT_THAT(text, ::testing::HasSubstr(
+                        "# HELP mediapipe_Node_a_packets_total Node/a/packets\n"));
+}
+
+TEST(PrometheusTextFileSinkTest, CollidingNamesGetDistinctSeries) {
+  const std::string path = TempPath("collisions.prom");
+  PrometheusTextFileSink sink(path);
+  CounterSnapshot snapshot;
+  snapshot.counters["Node/a.b/x"].value = 1;
+  snapshot.counters["Node/a_b/x"].value = 2;
+  snapshot.counters["y"].value = 3;
+  snapshot.counters["y_total"].value = 4;
+  snapshot.histograms["h"];
+  snapshot.histograms["h.sum"];
+  MP_ASSERT_OK(sink.Write(snapshot));
+
+  const std::string text = ReadFile(path);
+  EXPECT_THAT(text, ::testing::HasSubstr("\nmediapipe_Node_a_b_x_total 1\n"));
+  EXPECT_THAT(text, ::testing::HasSubstr("\nmediapipe_Node_a_b_x_2_total 2\n"));
+  EXPECT_THAT(text, ::testing::HasSubstr("\nmediapipe_y_total 3\n"));
+  EXPECT_THAT(text, ::testing::HasSubstr("\nmediapipe_y_2_total 4\n"));
+  EXPECT_THAT(text, ::testing::HasSubstr("\nmediapipe_h_sum 0\n"));
+  EXPECT_THAT(text, ::testing::HasSubstr("\nmediapipe_h_sum_2_sum 0\n"));
+
+  // A name keeps its series when a colliding name goes away.
+  snapshot.counters.erase("Node/a.b/x");
+  MP_ASSERT_OK(sink.Write(snapshot));
+  EXPECT_THAT(ReadFile(path),
+              ::testing::HasSubstr("\nmediapipe_Node_a_b_x_2_total 2\n"));
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -16,20 +16,24 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include "mediaipipe/framework/counter_factory.h"
+#include "mediapipe/framework/counter_factory.h"
+
+#include <atomic>
+#include <memory>
 #include <vector>
+
 #include "absl/log/absl_log.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/strings/string_view.h"
+#include "mediapipe/framework/deps/thread_shard.h"
 
 namespace mediapipe {
 namespace {
     // Counter implementation when we're not using Flume.
-    // TODO: Consider using Dax atomic counters instead of this.
     // This class is thread safe.
     class BasicCounter : public Counter {
       public:
-        explicit BasicCounter(const std::string& name) : value_(0) {}
+        BasicCounter() : value_(0) {}
 
         void Increment() ABSL_LOCKS_EXCLUDED(mu_) override{
           absl::WriterMutexLock lock(&mu_);
@@ -38,52 +42,134 @@ namespace {
 
         void IncrementBy(int amount) ABSL_LOCKS_EXCLUDED(mu_) override{
           absl::WriterMutexLock lock(&mu_);
-          ++value_;
+          value_ += amount;
         }
 
-        intt64_t Get() ABSL_LOCKS_EXCLUDED(mu_) override{
-          absl::WriterMutexLock lock(&mu_);
+        int64_t Get() ABSL_LOCKS_EXCLUDED(mu_) override{
+          absl::ReaderMutexLock lock(&mu_);
           return value_;
         }
         private:
           absl::Mutex mu_;
           int64_t value_ ABSL_GUARDED_BY(mu_);
-      };
-    } // namespace
+    };
+
+    // Counter implementation that spreads increments over per-thread shards.
+    // Every shard lives on its own cache line, so writers on different threads
+    // only ever touch their own line and never take a lock. Get() sums the
+    // shards and therefore observes each increment exactly once, though it may
+    // miss increments that race with it.
+    // This class is thread safe.
+    class ShardedCounter : public Counter {
+      public:
+        ShardedCounter()
+            : num_shards_(NumThreadShards()),
+              shards_(new Shard[num_shards_]) {}
+
+        void Increment() override { IncrementBy(1); }
+
+        void IncrementBy(int amount) override {
+          shards_[ThisThreadShard()].value.fetch_add(
+              amount, std::memory_order_relaxed);
+        }
+
+        int64_t Get() override {
+          int64_t sum = 0;
+          for (int i = 0; i < num_shards_; ++i) {
+            sum += shards_[i].value.load(std::memory_order_relaxed);
+          }
+          return sum;
+        }
+
+      private:
+        struct alignas(kCacheLineSize) Shard {
+          std::atomic<int64_t> value{0};
+        };
+
+        const int num_shards_;
+        std::unique_ptr<Shard[]> shards_;
+    };
+} // namespace
 
     CounterSet::CounterSet() {}
 
-    CounterSet::~CounterSet() ABSL_LOCKS_EXCLUDED(mu_) { PublishCounters(); }
+    CounterSet::~CounterSet() ABSL_LOCKS_EXCLUDED(mu_) {
+      {
+        absl::MutexLock lock(&exporter_mu_);
+        if (exporter_) exporter_->Stop();
+      }
+      PublishCounters();
+    }
+
+    void CounterSet::PublishCounters() ABSL_LOCKS_EXCLUDED(exporter_mu_) {
+      absl::MutexLock lock(&exporter_mu_);
+      if (!exporter_) return;
+      absl::Status status = exporter_->ExportNow();
+      ABSL_LOG_IF(WARNING, !status.ok()) << "Counter export failed: " << status;
+    }
 
-    void CounterSet::PublishCounters() ABSL_LOCKS_EXCLUDED(mu_) {}
+    void CounterSet::StartExporting(std::unique_ptr<CounterSink> sink,
+                                    absl::Duration interval)
+    ABSL_LOCKS_EXCLUDED(exporter_mu_) {
+      auto exporter = std::make_unique<CounterExporter>(this, std::move(sink));
+      exporter->Start(interval);
+      absl::MutexLock lock(&exporter_mu_);
+      exporter_ = std::move(exporter);
+    }
 
     void CounterSet::PrintCounters() ABSL_LOCKS_EXCLUDED(mu_) {
-      absl::ReaderMutexLock lock(&mu_);
-      ABSL_LOG_IF(INFO, !counters_.empty()) << "MediaPipe counters: ";
-      for(const aura::Counter& counter : counters_) {
-        ABSL_LOG(INFO) << counter.first << ": " << counter.second->Get();
+      std::map<std::string, int64_t> values = GetCountersValues();
+      ABSL_LOG_IF(INFO, !values.empty()) << "MediaPipe counters: ";
+      for(const auto& counter : values) {
+        ABSL_LOG(INFO) << counter.first << ": " << counter.second;
+      }
+      for (const auto& histogram : GetHistogramsValues()) {
+        const HistogramSnapshot& snapshot = histogram.second;
+        ABSL_LOG(INFO) << histogram.first << ": count=" << snapshot.count()
+                       << " p50=" << snapshot.P50() << " p90=" << snapshot.P90()
+                       << " p99=" << snapshot.P99() << " max=" << snapshot.max();
       }
     }
 
-    Counter* CounterSet::Get(const std::string& name) ABSL_LOCKS_EXCLUDED(mu_) {
-      absl::ReaderMutexLock lock(&mu_);
-      if(!mediapipe::ContainsKey(counters_, name)) {
-        return nullptr;
-      }
-      return counters_[name].get();
+    std::map<std::string, int64_t> CounterSet::GetCountersValues() const {
+      std::map<std::string, int64_t> result;
+      counter_index_.ForEach([&result](const std::string& name, Counter* counter) {
+        result[name] = counter->Get();
+      });
+      return result;
     }
 
-    std::map<std::string, int64_t> CounterSet::GetCountersValues()
+    Histogram* CounterSet::EmplaceHistogram(const std::string& name)
     ABSL_LOCKS_EXCLUDED(mu_) {
-      absl::ReaderMutexLock lock(&mu_);
-      std::map<std::string, int64_t> result;
-      for (const auto& it : counters_) {
-        result[it.first] = it.second->Get();
+      if (Histogram* existing_histogram = GetHistogram(name)) {
+        return existing_histogram;
       }
+      absl::WriterMutexLock lock(&mu_);
+      std::unique_ptr<Histogram>* existing_histogram =
+          FindOrNull(histograms_, name);
+      if (existing_histogram) {
+        return existing_histogram->get();
+      }
+      auto it = histograms_.emplace(name, std::make_unique<Histogram>()).first;
+      histogram_index_.Insert(name, it->second.get());
+      return it->second.get();
+    }
+
+    std::map<std::string, HistogramSnapshot> CounterSet::GetHistogramsValues()
+    const {
+      std::map<std::string, HistogramSnapshot> result;
+      histogram_index_.ForEach(
+          [&result](const std::string& name, Histogram* histogram) {
+            result[name] = histogram->Snapshot();
+          });
       return result;
     }
 
   Counter* BasicCounterFactory::GetCounter(const std::string& name) {
-    return counter_set_.Emplace<BasicCounter>(name, name);
+    return counter_set_.Emplace<BasicCounter>(name);
+  }
+
+  Counter* ShardedCounterFactory::GetCounter(const std::string& name) {
+    return counter_set_.Emplace<ShardedCounter>(name);
   }
 } // mediapipe
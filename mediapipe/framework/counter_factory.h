@@ -25,53 +25,119 @@
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 #include "mediapipe/framework/counter.h"
+#include "mediapipe/framework/counter_exporter.h"
+#include "mediapipe/framework/deps/lock_free_name_index.h"
+#include "mediapipe/framework/histogram.h"
 #include "mediapipe/framework/port.h"
-#include "mediapipe/framework/port/map_utils.h"
+#include "mediapipe/framework/port/map_util.h"
 
 namespace mediapipe {
-    // Holds a map of counter names to counter unique_ptrs.
-    // This class is thread safe.
+    // A counter resolved once by name. Resolve handles up front (e.g. in Open())
+    // and increment through them on the hot path to skip the name lookup.
+    // A handle stays valid for the lifetime of the CounterSet that owns the
+    // counter. A default-constructed handle is invalid and must not be used.
+    class CounterHandle {
+      public:
+        CounterHandle() = default;
+        explicit CounterHandle(Counter* counter) : counter_(counter) {}
+
+        bool IsValid() const { return counter_ != nullptr; }
+        void Increment() const { counter_->Increment(); }
+        void IncrementBy(int amount) const { counter_->IncrementBy(amount); }
+        int64_t Get() const { return counter_->Get(); }
+        Counter* counter() const { return counter_; }
+
+      private:
+        Counter* counter_ = nullptr;
+    };
+
+    // Holds a map of counter names to counter unique_ptrs, and a separate map
+    // of histogram names to histograms.
+    // This class is thread safe. Lookups by name (Get, GetHandle, GetHistogram,
+    // GetCountersValues, GetHistogramsValues) never take a lock; see
+    // LockFreeNameIndex. Only adding a new counter or histogram locks mu_.
     class CounterSet {
     public:
         CounterSet();
 
-        // In builds with streamz export enabled, this will synchronously export
-        // the final counter values.
+        // If exporting was started, stops the background exporter and then
+        // synchronously exports the final counter values through it.
         ~CounterSet();
 
         // Prints the values of all the counters.
-        // A call to PublishCounters will reset all counters.
         void PrintCounters();
 
-        // Publishes the vales of all the counters for monitoring and resets
-        // all internal counters.
-        void PublishCounter();
+        // Publishes the values of all the counters through the exporter, if
+        // exporting was started. Counters are not reset; the exporter reports
+        // deltas relative to its previous export instead.
+        void PublishCounters() ABSL_LOCKS_EXCLUDED(exporter_mu_);
+
+        // Starts exporting snapshots of all counters and histograms to sink
+        // every interval from a background thread. A non-positive interval only
+        // exports on PublishCounters() and destruction. Replaces (and stops)
+        // any previous exporter.
+        void StartExporting(std::unique_ptr<CounterSink> sink,
+                            absl::Duration interval) ABSL_LOCKS_EXCLUDED(exporter_mu_);
 
         // Adds a counter of the given type by constructing the counter in place.
         // Returns a pointer to the new counter or if the counter already exists
         // to the existing pointer.
         template <typename CounterType, typename... Args>
         Counter* Emplace(const std::string& name, Args&&... args) ABSL_LOCKS_EXCLUDED(mu_) {
+          if (Counter* existing_counter = Get(name)) {
+            return existing_counter;
+          }
           absl::WriterMutexLock lock(&mu_);
           std::unique_ptr<Counter>* existing_counter = FindOrNull(counters_, name);
           if(existing_counter) {
             return existing_counter->get();
           }
-          Counter* counter = new CounterType(std::forward<Args>(args)...);
-          counters_[name].reset(counter);
-          return counter;
+          auto it = counters_.emplace(name, std::make_unique<CounterType>(
+                                                std::forward<Args>(args)...)).first;
+          counter_index_.Insert(name, it->second.get());
+          return it->second.get();
         }
 
         // Retrieves the counter with the given name; return nullptr if it doesn't
-        // exist.
-        Couneter* Get(const std::string& name);
+        // exist. Never blocks.
+        Counter* Get(const std::string& name) const {
+          return counter_index_.Find(name);
+        }
+
+        // Same as Get, wrapped in a handle. The handle is invalid if the counter
+        // doesn't exist.
+        CounterHandle GetHandle(const std::string& name) const {
+          return CounterHandle(Get(name));
+        }
 
         // Retrieves all counters names and current values from the internal map.
-        std::map<std::string, int64_t> GetCountersValues() ABSL_LOCKS_EXCLUDED(mu_);
+        // Never blocks writers.
+        std::map<std::string, int64_t> GetCountersValues() const;
+
+        // Adds a histogram with the given name. Returns a pointer to the new
+        // histogram or if the histogram already exists to the existing pointer.
+        Histogram* EmplaceHistogram(const std::string& name) ABSL_LOCKS_EXCLUDED(mu_);
+
+        // Retrieves the histogram with the given name; return nullptr if it
+        // doesn't exist. Never blocks.
+        Histogram* GetHistogram(const std::string& name) const {
+          return histogram_index_.Find(name);
+        }
+
+        // Retrieves all histogram names and snapshots of their current contents.
+        // Never blocks writers or recorders.
+        std::map<std::string, HistogramSnapshot> GetHistogramsValues() const;
 
         private:
           absl::Mutex mu_;
           std::map<std::string, std::unique_ptr<Counter>> counters_ ABSL_GUARDED_BY(mu_);
+          std::map<std::string, std::unique_ptr<Histogram>> histograms_ ABSL_GUARDED_BY(mu_);
+          // Inserts are serialized by mu_; lookups take no lock.
+          LockFreeNameIndex<Counter> counter_index_;
+          LockFreeNameIndex<Histogram> histogram_index_;
+
+          absl::Mutex exporter_mu_;
+          std::unique_ptr<CounterExporter> exporter_ ABSL_GUARDED_BY(exporter_mu_);
     };
 
     // Generic counter factory
@@ -79,6 +145,14 @@ namespace mediapipe {
         public:
           virtual ~CounterFactory() {}
           virtual Counter* GetCounter(const std::string& name) = 0;
+          // Creates the counter if needed and returns a handle to it.
+          CounterHandle GetCounterHandle(const std::string& name) {
+            return CounterHandle(GetCounter(name));
+          }
+          // Creates the histogram if needed and returns it.
+          Histogram* GetHistogram(const std::string& name) {
+            return counter_set_.EmplaceHistogram(name);
+          }
           CounterSet* GetCounterSet() { return &counter_set_;}
 
         protected:
@@ -92,6 +166,18 @@ namespace mediapipe {
         Counter* GetCounter(const std::string& name) override;
     };
 
+    // Counter factory that makes lock-free sharded counters. Each counter keeps
+    // one cache-line-sized atomic slot per thread shard, so increments from
+    // different threads never contend; Get() sums all the shards.
+    // CalculatorGraph uses this factory, since its counters are bumped from
+    // many calculator threads at once. Each counter costs NumThreadShards()
+    // cache lines of memory.
+    class ShardedCounterFactory : public CounterFactory {
+      public:
+        ~ShardedCounterFactory() override {}
+        Counter* GetCounter(const std::string& name) override;
+    };
+
 } // namespace mediapipe
 
 #endif //CUSTOM_MEDIAPIPE_COUNTER_FACTORY_H
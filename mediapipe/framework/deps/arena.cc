@@ -0,0 +1,61 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/deps/arena.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace mediapipe {
+
+    Arena::~Arena() { Reset(); }
+
+    absl::string_view Arena::CopyString(absl::string_view str) {
+      char* data = CreateArray<char>(str.size());
+      std::memcpy(data, str.data(), str.size());
+      return absl::string_view(data, str.size());
+    }
+
+    void Arena::Reset() {
+      for (auto it = cleanups_.rbegin(); it != cleanups_.rend(); ++it) {
+        it->destroy(it->object);
+      }
+      cleanups_.clear();
+      current_ = 0;
+      position_ = nullptr;
+      limit_ = nullptr;
+      num_allocations_ = 0;
+      num_heap_allocations_ = 0;
+      bytes_used_ = 0;
+    }
+
+    char* Arena::NextBlock(size_t size, size_t alignment) {
+      const size_t needed = size + alignment - 1;
+      size_t next = position_ == nullptr ? 0 : current_ + 1;
+      // Blocks kept by Reset() that are too small stay unused until the next
+      // Reset().
+      while (next < blocks_.size() && blocks_[next].size < needed) ++next;
+      if (next == blocks_.size()) {
+        const size_t block_size = std::max(block_size_, needed);
+        blocks_.push_back({std::unique_ptr<char[]>(new char[block_size]),
+                           block_size});
+        ++num_heap_allocations_;
+      }
+      current_ = next;
+      char* begin = blocks_[next].data.get();
+      limit_ = begin + blocks_[next].size;
+      return AlignUp(begin, alignment);
+    }
+
+}  // namespace mediapipe
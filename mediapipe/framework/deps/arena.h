@@ -0,0 +1,168 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// A bump allocator: memory is carved sequentially out of large blocks and
+// only given back all at once, by Reset() or the destructor. Blocks are kept
+// across Reset(), so an arena that is reset after every use stops calling
+// malloc once it has grown to its working size.
+
+#ifndef MEDIAPIPE_DEPS_ARENA_H_
+#define MEDIAPIPE_DEPS_ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+
+namespace mediapipe {
+    // This class is thread compatible.
+    class Arena {
+      public:
+        // Blocks are block_size bytes, or larger for larger allocations.
+        explicit Arena(size_t block_size = 4096) : block_size_(block_size) {}
+        ~Arena();
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        // Returns size bytes aligned to alignment, a power of two.
+        void* Allocate(size_t size,
+                       size_t alignment = alignof(std::max_align_t));
+
+        // Constructs a T in the arena. Its destructor, if not trivial, runs on
+        // Reset() or when the arena is destroyed.
+        template <typename T, typename... Args>
+        T* Create(Args&&... args);
+
+        // Returns n default-initialized Ts, which must be trivially
+        // destructible.
+        template <typename T>
+        T* CreateArray(size_t n);
+
+        // Copies str into the arena.
+        absl::string_view CopyString(absl::string_view str);
+
+        // Destroys the objects of Create(), newest first, and makes all
+        // memory available again. Keeps the blocks.
+        void Reset();
+
+        // Since the last Reset(): Allocate() calls, blocks allocated from the
+        // heap for them, and bytes handed out.
+        int64_t NumAllocations() const { return num_allocations_; }
+        int64_t NumHeapAllocations() const { return num_heap_allocations_; }
+        size_t BytesUsed() const { return bytes_used_; }
+
+      private:
+        struct Block {
+          std::unique_ptr<char[]> data;
+          size_t size;
+        };
+        struct Cleanup {
+          void (*destroy)(void*);
+          void* object;
+        };
+
+        static char* AlignUp(char* p, size_t alignment) {
+          uintptr_t address = reinterpret_cast<uintptr_t>(p);
+          return reinterpret_cast<char*>((address + alignment - 1) &
+                                         ~(alignment - 1));
+        }
+
+        // Moves to a block with room for size bytes at alignment, allocating
+        // one if needed, and returns the aligned position in it.
+        char* NextBlock(size_t size, size_t alignment);
+
+        const size_t block_size_;
+        std::vector<Block> blocks_;
+        // blocks_[current_] is being filled from position_ to limit_.
+        size_t current_ = 0;
+        char* position_ = nullptr;
+        char* limit_ = nullptr;
+        std::vector<Cleanup> cleanups_;
+        int64_t num_allocations_ = 0;
+        int64_t num_heap_allocations_ = 0;
+        size_t bytes_used_ = 0;
+    };
+
+    // Lets standard containers allocate from an arena. Deallocation is a
+    // no-op; the memory comes back with Arena::Reset().
+    template <typename T>
+    class ArenaAllocator {
+      public:
+        using value_type = T;
+
+        explicit ArenaAllocator(Arena* arena) : arena_(arena) {}
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena()) {}
+
+        T* allocate(size_t n) {
+          return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+        }
+        void deallocate(T*, size_t) {}
+
+        Arena* arena() const { return arena_; }
+
+        template <typename U>
+        bool operator==(const ArenaAllocator<U>& other) const {
+          return arena_ == other.arena();
+        }
+        template <typename U>
+        bool operator!=(const ArenaAllocator<U>& other) const {
+          return arena_ != other.arena();
+        }
+
+      private:
+        Arena* arena_;
+    };
+
+    // Implementation details.
+
+    inline void* Arena::Allocate(size_t size, size_t alignment) {
+      ++num_allocations_;
+      bytes_used_ += size;
+      char* result = AlignUp(position_, alignment);
+      if (position_ == nullptr || result > limit_ ||
+          size > static_cast<size_t>(limit_ - result)) {
+        result = NextBlock(size, alignment);
+      }
+      position_ = result + size;
+      return result;
+    }
+
+    template <typename T, typename... Args>
+    T* Arena::Create(Args&&... args) {
+      T* object = new (Allocate(sizeof(T), alignof(T)))
+          T(std::forward<Args>(args)...);
+      if constexpr (!std::is_trivially_destructible_v<T>) {
+        cleanups_.push_back(
+            {[](void* p) { static_cast<T*>(p)->~T(); }, object});
+      }
+      return object;
+    }
+
+    template <typename T>
+    T* Arena::CreateArray(size_t n) {
+      static_assert(std::is_trivially_destructible_v<T>,
+                    "Arena arrays are never destroyed.");
+      T* array = static_cast<T*>(Allocate(n * sizeof(T), alignof(T)));
+      std::uninitialized_default_construct_n(array, n);
+      return array;
+    }
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_DEPS_ARENA_H_
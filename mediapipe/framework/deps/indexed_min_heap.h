@@ -0,0 +1,97 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// A binary min-heap over the items 0..n-1, each with a key that can be
+// changed in place. Finding the smallest key is O(1), changing a key
+// O(log n).
+
+#ifndef MEDIAPIPE_DEPS_INDEXED_MIN_HEAP_H_
+#define MEDIAPIPE_DEPS_INDEXED_MIN_HEAP_H_
+
+#include <utility>
+#include <vector>
+
+#include "absl/log/absl_check.h"
+
+namespace mediapipe {
+    // Key must be copyable and ordered by operator<. Ties are broken
+    // arbitrarily.
+    // This class is thread compatible.
+    template <typename Key>
+    class IndexedMinHeap {
+      public:
+        // Items 0..size-1, all with the given key.
+        IndexedMinHeap(int size, const Key& key)
+            : heap_(size), position_(size), keys_(size, key) {
+          for (int i = 0; i < size; ++i) heap_[i] = position_[i] = i;
+        }
+
+        int Size() const { return static_cast<int>(heap_.size()); }
+
+        // The item with the smallest key. Requires Size() > 0.
+        int Top() const {
+          ABSL_DCHECK(!heap_.empty());
+          return heap_[0];
+        }
+        const Key& TopKey() const { return keys_[Top()]; }
+
+        const Key& KeyOf(int item) const { return keys_[item]; }
+        void Update(int item, const Key& key) {
+          bool decreased = key < keys_[item];
+          keys_[item] = key;
+          if (decreased) {
+            SiftUp(position_[item]);
+          } else {
+            SiftDown(position_[item]);
+          }
+        }
+
+      private:
+        bool Less(int a, int b) const { return keys_[heap_[a]] < keys_[heap_[b]]; }
+
+        void Swap(int a, int b) {
+          std::swap(heap_[a], heap_[b]);
+          position_[heap_[a]] = a;
+          position_[heap_[b]] = b;
+        }
+
+        void SiftUp(int pos) {
+          while (pos > 0 && Less(pos, (pos - 1) / 2)) {
+            Swap(pos, (pos - 1) / 2);
+            pos = (pos - 1) / 2;
+          }
+        }
+
+        void SiftDown(int pos) {
+          const int size = Size();
+          while (true) {
+            int smallest = pos;
+            int left = 2 * pos + 1;
+            if (left < size && Less(left, smallest)) smallest = left;
+            if (left + 1 < size && Less(left + 1, smallest)) smallest = left + 1;
+            if (smallest == pos) return;
+            Swap(pos, smallest);
+            pos = smallest;
+          }
+        }
+
+        // Items in heap order.
+        std::vector<int> heap_;
+        // Index in heap_ of each item.
+        std::vector<int> position_;
+        std::vector<Key> keys_;
+    };
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_DEPS_INDEXED_MIN_HEAP_H_
@@ -0,0 +1,130 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_DEPS_LOCK_FREE_NAME_INDEX_H_
+#define MEDIAPIPE_DEPS_LOCK_FREE_NAME_INDEX_H_
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/hash/hash.h"
+#include "absl/strings/string_view.h"
+
+namespace mediapipe {
+    // An insert-only index from names to non-owned T pointers whose lookups
+    // never take a lock.
+    //
+    // Entries live in an open-addressing hash table. Insert() fills a free slot
+    // of the current table in place, or publishes a copy with twice the
+    // capacity once the table is half full. Since nothing is ever removed,
+    // replaced tables are kept alive until the index is destroyed, which bounds
+    // the extra memory to about twice the final table.
+    //
+    // Find() and ForEach() are safe to call concurrently with each other and
+    // with Insert(). Calls to Insert() must be serialized by the caller.
+    template <typename T>
+    class LockFreeNameIndex {
+      public:
+        LockFreeNameIndex() = default;
+        LockFreeNameIndex(const LockFreeNameIndex&) = delete;
+        LockFreeNameIndex& operator=(const LockFreeNameIndex&) = delete;
+
+        // Adds name -> value. The name must not already be present.
+        void Insert(absl::string_view name, T* value) {
+          constexpr size_t kInitialCapacity = 16;
+          entries_.push_back(Entry{std::string(name), value});
+          const Entry* entry = &entries_.back();
+          const Table* current = table_.load(std::memory_order_relaxed);
+          if (current != nullptr && entries_.size() * 2 <= current->capacity()) {
+            tables_.back()->Insert(entry);
+            return;
+          }
+          auto table = std::make_unique<Table>(
+              current ? current->capacity() * 2 : kInitialCapacity);
+          for (const Entry& e : entries_) {
+            table->Insert(&e);
+          }
+          table_.store(table.get(), std::memory_order_release);
+          tables_.push_back(std::move(table));
+        }
+
+        // Returns the value for name, or nullptr if it was never inserted.
+        T* Find(absl::string_view name) const {
+          const Table* table = table_.load(std::memory_order_acquire);
+          if (table == nullptr) return nullptr;
+          size_t i = Hash(name) & table->mask;
+          while (const Entry* entry =
+                     table->slots[i].load(std::memory_order_acquire)) {
+            if (entry->name == name) return entry->value;
+            i = (i + 1) & table->mask;
+          }
+          return nullptr;
+        }
+
+        // Calls fn(const std::string& name, T* value) for every entry visible
+        // at the time of the call, in no particular order.
+        template <typename Fn>
+        void ForEach(Fn fn) const {
+          const Table* table = table_.load(std::memory_order_acquire);
+          if (table == nullptr) return;
+          for (size_t i = 0; i < table->capacity(); ++i) {
+            if (const Entry* entry =
+                    table->slots[i].load(std::memory_order_acquire)) {
+              fn(entry->name, entry->value);
+            }
+          }
+        }
+
+      private:
+        struct Entry {
+          std::string name;
+          T* value;
+        };
+
+        struct Table {
+          explicit Table(size_t capacity)
+              : mask(capacity - 1),
+                slots(new std::atomic<const Entry*>[capacity]()) {}
+
+          size_t capacity() const { return mask + 1; }
+
+          void Insert(const Entry* entry) {
+            size_t i = Hash(entry->name) & mask;
+            while (slots[i].load(std::memory_order_relaxed) != nullptr) {
+              i = (i + 1) & mask;
+            }
+            slots[i].store(entry, std::memory_order_release);
+          }
+
+          const size_t mask;
+          std::unique_ptr<std::atomic<const Entry*>[]> slots;
+        };
+
+        static size_t Hash(absl::string_view name) {
+          return absl::Hash<absl::string_view>()(name);
+        }
+
+        // Element addresses in a deque are stable across push_back.
+        std::deque<Entry> entries_;
+        // All tables ever published; the last one is current.
+        std::vector<std::unique_ptr<Table>> tables_;
+        std::atomic<const Table*> table_{nullptr};
+    };
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_DEPS_LOCK_FREE_NAME_INDEX_H_
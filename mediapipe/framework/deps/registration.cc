@@ -1,3 +1,109 @@
+// Copyright 2019 The MediaPipe Authors.
 //
-// Created by MSD on 12/06/2025.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
 //
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/deps/registration.h"
+
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+
+namespace mediapipe {
+namespace {
+    constexpr char const* kTopNamespaces[] = {
+        "mediapipe",
+    };
+
+    using registration_internal::StaticRegistration;
+
+    // The static registrations of all loaded objects, and the registries
+    // waiting for them.
+    class StaticRegistrations {
+      public:
+        void Add(const StaticRegistration* const* begin,
+                 const StaticRegistration* const* end) ABSL_LOCKS_EXCLUDED(mu_) {
+          if (begin == nullptr || begin == end) return;
+          absl::MutexLock lock(&mu_);
+          for (const auto& range : ranges_) {
+            if (range.first == begin) return;
+          }
+          ranges_.emplace_back(begin, end);
+          for (const Subscriber& subscriber : subscribers_) {
+            Dispatch(begin, end, subscriber);
+          }
+        }
+
+        void Subscribe(const void* registry,
+                       std::function<void(const StaticRegistration&)> fn)
+            ABSL_LOCKS_EXCLUDED(mu_) {
+          absl::MutexLock lock(&mu_);
+          subscribers_.push_back(Subscriber{registry, std::move(fn)});
+          for (const auto& range : ranges_) {
+            Dispatch(range.first, range.second, subscribers_.back());
+          }
+        }
+
+      private:
+        struct Subscriber {
+          const void* registry;
+          std::function<void(const StaticRegistration&)> fn;
+        };
+
+        static void Dispatch(const StaticRegistration* const* begin,
+                             const StaticRegistration* const* end,
+                             const Subscriber& subscriber) {
+          for (const StaticRegistration* const* r = begin; r != end; ++r) {
+            if (*r != nullptr && (*r)->registry == subscriber.registry) {
+              subscriber.fn(**r);
+            }
+          }
+        }
+
+        absl::Mutex mu_;
+        std::vector<std::pair<const StaticRegistration* const*,
+                              const StaticRegistration* const*>>
+            ranges_ ABSL_GUARDED_BY(mu_);
+        std::vector<Subscriber> subscribers_ ABSL_GUARDED_BY(mu_);
+    };
+
+    StaticRegistrations& GetStaticRegistrations() {
+      static auto* registrations = new StaticRegistrations();
+      return *registrations;
+    }
+}  // namespace
+
+namespace registration_internal {
+
+    void AddStaticRegistrations(const StaticRegistration* const* begin,
+                                const StaticRegistration* const* end) {
+      GetStaticRegistrations().Add(begin, end);
+    }
+
+    void SubscribeToStaticRegistrations(
+        const void* registry,
+        std::function<void(const StaticRegistration&)> fn) {
+      GetStaticRegistrations().Subscribe(registry, std::move(fn));
+    }
+
+}  // namespace registration_internal
+
+    // static
+    const absl::flat_hash_set<std::string>& NamespaceAllowlist::TopNamespaces() {
+      static const auto* result = new absl::flat_hash_set<std::string>(
+          std::begin(kTopNamespaces), std::end(kTopNamespaces));
+      return *result;
+    }
+
+}  // namespace mediapipe
@@ -6,26 +6,37 @@
 #define MEDIAPIPE_DEPS_REGISTRATION_H_
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
 #include <functional>
+#include <memory>
 #include <string>
 #include <tuple>
 #include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "absl/base/macros.h"
+#include "absl/base/optimization.h"
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/container/node_hash_set.h"
+#include "absl/hash/hash.h"
 #include "absl/log/absl_check.h"
 #include "absl/log/absl_log.h"
 #include "absl/meta/type_traits.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/deps/registration_token.h"
+#include "mediapipe/framework/deps/thread_shard.h"
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/statusor.h"
 
@@ -119,6 +130,45 @@ namespace mediapipe {
     //      [](unique_ptr<Gadget> arg, const Thing* thing) {
     //        ...
     //      }));
+    //
+    // === Freezing the registry for fast lookups ==============================
+    //
+    //  // Once static registration is done (e.g. at the start of main() or before
+    //  // the first graph is built), freeze the registry. Lookups then read an
+    //  // immutable table without taking any lock.
+    //  WidgetRegistry::Freeze();
+    //
+    //  // Resolve a name once and reuse the handle to also skip name
+    //  // normalization and hashing on every call.
+    //  static const auto handle = WidgetRegistry::GetHandle("my_ns.MyWidget");
+    //  auto s_or_widget = WidgetRegistry::CreateByHandle(handle, ...);
+    //
+    // Registering or unregistering after Freeze() thaws the registry; the next
+    // lookup freezes it again. Existing handles stay valid and fall back to a
+    // lookup by name. A default-constructed handle resolves to NotFound.
+    // A replaced table is freed by the first later change made while no
+    // lookup by name is running, or once the last handle resolved against it
+    // is destroyed, so registering and unregistering at run time does not
+    // accumulate copies of the table.
+    //
+    // === Registering without static initializers =============================
+    //
+    //  // The factory must be a plain function or a captureless lambda.
+    //  MEDIAPIPE_STATIC_REGISTER_FACTORY_FUNCTION_QUALIFIED(
+    //      WidgetRegistry, widget_registration, ::my_ns::MyWidget,
+    //      [](unique_ptr<Gadget> arg, const Thing* thing)
+    //          -> unique_ptr<Widget> { ... });
+    //
+    // The name and function pointer are emitted as constant data into a
+    // dedicated linker section, so no per-registration code runs at process
+    // start. Each executable or shared library hands its section to the
+    // framework once, when it is loaded; the entries of a registry are merged
+    // into it the first time the registry is used, or when a library with more
+    // entries is loaded later. A library loaded with dlopen() only reaches the
+    // registries of the executable if the executable exports them (e.g. links
+    // with -rdynamic). Unloading such a library is not supported.
+    // On toolchains without ELF linker sections this falls back to a regular
+    // static-initializer registration.
 
     namespace registration_internal {
         inline constexpr char kCxxSep[] = "::";
@@ -147,6 +197,36 @@ namespace mediapipe {
                 char force_static[Use()];
           	#endif
         };
+
+        // A typed factory function pointer, referenced from a
+        // StaticRegistration.
+        template <typename R, typename... Args>
+        struct StaticFactory {
+          R (*function)(Args...);
+        };
+
+        // One registration emitted as constant data by
+        // MEDIAPIPE_STATIC_REGISTER_FACTORY_FUNCTION_QUALIFIED.
+        struct StaticRegistration {
+          // Identifies the registry; see GlobalFactoryRegistry::StaticTag().
+          const void* registry;
+          const char* name;
+          // Points to the StaticFactory<R, Args...> of that registry.
+          const void* factory;
+        };
+
+        // Adds the static registrations of one executable or shared library
+        // and passes them to the registries already subscribed. A range that
+        // was already added is ignored, as is an empty one.
+        void AddStaticRegistrations(const StaticRegistration* const* begin,
+                                    const StaticRegistration* const* end);
+
+        // Calls fn for every StaticRegistration added so far whose registry is
+        // the given tag, and for every such registration added later. fn must
+        // stay callable for the lifetime of the process.
+        void SubscribeToStaticRegistrations(
+            const void* registry,
+            std::function<void(const StaticRegistration&)> fn);
     }
 
     class NamespaceAllowlist {
@@ -156,56 +236,553 @@ namespace mediapipe {
 
     template <typename R, typename... Args>
     class FunctionRegistry {
+      private:
+        struct FrozenEntry;
+        struct FrozenTable;
+
       public:
         using Function = std::function<R(Args...)>;
         using ReturnType = typename registration_internal::WrapStatusOr<R>::type;
 
+        // A registered name resolved once by GetHandle(). Handles stay valid
+        // for the lifetime of the registry; a copy costs a reference count.
+        class Handle {
+          public:
+            Handle() = default;
+
+            // Whether this handle was returned by GetHandle().
+            bool IsResolved() const { return name_ != nullptr; }
+
+            // The normalized name this handle was resolved for, or an empty
+            // string if the handle is not resolved.
+            const std::string& name() const {
+              static const std::string* const kEmpty = new std::string();
+              return name_ != nullptr ? *name_ : *kEmpty;
+            }
+
+          private:
+            friend class FunctionRegistry;
+
+            // Interned by the registry.
+            const std::string* name_ = nullptr;
+            // The frozen table current when the handle was resolved, kept alive
+            // by the handle so that using it needs no ReaderGuard.
+            std::shared_ptr<const FrozenTable> table_;
+            // The entry in table_, or nullptr if the name was not registered
+            // when that table was built.
+            const FrozenEntry* entry_ = nullptr;
+        };
+
         FunctionRegistry() {}
         FunctionRegistry(const FunctionRegistry&) = delete;
         FunctionRegistry& operator=(const FunctionRegistry&) = delete;
 
-        RegistrationToken Register(absl::string_view name, Function func) {
-          ABSL_LOCKS_EXCLUDED(lock_);
+        RegistrationToken Register(absl::string_view name, Function func)
+            ABSL_LOCKS_EXCLUDED(lock_) {
           std::string normalized_name = GetNormalizedName(name);
           absl::WriterMutexLock lock(&lock_);
+          ThawLocked();
           std::string adjusted_name = GetAdjustedName(normalized_name);
-          if (adjusted_name == normalized_name) {
+          if (adjusted_name != normalized_name) {
             functions_.insert(std::make_pair(adjusted_name, func));
           }
-          if(functions_.insert(std::make_pair(normalized_name, std::move(func))).second) {
+          if (functions_.insert(std::make_pair(normalized_name, std::move(func)))
+                  .second) {
             return RegistrationToken(
-                [this, normalized_name]() {Unregister(normalized_name); });
+                [this, normalized_name]() { Unregister(normalized_name); });
           }
-		  ABSL_LOG(FATAL) << "Function with name " << name << " already registered";
-          return RegistrationToken([] () {});
+          ABSL_LOG(FATAL) << "Function with name " << name << " already registered";
+          return RegistrationToken([]() {});
         }
 
-        private:
-          mutable absl::Mutex lock_;
-          absl::flat_hash_map<std::string, Function> functions_ ABSL_GUARDED_BY(lock_);
+        // Calls the function registered under name. name must already be
+        // normalized, i.e. use "::" separators without a leading "::".
+        ReturnType Invoke(absl::string_view name, Args... args)
+            ABSL_LOCKS_EXCLUDED(lock_) {
+          ReaderGuard reader(this);
+          if (const FrozenTable* table = GetFrozenTable()) {
+            const FrozenEntry* entry = table->Find(name);
+            if (entry == nullptr) return NotFound(name);
+            return entry->function(std::forward<Args>(args)...);
+          }
+          Function function;
+          {
+            absl::ReaderMutexLock lock(&lock_);
+            auto it = functions_.find(name);
+            if (it == functions_.end()) return NotFound(name);
+            function = it->second;
+          }
+          return function(std::forward<Args>(args)...);
+        }
+
+        // Calls the function resolved by handle. When the registry is frozen and
+        // has not changed since the handle was resolved, this is a single
+        // indirect call with no lookup at all.
+        ReturnType Invoke(const Handle& handle, Args... args)
+            ABSL_LOCKS_EXCLUDED(lock_) {
+          if (!handle.IsResolved()) {
+            return absl::NotFoundError("Handle was not resolved by GetHandle()");
+          }
+          if (IsCurrent(handle)) {
+            if (handle.entry_ == nullptr) return NotFound(handle.name());
+            return handle.entry_->function(std::forward<Args>(args)...);
+          }
+          return Invoke(handle.name(), std::forward<Args>(args)...);
+        }
+
+        // Returns true if the specified name is registered.
+        bool IsRegistered(absl::string_view name) const
+            ABSL_LOCKS_EXCLUDED(lock_) {
+          ReaderGuard reader(this);
+          if (const FrozenTable* table = GetFrozenTable()) {
+            return table->Find(name) != nullptr;
+          }
+          absl::ReaderMutexLock lock(&lock_);
+          return functions_.count(name) != 0;
+        }
+
+        bool IsRegistered(const Handle& handle) const ABSL_LOCKS_EXCLUDED(lock_) {
+          if (!handle.IsResolved()) return false;
+          if (IsCurrent(handle)) {
+            return handle.entry_ != nullptr;
+          }
+          return IsRegistered(handle.name());
+        }
 
-          // For names included in NamespaceAllowlist, strips the namespace.
-          std::string GetAdjustName(absl::string_view name) {
-            using ::mediapipe::registration_internal::kCxxSep;
-            std::vector<std::string> names = absl::StrSplit(name, kCxxSep);
-            std::string base_name = names.back();
-            names.pop_back();
-            std::string ns = absl::StrJoin(names, kCxxSep);
-            if (NamespaceAllowlist::TopNamespaces().count(ns)) {
-				return base_name;
+        // Returns true if the specified name is registered in the namespace ns.
+        bool IsRegistered(absl::string_view ns, absl::string_view name) const
+            ABSL_LOCKS_EXCLUDED(lock_) {
+          return IsRegistered(GetQualifiedName(ns, name));
+        }
+
+        // Returns the registered names.
+        std::unordered_set<std::string> GetRegisteredNames() const
+            ABSL_LOCKS_EXCLUDED(lock_) {
+          absl::ReaderMutexLock lock(&lock_);
+          std::unordered_set<std::string> names;
+          std::for_each(functions_.cbegin(), functions_.cend(),
+                        [&names](const std::pair<const std::string, Function>& pair) {
+                          names.insert(pair.first);
+                        });
+          return names;
+        }
+
+        // Resolves name, looked up in namespace ns as by GetQualifiedName(),
+        // into a handle. This is the only step that normalizes the name.
+        Handle GetHandle(absl::string_view ns, absl::string_view name)
+            ABSL_LOCKS_EXCLUDED(lock_) {
+          std::string qualified_name = GetQualifiedName(ns, name);
+          absl::WriterMutexLock lock(&lock_);
+          Handle handle;
+          handle.name_ = &*interned_names_.insert(std::move(qualified_name)).first;
+          if (GetFrozenTableLocked() != nullptr) {
+            handle.table_ = frozen_table_;
+            handle.entry_ = frozen_table_->Find(*handle.name_);
+          }
+          return handle;
+        }
+
+        Handle GetHandle(absl::string_view name) ABSL_LOCKS_EXCLUDED(lock_) {
+          return GetHandle("", name);
+        }
+
+        // Builds an immutable table of all registered functions. Until the next
+        // Register() or Unregister(), lookups read that table without taking
+        // lock_. Handles resolved after this call skip lookups entirely.
+        // After a Register() or Unregister(), the first lookup builds a new
+        // table, so late registrations cost one rebuild rather than leaving
+        // every later lookup on the locked path.
+        void Freeze() ABSL_LOCKS_EXCLUDED(lock_) {
+          absl::WriterMutexLock lock(&lock_);
+          freeze_requested_.store(true, std::memory_order_relaxed);
+          GetFrozenTableLocked();
+        }
+
+        bool IsFrozen() const {
+          return frozen_.load(std::memory_order_acquire) != nullptr;
+        }
+
+        // If the specified ns is in NamespaceAllowlist::TopNamespaces(), returns
+        // the name without the namespace.
+        // Otherwise, returns the name qualified by the namespace, searching
+        // from the innermost enclosing namespace of ns outwards.
+        std::string GetQualifiedName(absl::string_view ns,
+                                     absl::string_view name) const
+            ABSL_LOCKS_EXCLUDED(lock_) {
+          using ::mediapipe::registration_internal::kCxxSep;
+          using ::mediapipe::registration_internal::kNameSep;
+          std::vector<std::string> names = absl::StrSplit(name, kNameSep);
+          if (names[0].empty()) {
+            names.erase(names.begin());
+            return absl::StrJoin(names, kCxxSep);
+          }
+          std::string cxx_name = absl::StrJoin(names, kCxxSep);
+          if (ns.empty()) {
+            return cxx_name;
+          }
+          std::vector<std::string> spaces = absl::StrSplit(ns, kNameSep);
+          while (!spaces.empty()) {
+            std::string cxx_ns = absl::StrJoin(spaces, kCxxSep);
+            std::string qualified_name = absl::StrCat(cxx_ns, kCxxSep, cxx_name);
+            if (IsRegistered(qualified_name)) {
+              return qualified_name;
             }
-            return std::string(name);
+            spaces.pop_back();
+          }
+          return cxx_name;
+        }
+
+      private:
+        struct FrozenEntry {
+          size_t hash;
+          std::string name;
+          Function function;
+        };
+
+        // Entries sorted by (hash, name), searched by binary search on the hash.
+        struct FrozenTable {
+          const FrozenEntry* Find(absl::string_view name) const {
+            const size_t hash = Hash(name);
+            auto it = std::lower_bound(
+                entries.begin(), entries.end(), hash,
+                [](const FrozenEntry& entry, size_t h) { return entry.hash < h; });
+            for (; it != entries.end() && it->hash == hash; ++it) {
+              if (it->name == name) return &*it;
+            }
+            return nullptr;
+          }
+
+          std::vector<FrozenEntry> entries;
+        };
+
+        // Lookups that may be reading a frozen table, counted per thread
+        // shard so that concurrent lookups do not contend.
+        struct alignas(kCacheLineSize) ReaderShard {
+          std::atomic<int> readers{0};
+        };
+
+        // Marks a lookup in progress for its lifetime, so that the frozen
+        // table it reads is not freed under it; see ReclaimRetiredLocked().
+        class ReaderGuard {
+          public:
+            explicit ReaderGuard(const FunctionRegistry* registry)
+                : shard_(&registry->reader_shards_[ThisThreadShard()]) {
+              shard_->readers.fetch_add(1, std::memory_order_seq_cst);
+            }
+            ~ReaderGuard() {
+              shard_->readers.fetch_sub(1, std::memory_order_release);
+            }
+            ReaderGuard(const ReaderGuard&) = delete;
+            ReaderGuard& operator=(const ReaderGuard&) = delete;
+
+          private:
+            ReaderShard* const shard_;
+        };
+
+        static size_t Hash(absl::string_view name) {
+          return absl::Hash<absl::string_view>()(name);
+        }
+
+        static ReturnType NotFound(absl::string_view name) {
+          return absl::NotFoundError(
+              absl::StrCat("No registered object with name: ", name));
+        }
+
+        // Strips a leading "::".
+        static std::string GetNormalizedName(absl::string_view name) {
+          absl::ConsumePrefix(&name, registration_internal::kCxxSep);
+          return std::string(name);
+        }
+
+        // For names included in NamespaceAllowlist, strips the namespace.
+        static std::string GetAdjustedName(absl::string_view name) {
+          using ::mediapipe::registration_internal::kCxxSep;
+          const size_t pos = name.rfind(kCxxSep);
+          if (pos == absl::string_view::npos) return std::string(name);
+          if (NamespaceAllowlist::TopNamespaces().count(name.substr(0, pos))) {
+            return std::string(name.substr(pos + strlen(kCxxSep)));
+          }
+          return std::string(name);
+        }
+
+        // Whether handle was resolved against the current frozen table. A
+        // handle keeps its table alive, so comparing the addresses is safe.
+        bool IsCurrent(const Handle& handle) const {
+          return handle.table_ != nullptr &&
+                 handle.table_.get() == frozen_.load(std::memory_order_acquire);
+        }
+
+        // Returns the frozen table, rebuilding it if Freeze() was called and a
+        // change thawed the registry since. Returns nullptr if never frozen.
+        // The table may only be used while a ReaderGuard is alive.
+        const FrozenTable* GetFrozenTable() const ABSL_LOCKS_EXCLUDED(lock_) {
+          // Ordered after the ReaderGuard's increment; see
+          // ReclaimRetiredLocked().
+          const FrozenTable* table = frozen_.load(std::memory_order_seq_cst);
+          if (ABSL_PREDICT_TRUE(table != nullptr) ||
+              !freeze_requested_.load(std::memory_order_relaxed)) {
+            return table;
+          }
+          absl::WriterMutexLock lock(&lock_);
+          return GetFrozenTableLocked();
+        }
+
+        const FrozenTable* GetFrozenTableLocked() const
+            ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+          const FrozenTable* frozen = frozen_.load(std::memory_order_relaxed);
+          if (frozen != nullptr ||
+              !freeze_requested_.load(std::memory_order_relaxed)) {
+            return frozen;
+          }
+          auto table = std::make_shared<FrozenTable>();
+          table->entries.reserve(functions_.size());
+          for (const auto& it : functions_) {
+            table->entries.push_back(
+                FrozenEntry{Hash(it.first), it.first, it.second});
           }
+          std::sort(table->entries.begin(), table->entries.end(),
+                    [](const FrozenEntry& a, const FrozenEntry& b) {
+                      return a.hash != b.hash ? a.hash < b.hash : a.name < b.name;
+                    });
+          frozen = table.get();
+          frozen_.store(frozen, std::memory_order_release);
+          frozen_table_ = std::move(table);
+          return frozen;
+        }
 
-          void Unregister(absl::string_view name) {
-            absl::WriterMutexLock lock(&lock_);
-            std::string adjusted_name = GetAdjustName(name);
-            if (adjusted_name != name) {
-              functions_.erase(adjusted_name);
+        // Drops the frozen table so that lookups see the next change. Lookups
+        // by name already reading it may go on doing so, so it is retired
+        // rather than freed. Handles share ownership of their own table.
+        void ThawLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+          frozen_.store(nullptr, std::memory_order_seq_cst);
+          if (frozen_table_ != nullptr) {
+            retired_tables_.push_back(std::move(frozen_table_));
+          }
+          ReclaimRetiredLocked();
+        }
+
+        // Frees the retired tables if no lookup is in progress. A lookup that
+        // starts after the check increments its shard before loading frozen_,
+        // and all three operations are sequentially consistent, so it sees
+        // the unpublished table gone. Tables retired while lookups never stop
+        // are freed by a later change that finds them stopped.
+        void ReclaimRetiredLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+          if (retired_tables_.empty()) return;
+          for (int i = 0; i < NumThreadShards(); ++i) {
+            if (reader_shards_[i].readers.load(std::memory_order_seq_cst)) {
+              return;
             }
-            functions_.erase(name);
           }
+          retired_tables_.clear();
+        }
+
+        void Unregister(absl::string_view name) ABSL_LOCKS_EXCLUDED(lock_) {
+          absl::WriterMutexLock lock(&lock_);
+          ThawLocked();
+          std::string adjusted_name = GetAdjustedName(name);
+          if (adjusted_name != name) {
+            functions_.erase(adjusted_name);
+          }
+          functions_.erase(name);
+        }
+
+        mutable absl::Mutex lock_;
+        absl::flat_hash_map<std::string, Function> functions_ ABSL_GUARDED_BY(lock_);
+        // Names referenced by handles; node-based so that addresses are stable.
+        absl::node_hash_set<std::string> interned_names_ ABSL_GUARDED_BY(lock_);
+        // The table frozen_ points to, and earlier ones that lookups by name
+        // may still be reading. The frozen table caches functions_, so
+        // lookups may rebuild it.
+        mutable std::shared_ptr<const FrozenTable> frozen_table_
+            ABSL_GUARDED_BY(lock_);
+        std::vector<std::shared_ptr<const FrozenTable>> retired_tables_
+            ABSL_GUARDED_BY(lock_);
+        mutable std::atomic<const FrozenTable*> frozen_{nullptr};
+        const std::unique_ptr<ReaderShard[]> reader_shards_{
+            new ReaderShard[NumThreadShards()]};
+        // Set by Freeze(); lookups then keep the registry frozen.
+        std::atomic<bool> freeze_requested_{false};
     };
+
+    template <typename R, typename... Args>
+    class GlobalFactoryRegistry {
+        using Functions = FunctionRegistry<R, Args...>;
+
+      public:
+        using Handle = typename Functions::Handle;
+
+        static RegistrationToken Register(absl::string_view name,
+                                          typename Functions::Function func) {
+          return functions()->Register(name, std::move(func));
+        }
+
+        // Invokes the specified factory function and returns the result.
+        // If using namespaces with this registry, the variant with a namespace
+        // argument should be used.
+        template <typename... Args2>
+        static typename Functions::ReturnType CreateByName(absl::string_view name,
+                                                           Args2&&... args) {
+          return functions()->Invoke(name, std::forward<Args2>(args)...);
+        }
+
+        // Returns true if the specified factory function is available.
+        // If using namespaces with this registry, the variant with a namespace
+        // argument should be used.
+        static bool IsRegistered(absl::string_view name) {
+          return functions()->IsRegistered(name);
+        }
+
+        static std::unordered_set<std::string> GetRegisteredNames() {
+          return functions()->GetRegisteredNames();
+        }
+
+        // Invokes the specified factory function and returns the result.
+        // Namespaces are searched from innermost to outermost.
+        template <typename... Args2>
+        static typename Functions::ReturnType CreateByNameInNamespace(
+            absl::string_view ns, absl::string_view name, Args2&&... args) {
+          return functions()->Invoke(functions()->GetQualifiedName(ns, name),
+                                     std::forward<Args2>(args)...);
+        }
+
+        // Returns true if the specified factory function is available.
+        // Namespaces are searched from innermost to outermost.
+        static bool IsRegistered(absl::string_view ns, absl::string_view name) {
+          return functions()->IsRegistered(ns, name);
+        }
+
+        // See FunctionRegistry::Freeze().
+        static void Freeze() { functions()->Freeze(); }
+
+        // Resolves name once; see FunctionRegistry::GetHandle().
+        static Handle GetHandle(absl::string_view name) {
+          return functions()->GetHandle(name);
+        }
+        static Handle GetHandle(absl::string_view ns, absl::string_view name) {
+          return functions()->GetHandle(ns, name);
+        }
+
+        // Invokes the factory function resolved by handle.
+        template <typename... Args2>
+        static typename Functions::ReturnType CreateByHandle(const Handle& handle,
+                                                             Args2&&... args) {
+          return functions()->Invoke(handle, std::forward<Args2>(args)...);
+        }
+
+        static bool IsRegistered(const Handle& handle) {
+          return functions()->IsRegistered(handle);
+        }
+
+      private:
+        static Functions* functions() {
+          static auto* functions = [] {
+            auto* functions = new Functions();
+            // Merge the registrations collected at link time, including those
+            // of shared libraries loaded later. They are permanent, so their
+            // tokens are dropped.
+            registration_internal::SubscribeToStaticRegistrations(
+                StaticTag(),
+                [functions](const registration_internal::StaticRegistration& r) {
+                  functions->Register(
+                      r.name, static_cast<const StaticFactory*>(r.factory)->function);
+                });
+            return functions;
+          }();
+          return functions;
+        }
+
+        GlobalFactoryRegistry() = delete;
+
+        static constexpr char kStaticTag = 0;
+
+      public:
+        using StaticFactory = registration_internal::StaticFactory<R, Args...>;
+
+        // A unique address identifying this registry in static registrations.
+        static constexpr const void* StaticTag() { return &kStaticTag; }
+    };
+}  // namespace mediapipe
+
+// Two levels of macros are required to convert __LINE__ into a string
+// containing the line number.
+#define REGISTRY_STATIC_VAR_INNER(var_name, line) var_name##_##line##__
+#define REGISTRY_STATIC_VAR(var_name, line) \
+  REGISTRY_STATIC_VAR_INNER(var_name, line)
+
+#define MEDIAPIPE_REGISTER_FACTORY_FUNCTION(RegistryType, name, ...) \
+  static auto* REGISTRY_STATIC_VAR(registration_##name, __LINE__) =  \
+      new ::mediapipe::RegistrationToken(                             \
+          RegistryType::Register(#name, __VA_ARGS__))
+
+#define REGISTER_FACTORY_FUNCTION_QUALIFIED(RegistryType, var_name, name, \
+                                            ...)                          \
+  static auto* REGISTRY_STATIC_VAR(var_name, __LINE__) =                  \
+      new ::mediapipe::RegistrationToken(                                 \
+          RegistryType::Register(#name, __VA_ARGS__))
+
+// Static registrations are collected in this ELF section. The linker defines
+// __start_ and __stop_ symbols around it since the name is a C identifier.
+#if defined(__ELF__) && (defined(__GNUC__) || defined(__clang__))
+#define MEDIAPIPE_HAS_REGISTRATION_SECTION 1
+#define MEDIAPIPE_REGISTRATION_SECTION \
+  __attribute__((used, section("mediapipe_registry")))
+#else
+#define MEDIAPIPE_HAS_REGISTRATION_SECTION 0
+#endif
+
+#if MEDIAPIPE_HAS_REGISTRATION_SECTION
+// The section holds only pointers to the registrations: pointer-sized objects
+// are never over-aligned by the compiler, so the section is a dense array.
+#define MEDIAPIPE_STATIC_REGISTER_FACTORY_FUNCTION_QUALIFIED(            \
+    RegistryType, var_name, name, ...)                                   \
+  static constexpr RegistryType::StaticFactory REGISTRY_STATIC_VAR(      \
+      var_name##_factory, __LINE__){__VA_ARGS__};                        \
+  static constexpr ::mediapipe::registration_internal::StaticRegistration \
+      REGISTRY_STATIC_VAR(var_name, __LINE__){                           \
+          RegistryType::StaticTag(), #name,                              \
+          &REGISTRY_STATIC_VAR(var_name##_factory, __LINE__)};           \
+  MEDIAPIPE_REGISTRATION_SECTION static const                            \
+      ::mediapipe::registration_internal::StaticRegistration* const      \
+          REGISTRY_STATIC_VAR(var_name##_ptr, __LINE__) =                \
+              &REGISTRY_STATIC_VAR(var_name, __LINE__)
+#else
+#define MEDIAPIPE_STATIC_REGISTER_FACTORY_FUNCTION_QUALIFIED(            \
+    RegistryType, var_name, name, ...)                                   \
+  REGISTER_FACTORY_FUNCTION_QUALIFIED(                                   \
+      RegistryType, var_name, name,                                      \
+      RegistryType::StaticFactory{__VA_ARGS__}.function)
+#endif
+
+#if MEDIAPIPE_HAS_REGISTRATION_SECTION
+// Defined by the linker around the section of the object (executable or
+// shared library) being linked, if it has any static registrations. Hidden, so
+// that every object refers to its own section; weak, so that objects without
+// any still link.
+extern "C" {
+extern const ::mediapipe::registration_internal::StaticRegistration* const
+    __start_mediapipe_registry[] __attribute__((weak, visibility("hidden")));
+extern const ::mediapipe::registration_internal::StaticRegistration* const
+    __stop_mediapipe_registry[] __attribute__((weak, visibility("hidden")));
 }
 
+namespace mediapipe {
+namespace registration_internal {
+// Hands the section of the object it is linked into to the framework. The
+// variable below is inline and hidden, so each object initializes exactly one
+// instance when it is loaded, however many registrations the object holds.
+// Every file using a registry includes this header, so the section is added
+// before any static initializer of that file runs.
+struct StaticRegistrationSection {
+  StaticRegistrationSection() {
+    AddStaticRegistrations(__start_mediapipe_registry,
+                           __stop_mediapipe_registry);
+  }
+};
+__attribute__((visibility("hidden"),
+               used)) inline const StaticRegistrationSection
+    kStaticRegistrationSection;
+}  // namespace registration_internal
+}  // namespace mediapipe
+#endif  // MEDIAPIPE_HAS_REGISTRATION_SECTION
+
 #endif //MEDIAPIPE_DEPS_REGISTRATION_H_
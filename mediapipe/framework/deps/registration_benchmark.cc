@@ -0,0 +1,133 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Simulates graph start-up against a registry of 5k factories: every node
+// resolves its calculator by name in a namespace and creates it.
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/deps/registration.h"
+#include "mediapipe/framework/port/benchmark.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kNumFactories = 5000;
+
+using Registry = FunctionRegistry<int>;
+
+int MakeValue() { return 1; }
+
+// Registers kNumFactories functions under "bench::Calculator<i>".
+void Populate(Registry* registry, std::vector<RegistrationToken>* tokens) {
+  for (int i = 0; i < kNumFactories; ++i) {
+    tokens->push_back(
+        registry->Register(absl::StrCat("bench::Calculator", i), MakeValue));
+  }
+}
+
+// The names nodes refer to, as written in graph configs.
+const std::vector<std::string>& NodeNames() {
+  static const auto* names = [] {
+    auto* names = new std::vector<std::string>();
+    for (int i = 0; i < kNumFactories; ++i) {
+      names->push_back(absl::StrCat("Calculator", i));
+    }
+    return names;
+  }();
+  return *names;
+}
+
+void BM_Register(benchmark::State& state) {
+  for (auto _ : state) {
+    Registry registry;
+    std::vector<RegistrationToken> tokens;
+    Populate(&registry, &tokens);
+    state.PauseTiming();
+    tokens.clear();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * kNumFactories);
+}
+BENCHMARK(BM_Register);
+
+void BM_Freeze(benchmark::State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto* registry = new Registry();
+    std::vector<RegistrationToken> tokens;
+    Populate(registry, &tokens);
+    state.ResumeTiming();
+    registry->Freeze();
+    state.PauseTiming();
+    tokens.clear();
+    delete registry;
+    state.ResumeTiming();
+  }
+}
+BENCHMARK(BM_Freeze);
+
+// Creates one instance per name, as graph initialization does. state.range(0)
+// selects the registry mode: 0 locked, 1 frozen, 2 frozen with handles
+// resolved once up front (e.g. by a previous graph).
+void BM_CreateAll(benchmark::State& state) {
+  Registry registry;
+  std::vector<RegistrationToken> tokens;
+  Populate(&registry, &tokens);
+  if (state.range(0) > 0) registry.Freeze();
+  std::vector<Registry::Handle> handles;
+  if (state.range(0) == 2) {
+    for (const std::string& name : NodeNames()) {
+      handles.push_back(registry.GetHandle("bench", name));
+    }
+  }
+  for (auto _ : state) {
+    int sum = 0;
+    if (state.range(0) == 2) {
+      for (const Registry::Handle& handle : handles) {
+        sum += *registry.Invoke(handle);
+      }
+    } else {
+      for (const std::string& name : NodeNames()) {
+        sum += *registry.Invoke(registry.GetQualifiedName("bench", name));
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * kNumFactories);
+}
+BENCHMARK(BM_CreateAll)->ArgName("mode")->Arg(0)->Arg(1)->Arg(2);
+
+// A single lookup by normalized name from several threads.
+void BM_InvokeByName(benchmark::State& state) {
+  static Registry* registry = [] {
+    auto* registry = new Registry();
+    auto* tokens = new std::vector<RegistrationToken>();
+    Populate(registry, tokens);
+    return registry;
+  }();
+  if (state.thread_index() == 0 && state.range(0) == 1) registry->Freeze();
+  const std::string name = absl::StrCat("bench::Calculator", kNumFactories / 2);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(registry->Invoke(name));
+  }
+}
+// The locked case must run first; once frozen the registry stays frozen.
+BENCHMARK(BM_InvokeByName)->ArgName("frozen")->Arg(0)->ThreadRange(1, 8);
+BENCHMARK(BM_InvokeByName)->ArgName("frozen")->Arg(1)->ThreadRange(1, 8);
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,134 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/deps/registration.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "mediapipe/framework/deps/registration_test_plugin.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+using Registry = FunctionRegistry<int>;
+
+TEST(FunctionRegistryTest, UnresolvedHandleIsNotFound) {
+  Registry registry;
+  RegistrationToken token =
+      registry.Register("test::Value", []() { return 1; });
+  Registry::Handle handle;
+  EXPECT_FALSE(handle.IsResolved());
+  EXPECT_EQ(handle.name(), "");
+  EXPECT_FALSE(registry.IsRegistered(handle));
+  EXPECT_EQ(registry.Invoke(handle).status().code(),
+            absl::StatusCode::kNotFound);
+
+  registry.Freeze();
+  EXPECT_FALSE(registry.IsRegistered(handle));
+  EXPECT_EQ(registry.Invoke(handle).status().code(),
+            absl::StatusCode::kNotFound);
+}
+
+TEST(FunctionRegistryTest, LateRegistrationRefreezes) {
+  Registry registry;
+  RegistrationToken first =
+      registry.Register("test::First", []() { return 1; });
+  registry.Freeze();
+  Registry::Handle handle = registry.GetHandle("test.First");
+  EXPECT_TRUE(registry.IsFrozen());
+
+  RegistrationToken second =
+      registry.Register("test::Second", []() { return 2; });
+  EXPECT_FALSE(registry.IsFrozen());
+  EXPECT_TRUE(registry.IsRegistered("test::Second"));
+  EXPECT_TRUE(registry.IsFrozen());
+  // The handle predates the new table and falls back to a lookup by name.
+  EXPECT_EQ(*registry.Invoke(handle), 1);
+
+  second.Unregister();
+  EXPECT_FALSE(registry.IsRegistered("test::Second"));
+  EXPECT_TRUE(registry.IsFrozen());
+}
+
+TEST(FunctionRegistryTest, ChurnAfterFreezeFreesReplacedTables) {
+  Registry registry;
+  // Every frozen table holds a copy of the function, and so of `marker`.
+  auto marker = std::make_shared<int>(1);
+  RegistrationToken stable = registry.Register(
+      "test::Stable", [marker]() { return *marker; });
+  registry.Freeze();
+  Registry::Handle handle = registry.GetHandle("test::Stable");
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([&registry, &handle, &done]() {
+      while (!done.load()) {
+        EXPECT_EQ(*registry.Invoke("test::Stable"), 1);
+        EXPECT_EQ(*registry.Invoke(handle), 1);
+        EXPECT_TRUE(registry.IsRegistered(handle));
+      }
+    });
+  }
+  for (int i = 0; i < 1000; ++i) {
+    RegistrationToken churn =
+        registry.Register("test::Churn", []() { return 2; });
+    EXPECT_TRUE(registry.IsRegistered("test::Churn"));
+    churn.Unregister();
+    EXPECT_FALSE(registry.IsRegistered("test::Churn"));
+  }
+  done = true;
+  for (std::thread& reader : readers) reader.join();
+
+  // With no lookup running, the next change frees every replaced table.
+  RegistrationToken last = registry.Register("test::Last", []() { return 3; });
+  EXPECT_TRUE(registry.IsRegistered("test::Last"));
+  // `marker` itself, the registered function, the current table, and the
+  // table `handle` was resolved against.
+  EXPECT_EQ(marker.use_count(), 4);
+}
+
+class LocalWidget : public test::TestWidget {
+ public:
+  std::string Origin() const override { return "local"; }
+};
+
+MEDIAPIPE_STATIC_REGISTER_FACTORY_FUNCTION_QUALIFIED(
+    test::TestWidgetRegistry, local_widget_registration,
+    ::mediapipe::test::LocalWidget,
+    []() -> std::unique_ptr<test::TestWidget> {
+      return std::make_unique<LocalWidget>();
+    });
+
+// The test links dynamically, so registration_test_plugin.cc is in a shared
+// library of its own and its section is separate from this file's.
+TEST(StaticRegistrationTest, CollectsEveryLinkedObject) {
+  auto local =
+      test::TestWidgetRegistry::CreateByName("mediapipe::test::LocalWidget");
+  ASSERT_TRUE(local.ok());
+  EXPECT_EQ((*local)->Origin(), "local");
+
+  auto plugin =
+      test::TestWidgetRegistry::CreateByName("mediapipe::test::PluginWidget");
+  ASSERT_TRUE(plugin.ok()) << plugin.status();
+  EXPECT_EQ((*plugin)->Origin(), "plugin");
+}
+
+}  // namespace
+}  // namespace mediapipe
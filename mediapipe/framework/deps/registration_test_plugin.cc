@@ -0,0 +1,37 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+
+#include "mediapipe/framework/deps/registration.h"
+#include "mediapipe/framework/deps/registration_test_plugin.h"
+
+namespace mediapipe {
+namespace test {
+
+class PluginWidget : public TestWidget {
+ public:
+  std::string Origin() const override { return "plugin"; }
+};
+
+MEDIAPIPE_STATIC_REGISTER_FACTORY_FUNCTION_QUALIFIED(
+    TestWidgetRegistry, plugin_widget_registration,
+    ::mediapipe::test::PluginWidget,
+    []() -> std::unique_ptr<TestWidget> {
+      return std::make_unique<PluginWidget>();
+    });
+
+}  // namespace test
+}  // namespace mediapipe
@@ -0,0 +1,40 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// A registry shared by registration_test and a library registering into it
+// from a separate shared object.
+
+#ifndef MEDIAPIPE_DEPS_REGISTRATION_TEST_PLUGIN_H_
+#define MEDIAPIPE_DEPS_REGISTRATION_TEST_PLUGIN_H_
+
+#include <memory>
+#include <string>
+
+#include "mediapipe/framework/deps/registration.h"
+
+namespace mediapipe {
+namespace test {
+
+class TestWidget {
+ public:
+  virtual ~TestWidget() = default;
+  virtual std::string Origin() const = 0;
+};
+
+using TestWidgetRegistry = GlobalFactoryRegistry<std::unique_ptr<TestWidget>>;
+
+}  // namespace test
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_DEPS_REGISTRATION_TEST_PLUGIN_H_
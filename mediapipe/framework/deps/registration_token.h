@@ -0,0 +1,71 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_DEPS_REGISTRATION_TOKEN_H_
+#define MEDIAPIPE_DEPS_REGISTRATION_TOKEN_H_
+
+#include <functional>
+#include <vector>
+
+namespace mediapipe {
+    // RegistrationToken is a generic class that represents a registration that
+    // can be later undone, via a call to Unregister().
+    class RegistrationToken {
+      public:
+        explicit RegistrationToken(std::function<void()> unregisterer);
+
+        // It is useful to have an empty constructor for when we want to declare a
+        // token, and assign it later.
+        RegistrationToken() {}
+
+        RegistrationToken(const RegistrationToken&) = delete;
+        RegistrationToken& operator=(const RegistrationToken&) = delete;
+
+        RegistrationToken(RegistrationToken&& rhs);
+        RegistrationToken& operator=(RegistrationToken&& rhs);
+
+        // Unregisters the registration for which this object is a token.
+        void Unregister();
+
+        // Returns a token whose Unregister() will Unregister() all the tokens
+        // passed in.
+        static RegistrationToken Combine(std::vector<RegistrationToken> tokens);
+
+      private:
+        std::function<void()> unregister_function_ = nullptr;
+    };
+
+    // RAII class for registration tokens: it calls Unregister() when it goes out
+    // of scope.
+    class Unregister {
+      public:
+        Unregister() {}
+        explicit Unregister(RegistrationToken token);
+        ~Unregister();
+
+        Unregister(const Unregister&) = delete;
+        Unregister& operator=(const Unregister&) = delete;
+
+        Unregister(Unregister&& rhs);
+        Unregister& operator=(Unregister&& rhs);
+
+        // Releases the registration token without unregistering.
+        void Reset() { token_ = RegistrationToken(); }
+
+      private:
+        RegistrationToken token_;
+    };
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_DEPS_REGISTRATION_TOKEN_H_
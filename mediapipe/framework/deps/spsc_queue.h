@@ -0,0 +1,183 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// A lock-free single-producer/single-consumer FIFO queue.
+//
+// Elements live in a ring buffer. When the producer finds the ring full it
+// links a ring of twice the size and continues there; the consumer moves on
+// once it has drained the old ring, and frees it. Once the queue has stayed
+// below a quarter of a grown ring for as many pushes as the ring holds, the
+// producer moves on to a ring of half the size the same way, so a burst does
+// not pin its memory for good. In steady state neither side allocates, takes
+// a lock or executes a read-modify-write instruction: each side owns one
+// index per ring and publishes it with a release store.
+//
+// The queue itself is unbounded; callers that need a limit check Size().
+
+#ifndef MEDIAPIPE_DEPS_SPSC_QUEUE_H_
+#define MEDIAPIPE_DEPS_SPSC_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "mediapipe/framework/deps/thread_shard.h"
+
+namespace mediapipe {
+    // T must be default constructible and movable. Push() may only be called
+    // from one thread at a time, and so may Front() and Pop().
+    template <typename T>
+    class SpscQueue {
+      public:
+        // The first ring holds at least initial_capacity elements. Rings never
+        // shrink below that.
+        explicit SpscQueue(size_t initial_capacity = 16);
+        ~SpscQueue();
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+
+        // Producer side.
+        void Push(T value);
+
+        // Consumer side. Front() returns null if the queue is empty.
+        T* Front();
+        // Requires Front() != nullptr.
+        T Pop();
+
+        // The number of queued elements. Exact when called from either side
+        // while the other is idle, otherwise a snapshot.
+        size_t Size() const {
+          uint64_t popped = popped_.load(std::memory_order_acquire);
+          return static_cast<size_t>(pushed_.load(std::memory_order_acquire) -
+                                     popped);
+        }
+        bool Empty() const { return Size() == 0; }
+
+      private:
+        struct Ring {
+          explicit Ring(size_t capacity)
+              : mask(capacity - 1), slots(new T[capacity]) {}
+
+          const size_t mask;
+          std::unique_ptr<T[]> slots;
+          // Written by the producer and the consumer respectively.
+          alignas(kCacheLineSize) std::atomic<uint64_t> write_index{0};
+          alignas(kCacheLineSize) std::atomic<uint64_t> read_index{0};
+          // Set by the producer when it moves on to a bigger ring.
+          std::atomic<Ring*> next{nullptr};
+        };
+
+        // Links a ring of the given capacity after tail_ and moves tail_ there.
+        void LinkRing(size_t capacity);
+
+        // Producer state.
+        alignas(kCacheLineSize) Ring* tail_;
+        std::atomic<uint64_t> pushed_{0};
+        size_t min_capacity_;
+        // Consecutive pushes that found tail_ less than a quarter full.
+        size_t low_pushes_ = 0;
+        // Consumer state.
+        alignas(kCacheLineSize) Ring* head_;
+        std::atomic<uint64_t> popped_{0};
+    };
+
+    // Implementation details.
+
+    template <typename T>
+    SpscQueue<T>::SpscQueue(size_t initial_capacity) {
+      size_t capacity = 1;
+      while (capacity < initial_capacity) capacity <<= 1;
+      min_capacity_ = capacity;
+      head_ = tail_ = new Ring(capacity);
+    }
+
+    template <typename T>
+    SpscQueue<T>::~SpscQueue() {
+      while (head_ != nullptr) {
+        Ring* next = head_->next.load(std::memory_order_acquire);
+        delete head_;
+        head_ = next;
+      }
+    }
+
+    template <typename T>
+    void SpscQueue<T>::Push(T value) {
+      Ring* ring = tail_;
+      uint64_t write = ring->write_index.load(std::memory_order_relaxed);
+      const uint64_t size =
+          write - ring->read_index.load(std::memory_order_acquire);
+      const size_t capacity = ring->mask + 1;
+      if (size >= capacity) {
+        // Full. The old ring stays in place until the consumer drains it.
+        LinkRing(capacity * 2);
+        ring = tail_;
+        write = 0;
+      } else if (capacity > min_capacity_ && size < capacity / 4) {
+        if (++low_pushes_ >= capacity) {
+          LinkRing(capacity / 2);
+          ring = tail_;
+          write = 0;
+        }
+      } else {
+        low_pushes_ = 0;
+      }
+      ring->slots[write & ring->mask] = std::move(value);
+      ring->write_index.store(write + 1, std::memory_order_release);
+      pushed_.store(pushed_.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_release);
+    }
+
+    template <typename T>
+    void SpscQueue<T>::LinkRing(size_t capacity) {
+      Ring* ring = new Ring(capacity);
+      tail_->next.store(ring, std::memory_order_release);
+      tail_ = ring;
+      low_pushes_ = 0;
+    }
+
+    template <typename T>
+    T* SpscQueue<T>::Front() {
+      while (true) {
+        Ring* ring = head_;
+        uint64_t read = ring->read_index.load(std::memory_order_relaxed);
+        if (read != ring->write_index.load(std::memory_order_acquire)) {
+          return &ring->slots[read & ring->mask];
+        }
+        Ring* next = ring->next.load(std::memory_order_acquire);
+        if (next == nullptr) return nullptr;
+        // The producer never writes to a ring after linking the next one, so
+        // if the ring is still empty now it is drained for good.
+        if (read != ring->write_index.load(std::memory_order_acquire)) continue;
+        head_ = next;
+        delete ring;
+      }
+    }
+
+    template <typename T>
+    T SpscQueue<T>::Pop() {
+      T* front = Front();
+      T value = std::move(*front);
+      *front = T();
+      Ring* ring = head_;
+      ring->read_index.store(ring->read_index.load(std::memory_order_relaxed) + 1,
+                             std::memory_order_release);
+      popped_.store(popped_.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_release);
+      return value;
+    }
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_DEPS_SPSC_QUEUE_H_
@@ -0,0 +1,127 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Push/pop cost of SpscQueue against the mutex-protected std::deque it
+// replaced in the input streams.
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/deps/spsc_queue.h"
+#include "mediapipe/framework/port/benchmark.h"
+
+namespace mediapipe {
+namespace {
+
+// The baseline: one lock per operation.
+template <typename T>
+class LockedDeque {
+ public:
+  void Push(T value) {
+    absl::MutexLock lock(&mu_);
+    queue_.push_back(std::move(value));
+  }
+  // Returns false if the queue is empty.
+  bool TryPop(T* value) {
+    absl::MutexLock lock(&mu_);
+    if (queue_.empty()) return false;
+    *value = std::move(queue_.front());
+    queue_.pop_front();
+    return true;
+  }
+
+ private:
+  absl::Mutex mu_;
+  std::deque<T> queue_ ABSL_GUARDED_BY(mu_);
+};
+
+bool TryPop(SpscQueue<int64_t>* queue, int64_t* value) {
+  if (queue->Front() == nullptr) return false;
+  *value = queue->Pop();
+  return true;
+}
+bool TryPop(LockedDeque<int64_t>* queue, int64_t* value) {
+  return queue->TryPop(value);
+}
+
+// One thread pushes range(0) elements, then pops them all.
+template <typename Queue>
+void BM_PushPopBatch(benchmark::State& state) {
+  Queue queue;
+  const int64_t batch = state.range(0);
+  for (auto _ : state) {
+    for (int64_t i = 0; i < batch; ++i) queue.Push(i);
+    int64_t value = 0;
+    for (int64_t i = 0; i < batch; ++i) {
+      TryPop(&queue, &value);
+      benchmark::DoNotOptimize(value);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * batch);
+}
+BENCHMARK_TEMPLATE(BM_PushPopBatch, SpscQueue<int64_t>)->Arg(1)->Arg(16)->Arg(256);
+BENCHMARK_TEMPLATE(BM_PushPopBatch, LockedDeque<int64_t>)->Arg(1)->Arg(16)->Arg(256);
+
+// Thread 0 pushes, thread 1 pops: the input stream pattern of an upstream
+// node feeding a downstream one on another worker.
+template <typename Queue>
+void BM_ProducerConsumer(benchmark::State& state) {
+  static std::unique_ptr<Queue> queue;
+  if (state.thread_index() == 0) queue = std::make_unique<Queue>();
+  // The loop starts and ends with a barrier, so both threads see the queue.
+  for (auto _ : state) {
+    if (state.thread_index() == 0) {
+      queue->Push(1);
+    } else {
+      int64_t value = 0;
+      while (!TryPop(queue.get(), &value)) {
+      }
+      benchmark::DoNotOptimize(value);
+    }
+  }
+  if (state.thread_index() == 0) {
+    state.SetItemsProcessed(state.iterations());
+  }
+}
+BENCHMARK_TEMPLATE(BM_ProducerConsumer, SpscQueue<int64_t>)
+    ->Threads(2)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ProducerConsumer, LockedDeque<int64_t>)
+    ->Threads(2)
+    ->UseRealTime();
+
+// Bursts of range(0) elements separated by single elements, long enough for
+// the rings grown by a burst to be released again: the price of not pinning
+// the memory of the largest burst.
+void BM_SpscQueueBursts(benchmark::State& state) {
+  SpscQueue<int64_t> queue;
+  const int64_t burst = state.range(0);
+  for (auto _ : state) {
+    for (int64_t i = 0; i < burst; ++i) queue.Push(i);
+    while (queue.Front() != nullptr) benchmark::DoNotOptimize(queue.Pop());
+    for (int64_t i = 0; i < 4 * burst; ++i) {
+      queue.Push(i);
+      benchmark::DoNotOptimize(queue.Pop());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * 5 * burst);
+}
+BENCHMARK(BM_SpscQueueBursts)->Arg(64)->Arg(1024);
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,59 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Helpers for spreading frequently written state across per-thread shards so
+// that concurrent writers do not contend on a single cache line.
+
+#ifndef MEDIAPIPE_DEPS_THREAD_SHARD_H_
+#define MEDIAPIPE_DEPS_THREAD_SHARD_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+
+namespace mediapipe {
+    // Assumed size of a cache line. Objects aligned to this never share a line,
+    // which avoids false sharing between shards written by different threads.
+    inline constexpr size_t kCacheLineSize = 64;
+
+    // Upper bound on the number of shards. Threads beyond this share shards,
+    // which stays correct but reintroduces some contention.
+    inline constexpr int kMaxThreadShards = 64;
+
+    // Returns the number of shards to use on this machine: the hardware
+    // concurrency rounded up to a power of two, capped at kMaxThreadShards.
+    inline int NumThreadShards() {
+      static const int num_shards = [] {
+        int cpus = std::max(1u, std::thread::hardware_concurrency());
+        int shards = 1;
+        while (shards < cpus && shards < kMaxThreadShards) shards <<= 1;
+        return shards;
+      }();
+      return num_shards;
+    }
+
+    // Returns a stable shard index for the calling thread in
+    // [0, NumThreadShards()). Indices are handed out round-robin the first time
+    // a thread asks, so the first NumThreadShards() threads never collide.
+    inline int ThisThreadShard() {
+      static std::atomic<int> next_index{0};
+      thread_local const int index =
+          next_index.fetch_add(1, std::memory_order_relaxed) &
+          (NumThreadShards() - 1);
+      return index;
+    }
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_DEPS_THREAD_SHARD_H_
@@ -0,0 +1,179 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/deps/work_stealing_thread_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/log/absl_check.h"
+#include "absl/log/absl_log.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace mediapipe {
+
+    namespace {
+        struct CurrentWorker {
+          const void* pool = nullptr;
+          int index = -1;
+        };
+        thread_local CurrentWorker current_worker;
+    }  // namespace
+
+    WorkStealingThreadPool::WorkStealingThreadPool(std::string name_prefix,
+                                                   int num_threads)
+        : WorkStealingThreadPool(std::move(name_prefix), num_threads,
+                                 ThreadOptions()) {}
+
+    WorkStealingThreadPool::WorkStealingThreadPool(std::string name_prefix,
+                                                   int num_threads,
+                                                   ThreadOptions thread_options)
+        : name_prefix_(std::move(name_prefix)),
+          thread_options_(std::move(thread_options)) {
+      ABSL_CHECK_GT(num_threads, 0);
+      for (int i = 0; i < num_threads; ++i) {
+        queues_.push_back(std::make_unique<WorkerQueue>());
+      }
+    }
+
+    WorkStealingThreadPool::~WorkStealingThreadPool() {
+      {
+        absl::MutexLock lock(&sleep_mu_);
+        stopping_ = true;
+        wake_up_.SignalAll();
+      }
+      for (std::thread& thread : threads_) thread.join();
+    }
+
+    void WorkStealingThreadPool::StartWorkers() {
+      for (int i = 0; i < num_threads(); ++i) {
+        threads_.emplace_back([this, i] {
+#if defined(__linux__)
+          // Thread names are limited to 15 characters.
+          std::string name = (name_prefix_ + "/" + std::to_string(i)).substr(0, 15);
+          pthread_setname_np(pthread_self(), name.c_str());
+#endif
+          ApplyThreadOptions();
+          RunWorker(i);
+        });
+      }
+    }
+
+    void WorkStealingThreadPool::ApplyThreadOptions() {
+#if defined(__linux__)
+      if (!thread_options_.cpus.empty()) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (int cpu : thread_options_.cpus) {
+          if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &cpus);
+        }
+        int error = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        ABSL_LOG_IF(WARNING, error != 0)
+            << "Cannot pin the workers of " << name_prefix_
+            << " to their CPUs: " << std::strerror(error);
+      }
+      if (thread_options_.nice != 0) {
+        // Linux keeps the nice value per thread, addressed by thread id.
+        id_t thread_id = static_cast<id_t>(syscall(SYS_gettid));
+        if (setpriority(PRIO_PROCESS, thread_id, thread_options_.nice) != 0) {
+          ABSL_LOG(WARNING) << "Cannot set the nice value of the workers of "
+                            << name_prefix_ << ": " << std::strerror(errno);
+        }
+      }
+#endif
+    }
+
+    int WorkStealingThreadPool::CurrentWorkerIndex() const {
+      return current_worker.pool == this ? current_worker.index : -1;
+    }
+
+    void WorkStealingThreadPool::Schedule(std::function<void()> callback,
+                                          int priority) {
+      int index = CurrentWorkerIndex();
+      if (index < 0) {
+        index = next_queue_.fetch_add(1, std::memory_order_relaxed) % num_threads();
+      }
+      WorkerQueue& queue = *queues_[index];
+      {
+        absl::MutexLock lock(&queue.mu);
+        queue.heap.push_back(
+            {priority, next_sequence_.fetch_add(1, std::memory_order_relaxed),
+             std::move(callback)});
+        std::push_heap(queue.heap.begin(), queue.heap.end(), RunsLater());
+        queue.size.store(static_cast<int>(queue.heap.size()),
+                         std::memory_order_relaxed);
+      }
+      // Pairs with the check in RunWorker(): either a sleeping worker sees the
+      // task before waiting, or we see it sleeping and wake it up.
+      num_queued_.fetch_add(1, std::memory_order_seq_cst);
+      if (num_sleeping_.load(std::memory_order_seq_cst) > 0) {
+        absl::MutexLock lock(&sleep_mu_);
+        wake_up_.Signal();
+      }
+    }
+
+    bool WorkStealingThreadPool::PopFrom(WorkerQueue* queue, Task* task) {
+      if (queue->size.load(std::memory_order_relaxed) == 0) return false;
+      absl::MutexLock lock(&queue->mu);
+      if (queue->heap.empty()) return false;
+      std::pop_heap(queue->heap.begin(), queue->heap.end(), RunsLater());
+      *task = std::move(queue->heap.back());
+      queue->heap.pop_back();
+      queue->size.store(static_cast<int>(queue->heap.size()),
+                        std::memory_order_relaxed);
+      return true;
+    }
+
+    bool WorkStealingThreadPool::FindTask(int index, Task* task) {
+      if (PopFrom(queues_[index].get(), task)) return true;
+      for (int i = 1; i < num_threads(); ++i) {
+        if (PopFrom(queues_[(index + i) % num_threads()].get(), task)) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    void WorkStealingThreadPool::RunWorker(int index) {
+      current_worker = {this, index};
+      Task task;
+      while (true) {
+        if (FindTask(index, &task)) {
+          num_queued_.fetch_sub(1, std::memory_order_relaxed);
+          task.callback();
+          task.callback = nullptr;
+          continue;
+        }
+        absl::MutexLock lock(&sleep_mu_);
+        num_sleeping_.fetch_add(1, std::memory_order_seq_cst);
+        while (num_queued_.load(std::memory_order_seq_cst) == 0 && !stopping_) {
+          wake_up_.Wait(&sleep_mu_);
+        }
+        num_sleeping_.fetch_sub(1, std::memory_order_relaxed);
+        if (stopping_ && num_queued_.load(std::memory_order_seq_cst) == 0) break;
+      }
+      current_worker = {};
+    }
+
+}  // namespace mediapipe
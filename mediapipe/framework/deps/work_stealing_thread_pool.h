@@ -0,0 +1,124 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// A fixed-size thread pool with one task queue per worker. Workers run their
+// own tasks first and steal from the others when they run out, so tasks
+// scheduled from a worker tend to stay on that worker (and its caches)
+// without idle workers sitting next to a backlog.
+//
+// Tasks carry a priority. Each queue hands out its highest priority task
+// first, and tasks of equal priority in the order they were scheduled.
+
+#ifndef MEDIAPIPE_DEPS_WORK_STEALING_THREAD_POOL_H_
+#define MEDIAPIPE_DEPS_WORK_STEALING_THREAD_POOL_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/deps/thread_shard.h"
+
+namespace mediapipe {
+    // This class is thread safe.
+    class WorkStealingThreadPool {
+      public:
+        // Applied by every worker to itself when it starts. Linux only;
+        // failures are logged and the worker runs without them.
+        struct ThreadOptions {
+          // CPUs the worker may run on. Empty means any.
+          std::vector<int> cpus;
+          // Nice value of the worker, from -20 to 19.
+          int nice = 0;
+        };
+
+        // num_threads must be positive.
+        WorkStealingThreadPool(std::string name_prefix, int num_threads);
+        WorkStealingThreadPool(std::string name_prefix, int num_threads,
+                               ThreadOptions thread_options);
+        // Runs all scheduled tasks, then joins the workers.
+        ~WorkStealingThreadPool();
+        WorkStealingThreadPool(const WorkStealingThreadPool&) = delete;
+        WorkStealingThreadPool& operator=(const WorkStealingThreadPool&) = delete;
+
+        void StartWorkers();
+
+        // Schedules callback to run on a worker. Called from a worker of this
+        // pool, the task goes to that worker's own queue; otherwise queues are
+        // picked round-robin.
+        void Schedule(std::function<void()> callback, int priority = 0);
+
+        int num_threads() const { return static_cast<int>(queues_.size()); }
+        // Tasks scheduled and not yet taken by a worker. A snapshot.
+        int64_t NumQueued() const {
+          return num_queued_.load(std::memory_order_relaxed);
+        }
+
+        // The index of the calling thread among the workers of this pool, or
+        // -1 if it is not one of them.
+        int CurrentWorkerIndex() const;
+
+      private:
+        struct Task {
+          int priority;
+          uint64_t sequence;
+          std::function<void()> callback;
+        };
+
+        // Orders a heap so that its front is the task to run next.
+        struct RunsLater {
+          bool operator()(const Task& a, const Task& b) const {
+            if (a.priority != b.priority) return a.priority < b.priority;
+            return a.sequence > b.sequence;
+          }
+        };
+
+        struct alignas(kCacheLineSize) WorkerQueue {
+          absl::Mutex mu;
+          std::vector<Task> heap ABSL_GUARDED_BY(mu);
+          // Mirrors heap.size(), so that thieves can skip empty queues
+          // without locking them.
+          std::atomic<int> size{0};
+        };
+
+        void ApplyThreadOptions();
+        void RunWorker(int index);
+        bool PopFrom(WorkerQueue* queue, Task* task);
+        // Pops a task from the worker's own queue, else steals one.
+        bool FindTask(int index, Task* task);
+
+        const std::string name_prefix_;
+        const ThreadOptions thread_options_;
+        std::vector<std::unique_ptr<WorkerQueue>> queues_;
+        std::vector<std::thread> threads_;
+
+        std::atomic<uint64_t> next_sequence_{0};
+        std::atomic<uint32_t> next_queue_{0};
+        // Tasks scheduled but not yet taken by a worker.
+        std::atomic<int64_t> num_queued_{0};
+        std::atomic<int> num_sleeping_{0};
+
+        // Workers with nothing to do sleep here.
+        absl::Mutex sleep_mu_;
+        absl::CondVar wake_up_;
+        bool stopping_ ABSL_GUARDED_BY(sleep_mu_) = false;
+    };
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_DEPS_WORK_STEALING_THREAD_POOL_H_
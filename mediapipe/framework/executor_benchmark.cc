@@ -0,0 +1,128 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Latency of a light node while heavy nodes saturate the worker threads,
+// with all nodes in the default pool or the heavy ones on an executor of
+// their own.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/benchmark_util.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_graph.h"
+#include "mediapipe/framework/port/benchmark.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kNumFrames = 50;
+constexpr int kNumHeavyNodes = 2;
+constexpr absl::Duration kFramePeriod = absl::Milliseconds(2);
+// Each heavy node takes longer than a frame period, so they keep every
+// thread they can get busy.
+constexpr absl::Duration kHeavyWork = absl::Milliseconds(10);
+
+// Stands in for inference. Sleeps rather than spins, so that the heavy
+// nodes hold threads without taking the CPU from the light node.
+class HeavyCalculator : public CalculatorBase {
+ public:
+  absl::Status Process(CalculatorContext* /*cc*/) override {
+    absl::SleepFor(kHeavyWork);
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(HeavyCalculator);
+
+// "in" feeds kNumHeavyNodes heavy nodes, which queue without limit so they
+// never pace the input, and the light PassThroughCalculator, which outputs
+// "out". The default pool has kNumHeavyNodes threads; with isolate, so does
+// a "heavy" executor for the heavy nodes.
+CalculatorGraphConfig SaturatedConfig(bool isolate) {
+  CalculatorGraphConfig config;
+  config.set_num_threads(kNumHeavyNodes);
+  config.add_input_stream("in");
+  if (isolate) {
+    ExecutorConfig* executor = config.add_executor();
+    executor->set_name("heavy");
+    executor->set_num_threads(kNumHeavyNodes);
+  }
+  for (int i = 0; i < kNumHeavyNodes; ++i) {
+    CalculatorGraphConfig::Node* node = config.add_node();
+    node->set_name(absl::StrCat("heavy_", i));
+    node->set_calculator("HeavyCalculator");
+    node->add_input_stream("in");
+    InputStreamInfo* info = node->add_input_stream_info();
+    info->set_tag_index(":0");
+    info->set_max_queue_size(-1);
+    if (isolate) node->set_executor("heavy");
+  }
+  CalculatorGraphConfig::Node* node = config.add_node();
+  node->set_name("light");
+  node->set_calculator("PassThroughCalculator");
+  node->add_input_stream("in");
+  node->add_output_stream("out");
+  return config;
+}
+
+// Frames carry the time they were sent. Latency runs from then to the
+// light node's output.
+void BM_LightNodeLatency(benchmark::State& state, bool isolate) {
+  const CalculatorGraphConfig config = SaturatedConfig(isolate);
+  absl::Mutex mu;
+  std::vector<absl::Duration> latencies;
+  for (auto _ : state) {
+    CalculatorGraph graph;
+    ABSL_CHECK_OK(graph.Initialize(config));
+    ABSL_CHECK_OK(graph.ObserveOutputStream("out", [&](const Packet& packet) {
+      const absl::Duration latency =
+          absl::Now() - absl::FromUnixMicros(packet.Get<int64_t>());
+      absl::MutexLock lock(&mu);
+      latencies.push_back(latency);
+      return absl::OkStatus();
+    }));
+    ABSL_CHECK_OK(graph.StartRun());
+    const absl::Time start = absl::Now();
+    for (int i = 0; i < kNumFrames; ++i) {
+      absl::SleepFor(start + i * kFramePeriod - absl::Now());
+      ABSL_CHECK_OK(graph.AddPacketToInputStream(
+          "in", MakePacket<int64_t>(absl::ToUnixMicros(absl::Now()))
+                    .At(Timestamp(i))));
+    }
+    ABSL_CHECK_OK(graph.CloseAllInputStreams());
+    ABSL_CHECK_OK(graph.WaitUntilDone());
+  }
+  absl::MutexLock lock(&mu);
+  state.counters["p50_latency_ms"] = PercentileMs(latencies, 0.5);
+  state.counters["p99_latency_ms"] = PercentileMs(latencies, 0.99);
+}
+BENCHMARK_CAPTURE(BM_LightNodeLatency, SharedPool, false)
+    ->Iterations(3)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_LightNodeLatency, IsolatedHeavyNodes, true)
+    ->Iterations(3)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,151 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/image_frame.h"
+
+#include <cstring>
+#include <new>
+#include <utility>
+
+#include "absl/log/absl_check.h"
+#include "mediapipe/framework/type_map.h"
+
+namespace mediapipe {
+
+    int NumberOfChannelsForFormat(ImageFormat format) {
+      switch (format) {
+        case ImageFormat::kSrgb:
+        case ImageFormat::kVec32f3:
+          return 3;
+        case ImageFormat::kSrgba:
+        case ImageFormat::kVec32f4:
+          return 4;
+        case ImageFormat::kGray8:
+        case ImageFormat::kVec32f1:
+          return 1;
+        case ImageFormat::kUnknown:
+          break;
+      }
+      return 0;
+    }
+
+    int ByteDepthForFormat(ImageFormat format) {
+      switch (format) {
+        case ImageFormat::kSrgb:
+        case ImageFormat::kSrgba:
+        case ImageFormat::kGray8:
+          return 1;
+        case ImageFormat::kVec32f1:
+        case ImageFormat::kVec32f3:
+        case ImageFormat::kVec32f4:
+          return 4;
+        case ImageFormat::kUnknown:
+          break;
+      }
+      return 0;
+    }
+
+    absl::string_view ImageFormatName(ImageFormat format) {
+      switch (format) {
+        case ImageFormat::kSrgb:
+          return "SRGB";
+        case ImageFormat::kSrgba:
+          return "SRGBA";
+        case ImageFormat::kGray8:
+          return "GRAY8";
+        case ImageFormat::kVec32f1:
+          return "VEC32F1";
+        case ImageFormat::kVec32f3:
+          return "VEC32F3";
+        case ImageFormat::kVec32f4:
+          return "VEC32F4";
+        case ImageFormat::kUnknown:
+          break;
+      }
+      return "UNKNOWN";
+    }
+
+    ImageFrame::ImageFrame(ImageFormat format, int width, int height,
+                           int alignment_boundary) {
+      Reset(format, width, height, alignment_boundary);
+    }
+
+    ImageFrame::ImageFrame(ImageFormat format, int width, int height,
+                           int width_step, uint8_t* pixel_data,
+                           Deleter deleter) {
+      AdoptPixelData(format, width, height, width_step, pixel_data,
+                     std::move(deleter));
+    }
+
+    void ImageFrame::Reset(ImageFormat format, int width, int height,
+                           int alignment_boundary) {
+      ABSL_CHECK(format != ImageFormat::kUnknown);
+      ABSL_CHECK(width > 0 && height > 0);
+      ABSL_CHECK(alignment_boundary > 0 &&
+                 (alignment_boundary & (alignment_boundary - 1)) == 0)
+          << "alignment_boundary must be a power of two.";
+      format_ = format;
+      width_ = width;
+      height_ = height;
+      width_step_ =
+          (RowBytes() + alignment_boundary - 1) & ~(alignment_boundary - 1);
+      const auto alignment = static_cast<std::align_val_t>(alignment_boundary);
+      pixel_data_ = {
+          static_cast<uint8_t*>(::operator new(
+              static_cast<size_t>(width_step_) * height_, alignment)),
+          [alignment](uint8_t* data) { ::operator delete(data, alignment); }};
+    }
+
+    void ImageFrame::AdoptPixelData(ImageFormat format, int width, int height,
+                                    int width_step, uint8_t* pixel_data,
+                                    Deleter deleter) {
+      ABSL_CHECK(format != ImageFormat::kUnknown);
+      ABSL_CHECK(width > 0 && height > 0);
+      ABSL_CHECK(pixel_data != nullptr);
+      format_ = format;
+      width_ = width;
+      height_ = height;
+      width_step_ = width_step;
+      ABSL_CHECK_GE(width_step_, RowBytes());
+      pixel_data_ = {pixel_data, std::move(deleter)};
+    }
+
+    bool ImageFrame::IsAligned(int alignment) const {
+      return reinterpret_cast<uintptr_t>(PixelData()) % alignment == 0 &&
+             width_step_ % alignment == 0;
+    }
+
+    void ImageFrame::CopyFrom(const ImageFrame& image) {
+      if (image.IsEmpty()) {
+        *this = ImageFrame();
+        return;
+      }
+      if (IsEmpty() || format_ != image.format_ || width_ != image.width_ ||
+          height_ != image.height_) {
+        Reset(image.format_, image.width_, image.height_);
+      }
+      for (int y = 0; y < height_; ++y) {
+        std::memcpy(MutableRow(y), image.Row(y), RowBytes());
+      }
+    }
+
+    void ImageFrame::SetToZero() {
+      for (int y = 0; y < height_; ++y) {
+        std::memset(MutableRow(y), 0, RowBytes());
+      }
+    }
+
+}  // namespace mediapipe
+
+MEDIAPIPE_REGISTER_TYPE(::mediapipe::ImageFrame, "::mediapipe::ImageFrame");
@@ -0,0 +1,134 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ImageFrame: a CPU image with interleaved channels, e.g. a video frame.
+
+#ifndef CUSTOM_MEDIAPIPE_FORMATS_IMAGE_FRAME_H
+#define CUSTOM_MEDIAPIPE_FORMATS_IMAGE_FRAME_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "absl/strings/string_view.h"
+
+namespace mediapipe {
+    // The pixel formats of an ImageFrame. Channels are interleaved.
+    enum class ImageFormat {
+      kUnknown,
+      // 8-bit red, green, blue.
+      kSrgb,
+      // 8-bit red, green, blue, alpha.
+      kSrgba,
+      // 8-bit luminance.
+      kGray8,
+      // 32-bit float, 1, 3 or 4 channels.
+      kVec32f1,
+      kVec32f3,
+      kVec32f4,
+    };
+
+    int NumberOfChannelsForFormat(ImageFormat format);
+    // Bytes per channel.
+    int ByteDepthForFormat(ImageFormat format);
+    absl::string_view ImageFormatName(ImageFormat format);
+
+    // A CPU image. Pixel (x, y) starts at byte y * WidthStep() + x *
+    // NumberOfChannels() * ByteDepth() of PixelData().
+    //
+    // Images allocated by ImageFrame start on a 64-byte boundary, and each row
+    // is padded to a multiple of 64 bytes, so that every row starts on a
+    // cache line and SIMD kernels can load whole vectors; see
+    // image_frame_ops.h. An ImageFrame can also wrap a buffer it does not own,
+    // e.g. a camera buffer, without copying it; such a buffer may have any
+    // width step and alignment.
+    //
+    // ImageFrames are movable but not copyable; use CopyFrom() to copy pixels.
+    class ImageFrame {
+      public:
+        static constexpr int kDefaultAlignmentBoundary = 64;
+
+        // Releases the pixel data of a wrapped buffer.
+        using Deleter = std::function<void(uint8_t*)>;
+        // A Deleter that does nothing, for buffers that outlive the frame.
+        static void PixelDataDeleterNone(uint8_t*) {}
+
+        // An empty frame.
+        ImageFrame() = default;
+        // Allocates uninitialized pixels, with rows padded to a multiple of
+        // alignment_boundary bytes, a power of two.
+        ImageFrame(ImageFormat format, int width, int height,
+                   int alignment_boundary = kDefaultAlignmentBoundary);
+        // Wraps pixel_data without copying; deleter is called with it when
+        // the frame is destroyed or reset.
+        ImageFrame(ImageFormat format, int width, int height, int width_step,
+                   uint8_t* pixel_data, Deleter deleter);
+        ImageFrame(ImageFrame&& other) = default;
+        ImageFrame& operator=(ImageFrame&& other) = default;
+        ImageFrame(const ImageFrame&) = delete;
+        ImageFrame& operator=(const ImageFrame&) = delete;
+
+        // Replaces the pixels as by the constructors above.
+        void Reset(ImageFormat format, int width, int height,
+                   int alignment_boundary = kDefaultAlignmentBoundary);
+        void AdoptPixelData(ImageFormat format, int width, int height,
+                            int width_step, uint8_t* pixel_data,
+                            Deleter deleter);
+
+        bool IsEmpty() const { return pixel_data_ == nullptr; }
+        ImageFormat Format() const { return format_; }
+        int Width() const { return width_; }
+        int Height() const { return height_; }
+        // Bytes from the start of one row to the start of the next.
+        int WidthStep() const { return width_step_; }
+        int NumberOfChannels() const {
+          return NumberOfChannelsForFormat(format_);
+        }
+        int ByteDepth() const { return ByteDepthForFormat(format_); }
+        // Bytes of pixel data in a row, without padding.
+        int RowBytes() const {
+          return width_ * NumberOfChannels() * ByteDepth();
+        }
+
+        const uint8_t* PixelData() const { return pixel_data_.get(); }
+        uint8_t* MutablePixelData() { return pixel_data_.get(); }
+        const uint8_t* Row(int y) const {
+          return pixel_data_.get() + static_cast<ptrdiff_t>(y) * width_step_;
+        }
+        uint8_t* MutableRow(int y) {
+          return pixel_data_.get() + static_cast<ptrdiff_t>(y) * width_step_;
+        }
+
+        // True if the rows have no padding.
+        bool IsContiguous() const { return width_step_ == RowBytes(); }
+        // True if the data and every row start on a multiple of alignment.
+        bool IsAligned(int alignment) const;
+
+        // Allocates pixels like image's, if needed, and copies them. Copying
+        // an empty image empties this one.
+        void CopyFrom(const ImageFrame& image);
+        // Sets all pixels, not the padding, to 0.
+        void SetToZero();
+
+      private:
+        ImageFormat format_ = ImageFormat::kUnknown;
+        int width_ = 0;
+        int height_ = 0;
+        int width_step_ = 0;
+        std::unique_ptr<uint8_t[], Deleter> pixel_data_;
+    };
+}  // namespace mediapipe
+
+#endif  // CUSTOM_MEDIAPIPE_FORMATS_IMAGE_FRAME_H
@@ -0,0 +1,613 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/image_frame_ops.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+
+#include "absl/strings/str_cat.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define MEDIAPIPE_IMAGE_FRAME_OPS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace mediapipe {
+    namespace {
+
+    // Row kernels. Each converts n pixels, or n values for BlendRows and
+    // NormalizeRow.
+    using ConvertRowFn = void (*)(const uint8_t* src, uint8_t* dst, int n);
+    // dst[i] = (row0[i] * weight0 + row1[i] * weight1 + (1 << 13)) >> 14,
+    // where weight0 + weight1 == 128.
+    using BlendRowsFn = void (*)(const int16_t* row0, const int16_t* row1,
+                                 int weight0, int weight1, uint8_t* dst, int n);
+    using NormalizeRowFn = void (*)(const uint8_t* src, float* dst, int n,
+                                    float scale, float offset);
+
+    struct Kernels {
+      ConvertRowFn rgb_to_rgba;
+      ConvertRowFn rgba_to_rgb;
+      ConvertRowFn rgb_to_gray;
+      ConvertRowFn rgba_to_gray;
+      ConvertRowFn gray_to_rgb;
+      ConvertRowFn gray_to_rgba;
+      BlendRowsFn blend_rows;
+      NormalizeRowFn normalize;
+    };
+
+    // Gray weights, in 1/128.
+    constexpr int kRedWeight = 38;
+    constexpr int kGreenWeight = 75;
+    constexpr int kBlueWeight = 15;
+
+    // Scalar kernels, also used for the tails of the SIMD ones.
+
+    void RgbToRgbaScalar(const uint8_t* src, uint8_t* dst, int n) {
+      for (int x = 0; x < n; ++x, src += 3, dst += 4) {
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+        dst[3] = 255;
+      }
+    }
+
+    void RgbaToRgbScalar(const uint8_t* src, uint8_t* dst, int n) {
+      for (int x = 0; x < n; ++x, src += 4, dst += 3) {
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+      }
+    }
+
+    inline uint8_t Gray(const uint8_t* rgb) {
+      return static_cast<uint8_t>((kRedWeight * rgb[0] + kGreenWeight * rgb[1] +
+                                   kBlueWeight * rgb[2] + 64) >>
+                                  7);
+    }
+
+    void RgbToGrayScalar(const uint8_t* src, uint8_t* dst, int n) {
+      for (int x = 0; x < n; ++x, src += 3) dst[x] = Gray(src);
+    }
+
+    void RgbaToGrayScalar(const uint8_t* src, uint8_t* dst, int n) {
+      for (int x = 0; x < n; ++x, src += 4) dst[x] = Gray(src);
+    }
+
+    void GrayToRgbScalar(const uint8_t* src, uint8_t* dst, int n) {
+      for (int x = 0; x < n; ++x, dst += 3) dst[0] = dst[1] = dst[2] = src[x];
+    }
+
+    void GrayToRgbaScalar(const uint8_t* src, uint8_t* dst, int n) {
+      for (int x = 0; x < n; ++x, dst += 4) {
+        dst[0] = dst[1] = dst[2] = src[x];
+        dst[3] = 255;
+      }
+    }
+
+    void BlendRowsScalar(const int16_t* row0, const int16_t* row1, int weight0,
+                         int weight1, uint8_t* dst, int n) {
+      for (int i = 0; i < n; ++i) {
+        dst[i] = static_cast<uint8_t>(
+            (row0[i] * weight0 + row1[i] * weight1 + (1 << 13)) >> 14);
+      }
+    }
+
+    void NormalizeRowScalar(const uint8_t* src, float* dst, int n, float scale,
+                            float offset) {
+      for (int i = 0; i < n; ++i) {
+        dst[i] = static_cast<float>(src[i]) * scale + offset;
+      }
+    }
+
+    constexpr Kernels kScalarKernels = {
+        RgbToRgbaScalar,  RgbaToRgbScalar,  RgbToGrayScalar,
+        RgbaToGrayScalar, GrayToRgbScalar,  GrayToRgbaScalar,
+        BlendRowsScalar,  NormalizeRowScalar,
+    };
+
+#ifdef MEDIAPIPE_IMAGE_FRAME_OPS_X86
+    // SSE4.1 kernels. Loads and stores are unaligned, and never go past the
+    // end of a row: the loops leave enough pixels to the scalar tails.
+
+#define MEDIAPIPE_SSE4 __attribute__((target("sse4.1")))
+#define MEDIAPIPE_AVX2 __attribute__((target("avx2")))
+
+    // Spreads 4 RGB pixels in the low 12 bytes to RGB0 RGB0 RGB0 RGB0.
+    MEDIAPIPE_SSE4 inline __m128i RgbToRgb0Mask() {
+      return _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11,
+                           -1);
+    }
+
+    MEDIAPIPE_SSE4 inline __m128i GrayWeights() {
+      return _mm_set1_epi32(kRedWeight | kGreenWeight << 8 | kBlueWeight << 16);
+    }
+
+    // Returns the gray values of 8 RGB0 or RGBA pixels in the low 8 bytes.
+    MEDIAPIPE_SSE4 inline __m128i GrayOf8(__m128i pixels0, __m128i pixels1) {
+      const __m128i weights = GrayWeights();
+      __m128i sums = _mm_hadd_epi16(_mm_maddubs_epi16(pixels0, weights),
+                                    _mm_maddubs_epi16(pixels1, weights));
+      sums = _mm_srli_epi16(_mm_add_epi16(sums, _mm_set1_epi16(64)), 7);
+      return _mm_packus_epi16(sums, sums);
+    }
+
+    MEDIAPIPE_SSE4 void RgbToRgbaSse4(const uint8_t* src, uint8_t* dst, int n) {
+      const __m128i mask = RgbToRgb0Mask();
+      const __m128i alpha = _mm_set1_epi32(0xff000000);
+      int x = 0;
+      for (; x + 6 <= n; x += 4) {
+        __m128i rgb =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * x));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * x),
+                         _mm_or_si128(_mm_shuffle_epi8(rgb, mask), alpha));
+      }
+      RgbToRgbaScalar(src + 3 * x, dst + 4 * x, n - x);
+    }
+
+    MEDIAPIPE_SSE4 void RgbaToRgbSse4(const uint8_t* src, uint8_t* dst, int n) {
+      const __m128i mask = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14,
+                                         -1, -1, -1, -1);
+      int x = 0;
+      // Each store writes 4 bytes past the 4 pixels, which the next
+      // iteration overwrites.
+      for (; x + 6 <= n; x += 4) {
+        __m128i rgba =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * x));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 3 * x),
+                         _mm_shuffle_epi8(rgba, mask));
+      }
+      RgbaToRgbScalar(src + 4 * x, dst + 3 * x, n - x);
+    }
+
+    MEDIAPIPE_SSE4 void RgbToGraySse4(const uint8_t* src, uint8_t* dst, int n) {
+      const __m128i mask = RgbToRgb0Mask();
+      int x = 0;
+      for (; x + 10 <= n; x += 8) {
+        const uint8_t* p = src + 3 * x;
+        __m128i pixels0 = _mm_shuffle_epi8(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), mask);
+        __m128i pixels1 = _mm_shuffle_epi8(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 12)), mask);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x),
+                         GrayOf8(pixels0, pixels1));
+      }
+      RgbToGrayScalar(src + 3 * x, dst + x, n - x);
+    }
+
+    MEDIAPIPE_SSE4 void RgbaToGraySse4(const uint8_t* src, uint8_t* dst,
+                                       int n) {
+      int x = 0;
+      for (; x + 8 <= n; x += 8) {
+        const __m128i* p = reinterpret_cast<const __m128i*>(src + 4 * x);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x),
+                         GrayOf8(_mm_loadu_si128(p), _mm_loadu_si128(p + 1)));
+      }
+      RgbaToGrayScalar(src + 4 * x, dst + x, n - x);
+    }
+
+    MEDIAPIPE_SSE4 void GrayToRgbSse4(const uint8_t* src, uint8_t* dst, int n) {
+      const __m128i mask0 =
+          _mm_setr_epi8(0, 0, 0, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4, 5);
+      const __m128i mask1 =
+          _mm_setr_epi8(5, 5, 6, 6, 6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10);
+      const __m128i mask2 = _mm_setr_epi8(10, 11, 11, 11, 12, 12, 12, 13, 13,
+                                          13, 14, 14, 14, 15, 15, 15);
+      int x = 0;
+      for (; x + 16 <= n; x += 16) {
+        __m128i gray =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+        __m128i* out = reinterpret_cast<__m128i*>(dst + 3 * x);
+        _mm_storeu_si128(out, _mm_shuffle_epi8(gray, mask0));
+        _mm_storeu_si128(out + 1, _mm_shuffle_epi8(gray, mask1));
+        _mm_storeu_si128(out + 2, _mm_shuffle_epi8(gray, mask2));
+      }
+      GrayToRgbScalar(src + x, dst + 3 * x, n - x);
+    }
+
+    MEDIAPIPE_SSE4 void GrayToRgbaSse4(const uint8_t* src, uint8_t* dst,
+                                       int n) {
+      const __m128i alpha = _mm_set1_epi32(0xff000000);
+      int x = 0;
+      for (; x + 16 <= n; x += 16) {
+        __m128i gray =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+        __m128i* out = reinterpret_cast<__m128i*>(dst + 4 * x);
+        for (int k = 0; k < 4; ++k) {
+          // Bytes 4k..4k+3 of gray, each repeated in R, G and B.
+          const __m128i mask = _mm_add_epi8(
+              _mm_setr_epi8(0, 0, 0, -1, 1, 1, 1, -1, 2, 2, 2, -1, 3, 3, 3, -1),
+              _mm_and_si128(_mm_set1_epi8(static_cast<char>(4 * k)),
+                            _mm_set1_epi32(0x00ffffff)));
+          _mm_storeu_si128(out + k,
+                           _mm_or_si128(_mm_shuffle_epi8(gray, mask), alpha));
+        }
+      }
+      GrayToRgbaScalar(src + x, dst + 4 * x, n - x);
+    }
+
+    // Blends 8 values into 8 int16s.
+    MEDIAPIPE_SSE4 inline __m128i Blend8(const int16_t* row0,
+                                         const int16_t* row1, __m128i weights) {
+      const __m128i round = _mm_set1_epi32(1 << 13);
+      __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0));
+      __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1));
+      __m128i lo = _mm_add_epi32(
+          _mm_madd_epi16(_mm_unpacklo_epi16(a, b), weights), round);
+      __m128i hi = _mm_add_epi32(
+          _mm_madd_epi16(_mm_unpackhi_epi16(a, b), weights), round);
+      return _mm_packs_epi32(_mm_srai_epi32(lo, 14), _mm_srai_epi32(hi, 14));
+    }
+
+    MEDIAPIPE_SSE4 void BlendRowsSse4(const int16_t* row0, const int16_t* row1,
+                                      int weight0, int weight1, uint8_t* dst,
+                                      int n) {
+      const __m128i weights = _mm_set1_epi32(weight0 | weight1 << 16);
+      int i = 0;
+      for (; i + 16 <= n; i += 16) {
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(dst + i),
+            _mm_packus_epi16(Blend8(row0 + i, row1 + i, weights),
+                             Blend8(row0 + i + 8, row1 + i + 8, weights)));
+      }
+      BlendRowsScalar(row0 + i, row1 + i, weight0, weight1, dst + i, n - i);
+    }
+
+    MEDIAPIPE_SSE4 void NormalizeRowSse4(const uint8_t* src, float* dst, int n,
+                                         float scale, float offset) {
+      const __m128 scales = _mm_set1_ps(scale);
+      const __m128 offsets = _mm_set1_ps(offset);
+      int i = 0;
+      for (; i + 16 <= n; i += 16) {
+        __m128i bytes =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        for (int k = 0; k < 4; ++k) {
+          __m128 values = _mm_cvtepi32_ps(_mm_cvtepu8_epi32(bytes));
+          _mm_storeu_ps(dst + i + 4 * k,
+                        _mm_add_ps(_mm_mul_ps(values, scales), offsets));
+          bytes = _mm_srli_si128(bytes, 4);
+        }
+      }
+      NormalizeRowScalar(src + i, dst + i, n - i, scale, offset);
+    }
+
+    // AVX2 kernels. RGB input is not among them: gathering 3-byte pixels
+    // across the two 128-bit lanes costs more than the wider vectors save.
+
+    // Returns the gray values of 16 RGB0 or RGBA pixels in the low 16 bytes;
+    // pixels0 holds pixels 0-7 and pixels1 pixels 8-15.
+    MEDIAPIPE_AVX2 inline __m128i GrayOf16(__m256i pixels0, __m256i pixels1) {
+      const __m256i weights = _mm256_set1_epi32(kRedWeight | kGreenWeight << 8 |
+                                                kBlueWeight << 16);
+      // Per 128-bit lane: pixels 0-3 and 8-11, then 4-7 and 12-15.
+      __m256i sums = _mm256_hadd_epi16(_mm256_maddubs_epi16(pixels0, weights),
+                                       _mm256_maddubs_epi16(pixels1, weights));
+      sums =
+          _mm256_srli_epi16(_mm256_add_epi16(sums, _mm256_set1_epi16(64)), 7);
+      const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 0, 0, 0, 0);
+      __m256i gray =
+          _mm256_permutevar8x32_epi32(_mm256_packus_epi16(sums, sums), order);
+      return _mm256_castsi256_si128(gray);
+    }
+
+    MEDIAPIPE_AVX2 void RgbaToGrayAvx2(const uint8_t* src, uint8_t* dst,
+                                       int n) {
+      int x = 0;
+      for (; x + 16 <= n; x += 16) {
+        const __m256i* p = reinterpret_cast<const __m256i*>(src + 4 * x);
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(dst + x),
+            GrayOf16(_mm256_loadu_si256(p), _mm256_loadu_si256(p + 1)));
+      }
+      RgbaToGraySse4(src + 4 * x, dst + x, n - x);
+    }
+
+    MEDIAPIPE_AVX2 void BlendRowsAvx2(const int16_t* row0, const int16_t* row1,
+                                      int weight0, int weight1, uint8_t* dst,
+                                      int n) {
+      const __m256i weights = _mm256_set1_epi32(weight0 | weight1 << 16);
+      const __m256i round = _mm256_set1_epi32(1 << 13);
+      int i = 0;
+      for (; i + 16 <= n; i += 16) {
+        __m256i a =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row0 + i));
+        __m256i b =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row1 + i));
+        // Unpacking and packing both work per 128-bit lane, so the values
+        // come back in order within each lane.
+        __m256i lo = _mm256_add_epi32(
+            _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), weights), round);
+        __m256i hi = _mm256_add_epi32(
+            _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), weights), round);
+        __m256i blended = _mm256_packs_epi32(_mm256_srai_epi32(lo, 14),
+                                             _mm256_srai_epi32(hi, 14));
+        __m256i bytes = _mm256_permute4x64_epi64(
+            _mm256_packus_epi16(blended, blended), 0x08);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                         _mm256_castsi256_si128(bytes));
+      }
+      BlendRowsSse4(row0 + i, row1 + i, weight0, weight1, dst + i, n - i);
+    }
+
+    MEDIAPIPE_AVX2 void NormalizeRowAvx2(const uint8_t* src, float* dst, int n,
+                                         float scale, float offset) {
+      const __m256 scales = _mm256_set1_ps(scale);
+      const __m256 offsets = _mm256_set1_ps(offset);
+      int i = 0;
+      for (; i + 16 <= n; i += 16) {
+        for (int k = 0; k < 16; k += 8) {
+          __m256 values = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(
+              _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i + k))));
+          _mm256_storeu_ps(
+              dst + i + k,
+              _mm256_add_ps(_mm256_mul_ps(values, scales), offsets));
+        }
+      }
+      NormalizeRowSse4(src + i, dst + i, n - i, scale, offset);
+    }
+
+    constexpr Kernels kSse4Kernels = {
+        RgbToRgbaSse4,  RgbaToRgbSse4,  RgbToGraySse4,
+        RgbaToGraySse4, GrayToRgbSse4,  GrayToRgbaSse4,
+        BlendRowsSse4,  NormalizeRowSse4,
+    };
+
+    constexpr Kernels kAvx2Kernels = {
+        RgbToRgbaSse4,  RgbaToRgbSse4,  RgbToGraySse4,
+        RgbaToGrayAvx2, GrayToRgbSse4,  GrayToRgbaSse4,
+        BlendRowsAvx2,  NormalizeRowAvx2,
+    };
+
+    SimdLevel SupportedSimdLevel() {
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx2")) return SimdLevel::kAvx2;
+      if (__builtin_cpu_supports("sse4.1")) return SimdLevel::kSse4;
+      return SimdLevel::kScalar;
+    }
+#else
+    SimdLevel SupportedSimdLevel() { return SimdLevel::kScalar; }
+#endif  // MEDIAPIPE_IMAGE_FRAME_OPS_X86
+
+    const SimdLevel kSupportedSimdLevel = SupportedSimdLevel();
+    std::atomic<SimdLevel> simd_level{kSupportedSimdLevel};
+
+    const Kernels& GetKernels() {
+#ifdef MEDIAPIPE_IMAGE_FRAME_OPS_X86
+      switch (simd_level.load(std::memory_order_relaxed)) {
+        case SimdLevel::kAvx2:
+          return kAvx2Kernels;
+        case SimdLevel::kSse4:
+          return kSse4Kernels;
+        case SimdLevel::kScalar:
+          break;
+      }
+#endif
+      return kScalarKernels;
+    }
+
+    bool Is8Bit(ImageFormat format) {
+      return format == ImageFormat::kSrgb || format == ImageFormat::kSrgba ||
+             format == ImageFormat::kGray8;
+    }
+
+    // Allocates output unless it already has the format and size.
+    void PrepareOutput(ImageFormat format, int width, int height,
+                       ImageFrame* output) {
+      if (output->IsEmpty() || output->Format() != format ||
+          output->Width() != width || output->Height() != height) {
+        output->Reset(format, width, height);
+      }
+    }
+
+    absl::Status CheckInput(const ImageFrame& input, const ImageFrame* output,
+                            absl::string_view operation) {
+      if (input.IsEmpty() || !Is8Bit(input.Format())) {
+        return absl::InvalidArgumentError(absl::StrCat(
+            operation, " needs an SRGB, SRGBA or GRAY8 image, got ",
+            input.IsEmpty() ? "an empty one" : ImageFormatName(input.Format()),
+            "."));
+      }
+      if (&input == output) {
+        return absl::InvalidArgumentError(
+            absl::StrCat(operation, " cannot write to its input."));
+      }
+      return absl::OkStatus();
+    }
+
+    // Where a bilinear sample falls between two source pixels.
+    struct Tap {
+      int index0;
+      int index1;
+      // Of index1, in 1/128; index0 gets the rest.
+      int weight1;
+    };
+
+    // Fills taps[0, dst_size).
+    void ComputeTaps(int src_size, int dst_size, Tap* taps) {
+      const double scale = static_cast<double>(src_size) / dst_size;
+      for (int i = 0; i < dst_size; ++i) {
+        double position = std::max(0.0, (i + 0.5) * scale - 0.5);
+        int index0 = std::min(static_cast<int>(position), src_size - 1);
+        int weight1 =
+            static_cast<int>(std::lround((position - index0) * 128));
+        taps[i] = {index0, std::min(index0 + 1, src_size - 1),
+                   index0 == src_size - 1 ? 0 : weight1};
+      }
+    }
+
+    // Interpolates one source row horizontally, to values scaled by 128.
+    // Templated on the channel count so the inner loop unrolls. This pass
+    // gathers pixels at arbitrary taps, so it has no SIMD kernels; it runs
+    // once per source row used, while the vertical blend, which has them,
+    // runs once per output row.
+    template <int kChannels>
+    void ResizeRowHorizontally(const uint8_t* src, const Tap* taps,
+                               int num_taps, int16_t* dst) {
+      for (const Tap* tap = taps; tap != taps + num_taps; ++tap) {
+        const uint8_t* pixel0 = src + tap->index0 * kChannels;
+        const uint8_t* pixel1 = src + tap->index1 * kChannels;
+        const int weight0 = 128 - tap->weight1;
+        for (int c = 0; c < kChannels; ++c) {
+          dst[c] = static_cast<int16_t>(pixel0[c] * weight0 +
+                                        pixel1[c] * tap->weight1);
+        }
+        dst += kChannels;
+      }
+    }
+
+    using ResizeRowFn = void (*)(const uint8_t* src, const Tap* taps,
+                                 int num_taps, int16_t* dst);
+
+    ResizeRowFn GetResizeRowHorizontally(int channels) {
+      switch (channels) {
+        case 1:
+          return ResizeRowHorizontally<1>;
+        case 3:
+          return ResizeRowHorizontally<3>;
+        default:
+          return ResizeRowHorizontally<4>;
+      }
+    }
+
+    // Returns n uninitialized Ts from scratch, or, without one, from the heap
+    // through owner.
+    template <typename T>
+    T* ScratchArray(Arena* scratch, size_t n, std::unique_ptr<T[]>* owner) {
+      if (scratch != nullptr) return scratch->CreateArray<T>(n);
+      owner->reset(new T[n]);
+      return owner->get();
+    }
+
+    }  // namespace
+
+    SimdLevel GetSimdLevel() {
+      return simd_level.load(std::memory_order_relaxed);
+    }
+
+    SimdLevel SetSimdLevel(SimdLevel level) {
+      level = std::min(level, kSupportedSimdLevel);
+      simd_level.store(level, std::memory_order_relaxed);
+      return level;
+    }
+
+    absl::Status ConvertImageFrame(const ImageFrame& input, ImageFormat format,
+                                   ImageFrame* output) {
+      absl::Status status = CheckInput(input, output, "ConvertImageFrame");
+      if (!status.ok()) return status;
+      if (format == input.Format()) {
+        output->CopyFrom(input);
+        return absl::OkStatus();
+      }
+      const Kernels& kernels = GetKernels();
+      ConvertRowFn convert_row = nullptr;
+      switch (input.Format()) {
+        case ImageFormat::kSrgb:
+          convert_row = format == ImageFormat::kSrgba  ? kernels.rgb_to_rgba
+                        : format == ImageFormat::kGray8 ? kernels.rgb_to_gray
+                                                        : nullptr;
+          break;
+        case ImageFormat::kSrgba:
+          convert_row = format == ImageFormat::kSrgb    ? kernels.rgba_to_rgb
+                        : format == ImageFormat::kGray8 ? kernels.rgba_to_gray
+                                                        : nullptr;
+          break;
+        case ImageFormat::kGray8:
+          convert_row = format == ImageFormat::kSrgb    ? kernels.gray_to_rgb
+                        : format == ImageFormat::kSrgba ? kernels.gray_to_rgba
+                                                        : nullptr;
+          break;
+        default:
+          break;
+      }
+      if (convert_row == nullptr) {
+        return absl::InvalidArgumentError(
+            absl::StrCat("ConvertImageFrame cannot convert ",
+                         ImageFormatName(input.Format()), " to ",
+                         ImageFormatName(format), "."));
+      }
+      PrepareOutput(format, input.Width(), input.Height(), output);
+      for (int y = 0; y < input.Height(); ++y) {
+        convert_row(input.Row(y), output->MutableRow(y), input.Width());
+      }
+      return absl::OkStatus();
+    }
+
+    absl::Status ResizeImageFrame(const ImageFrame& input, int width,
+                                  int height, ImageFrame* output,
+                                  Arena* scratch) {
+      absl::Status status = CheckInput(input, output, "ResizeImageFrame");
+      if (!status.ok()) return status;
+      if (width <= 0 || height <= 0) {
+        return absl::InvalidArgumentError(absl::StrCat(
+            "ResizeImageFrame to ", width, "x", height, " is not possible."));
+      }
+      PrepareOutput(input.Format(), width, height, output);
+      const int channels = input.NumberOfChannels();
+      const int row_values = width * channels;
+      std::unique_ptr<Tap[]> heap_taps;
+      std::unique_ptr<int16_t[]> heap_rows;
+      Tap* x_taps = ScratchArray(scratch, width + height, &heap_taps);
+      Tap* y_taps = x_taps + width;
+      ComputeTaps(input.Width(), width, x_taps);
+      ComputeTaps(input.Height(), height, y_taps);
+      const ResizeRowFn resize_row = GetResizeRowHorizontally(channels);
+      const BlendRowsFn blend_rows = GetKernels().blend_rows;
+
+      // Horizontally resized source rows. The two rows a sample needs are
+      // adjacent, so row y lives in slot y % 2.
+      int16_t* rows = ScratchArray(scratch, 2 * row_values, &heap_rows);
+      int rows_y[2] = {-1, -1};
+      auto resized_row = [&](int y) {
+        const int slot = y & 1;
+        int16_t* row = rows + slot * row_values;
+        if (rows_y[slot] != y) {
+          resize_row(input.Row(y), x_taps, width, row);
+          rows_y[slot] = y;
+        }
+        return row;
+      };
+      for (int y = 0; y < height; ++y) {
+        const Tap& tap = y_taps[y];
+        const int16_t* row0 = resized_row(tap.index0);
+        const int16_t* row1 = resized_row(tap.index1);
+        blend_rows(row0, row1, 128 - tap.weight1, tap.weight1,
+                   output->MutableRow(y), row_values);
+      }
+      return absl::OkStatus();
+    }
+
+    absl::Status NormalizeImageFrame(const ImageFrame& input, float scale,
+                                     float offset, ImageFrame* output) {
+      absl::Status status = CheckInput(input, output, "NormalizeImageFrame");
+      if (!status.ok()) return status;
+      const int channels = input.NumberOfChannels();
+      PrepareOutput(channels == 1   ? ImageFormat::kVec32f1
+                    : channels == 3 ? ImageFormat::kVec32f3
+                                    : ImageFormat::kVec32f4,
+                    input.Width(), input.Height(), output);
+      const NormalizeRowFn normalize_row = GetKernels().normalize;
+      for (int y = 0; y < input.Height(); ++y) {
+        normalize_row(input.Row(y),
+                      reinterpret_cast<float*>(output->MutableRow(y)),
+                      input.Width() * channels, scale, offset);
+      }
+      return absl::OkStatus();
+    }
+
+}  // namespace mediapipe
@@ -0,0 +1,72 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Pixel format conversion, resizing and normalization of ImageFrames.
+//
+// Every operation has a portable scalar kernel and, on x86 with GCC or
+// Clang, SSE4.1 and AVX2 kernels. The best kernels the CPU supports are
+// picked at run time, so binaries need no special compiler flags. All levels
+// compute the same results bit for bit; they differ in speed only. Kernels
+// handle any width step and alignment, and are fastest on the 64-byte
+// aligned rows that ImageFrame allocates.
+//
+// Outputs are reallocated only if their format or size does not match, so
+// reusing an output frame across calls does not allocate; neither does
+// ResizeImageFrame() given a scratch arena that has reached its working
+// size. An output must not be its input.
+
+#ifndef CUSTOM_MEDIAPIPE_FORMATS_IMAGE_FRAME_OPS_H
+#define CUSTOM_MEDIAPIPE_FORMATS_IMAGE_FRAME_OPS_H
+
+#include "absl/status/status.h"
+#include "mediapipe/framework/deps/arena.h"
+#include "mediapipe/framework/formats/image_frame.h"
+
+namespace mediapipe {
+    enum class SimdLevel { kScalar, kSse4, kAvx2 };
+
+    // The level of the kernels in use: the best the CPU supports, unless
+    // lowered with SetSimdLevel().
+    SimdLevel GetSimdLevel();
+    // Uses kernels up to level, or the best the CPU supports if lower, e.g. to
+    // compare levels. Thread safe, but affects all threads. Returns the level
+    // now in use.
+    SimdLevel SetSimdLevel(SimdLevel level);
+
+    // Converts between kSrgb, kSrgba and kGray8. Alpha becomes 255, and gray
+    // is (38 R + 75 G + 15 B + 64) >> 7, close to Rec. 601 luma.
+    absl::Status ConvertImageFrame(const ImageFrame& input, ImageFormat format,
+                                   ImageFrame* output);
+
+    // Resizes a kSrgb, kSrgba or kGray8 image to width x height with
+    // bilinear interpolation, sampling at pixel centers. Weights have 7 bits
+    // of precision. Only the vertical blend has SIMD kernels; the horizontal
+    // pass is scalar at every level.
+    //
+    // Temporaries, about 2 * width * channels int16s plus a few ints per
+    // output row and column, come from scratch if given, e.g.
+    // CalculatorContext::Scratch(), and from the heap otherwise. The caller
+    // resets scratch.
+    absl::Status ResizeImageFrame(const ImageFrame& input, int width,
+                                  int height, ImageFrame* output,
+                                  Arena* scratch = nullptr);
+
+    // Converts an 8-bit image to float: every channel becomes value * scale +
+    // offset, e.g. scale 2 / 255.0 and offset -1 for [-1, 1]. The output is
+    // kVec32f1, kVec32f3 or kVec32f4, by the number of channels.
+    absl::Status NormalizeImageFrame(const ImageFrame& input, float scale,
+                                     float offset, ImageFrame* output);
+}  // namespace mediapipe
+
+#endif  // CUSTOM_MEDIAPIPE_FORMATS_IMAGE_FRAME_OPS_H
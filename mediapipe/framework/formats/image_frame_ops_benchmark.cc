@@ -0,0 +1,130 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ImageFrame operations on 720p and 4K frames at each SIMD level. Levels the
+// CPU does not support are skipped.
+
+#include <cstdint>
+
+#include "absl/log/absl_check.h"
+#include "mediapipe/framework/deps/arena.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_ops.h"
+#include "mediapipe/framework/port/benchmark.h"
+
+namespace mediapipe {
+namespace {
+
+ImageFrame MakeFrame(ImageFormat format, int width, int height) {
+  ImageFrame frame(format, width, height);
+  for (int y = 0; y < height; ++y) {
+    uint8_t* row = frame.MutableRow(y);
+    for (int i = 0; i < width * frame.NumberOfChannels(); ++i) {
+      row[i] = static_cast<uint8_t>(i * 7 + y * 13);
+    }
+  }
+  return frame;
+}
+
+// Sets the level in state.range(0) for the benchmark's lifetime, and skips
+// the benchmark if the CPU does not support it.
+class ScopedSimdLevel {
+ public:
+  explicit ScopedSimdLevel(benchmark::State& state)
+      : previous_(GetSimdLevel()) {
+    const SimdLevel level = static_cast<SimdLevel>(state.range(0));
+    if (SetSimdLevel(level) != level) {
+      state.SkipWithError("SIMD level not supported");
+    }
+  }
+  ~ScopedSimdLevel() { SetSimdLevel(previous_); }
+
+ private:
+  const SimdLevel previous_;
+};
+
+void SetPixelsProcessed(benchmark::State& state, const ImageFrame& frame) {
+  state.SetItemsProcessed(state.iterations() * frame.Width() *
+                          frame.Height());
+}
+
+// Args: SIMD level, source width, source height.
+void SimdLevelsAndSizes(benchmark::internal::Benchmark* benchmark) {
+  for (SimdLevel level :
+       {SimdLevel::kScalar, SimdLevel::kSse4, SimdLevel::kAvx2}) {
+    benchmark->Args({static_cast<int>(level), 1280, 720});
+    benchmark->Args({static_cast<int>(level), 3840, 2160});
+  }
+}
+
+void BM_ConvertRgbToRgba(benchmark::State& state) {
+  ScopedSimdLevel simd_level(state);
+  const ImageFrame input =
+      MakeFrame(ImageFormat::kSrgb, state.range(1), state.range(2));
+  ImageFrame output;
+  for (auto _ : state) {
+    ABSL_CHECK_OK(ConvertImageFrame(input, ImageFormat::kSrgba, &output));
+    benchmark::DoNotOptimize(output.PixelData());
+  }
+  SetPixelsProcessed(state, input);
+}
+BENCHMARK(BM_ConvertRgbToRgba)->Apply(SimdLevelsAndSizes);
+
+void BM_ConvertRgbToGray(benchmark::State& state) {
+  ScopedSimdLevel simd_level(state);
+  const ImageFrame input =
+      MakeFrame(ImageFormat::kSrgb, state.range(1), state.range(2));
+  ImageFrame output;
+  for (auto _ : state) {
+    ABSL_CHECK_OK(ConvertImageFrame(input, ImageFormat::kGray8, &output));
+    benchmark::DoNotOptimize(output.PixelData());
+  }
+  SetPixelsProcessed(state, input);
+}
+BENCHMARK(BM_ConvertRgbToGray)->Apply(SimdLevelsAndSizes);
+
+// Downscales to a typical model input. Temporaries come from the heap, or
+// from a scratch arena reset after every frame as a calculator's is.
+void BM_Resize(benchmark::State& state, bool use_scratch) {
+  ScopedSimdLevel simd_level(state);
+  const ImageFrame input =
+      MakeFrame(ImageFormat::kSrgb, state.range(1), state.range(2));
+  ImageFrame output;
+  Arena arena;
+  Arena* scratch = use_scratch ? &arena : nullptr;
+  for (auto _ : state) {
+    ABSL_CHECK_OK(ResizeImageFrame(input, 640, 360, &output, scratch));
+    benchmark::DoNotOptimize(output.PixelData());
+    arena.Reset();
+  }
+  SetPixelsProcessed(state, input);
+}
+BENCHMARK_CAPTURE(BM_Resize, Heap, false)->Apply(SimdLevelsAndSizes);
+BENCHMARK_CAPTURE(BM_Resize, Scratch, true)->Apply(SimdLevelsAndSizes);
+
+void BM_Normalize(benchmark::State& state) {
+  ScopedSimdLevel simd_level(state);
+  const ImageFrame input =
+      MakeFrame(ImageFormat::kSrgb, state.range(1), state.range(2));
+  ImageFrame output;
+  for (auto _ : state) {
+    ABSL_CHECK_OK(NormalizeImageFrame(input, 2 / 255.0f, -1, &output));
+    benchmark::DoNotOptimize(output.PixelData());
+  }
+  SetPixelsProcessed(state, input);
+}
+BENCHMARK(BM_Normalize)->Apply(SimdLevelsAndSizes);
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,204 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Checks that the SIMD kernels compute what the scalar ones do, bit for bit,
+// at widths that leave scalar tails and on rows of any width step and
+// alignment.
+
+#include "mediapipe/framework/formats/image_frame_ops.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr ImageFormat k8BitFormats[] = {ImageFormat::kSrgb,
+                                        ImageFormat::kSrgba,
+                                        ImageFormat::kGray8};
+// Around the 16- and 32-byte vectors, and odd ones.
+constexpr int kWidths[] = {1, 2, 3, 5, 7, 15, 16, 17, 31, 32, 33, 63, 65, 101};
+constexpr int kHeight = 5;
+constexpr uint8_t kPadding = 0xA5;
+
+enum class Layout {
+  // As ImageFrame allocates: 64-byte aligned, padded rows.
+  kAligned,
+  // A wrapped buffer: rows start one element past a 64-byte boundary and
+  // are padded by three elements, filled with kPadding.
+  kUnaligned,
+};
+
+// Owns the buffers of kUnaligned frames, which must outlive the frames.
+class FrameFactory {
+ public:
+  ImageFrame Make(ImageFormat format, int width, int height, Layout layout) {
+    if (layout == Layout::kAligned) return ImageFrame(format, width, height);
+    const int depth = ByteDepthForFormat(format);
+    const int width_step =
+        (width * NumberOfChannelsForFormat(format) + 3) * depth;
+    buffers_.push_back(std::make_unique<uint8_t[]>(
+        64 + depth + static_cast<size_t>(width_step) * height));
+    uint8_t* data = buffers_.back().get();
+    data += 64 - reinterpret_cast<uintptr_t>(data) % 64 + depth;
+    std::memset(data, kPadding, static_cast<size_t>(width_step) * height);
+    return ImageFrame(format, width, height, width_step, data,
+                      ImageFrame::PixelDataDeleterNone);
+  }
+
+  // A frame with pixels that differ from row to row and column to column.
+  ImageFrame MakeFilled(ImageFormat format, int width, int height,
+                        Layout layout) {
+    ImageFrame frame = Make(format, width, height, layout);
+    for (int y = 0; y < height; ++y) {
+      uint8_t* row = frame.MutableRow(y);
+      for (int i = 0; i < frame.RowBytes(); ++i) {
+        row[i] = static_cast<uint8_t>(i * 37 + y * 101 + (i >> 3));
+      }
+    }
+    return frame;
+  }
+
+ private:
+  std::vector<std::unique_ptr<uint8_t[]>> buffers_;
+};
+
+void ExpectSameFrames(const ImageFrame& expected, const ImageFrame& actual) {
+  ASSERT_EQ(expected.Format(), actual.Format());
+  ASSERT_EQ(expected.Width(), actual.Width());
+  ASSERT_EQ(expected.Height(), actual.Height());
+  for (int y = 0; y < expected.Height(); ++y) {
+    EXPECT_EQ(std::memcmp(expected.Row(y), actual.Row(y), expected.RowBytes()),
+              0)
+        << "row " << y;
+  }
+}
+
+// Expects the padding of a kUnaligned frame untouched, so that kernels
+// writing past the end of a row are caught.
+void ExpectPaddingIntact(const ImageFrame& frame) {
+  for (int y = 0; y < frame.Height(); ++y) {
+    for (int i = frame.RowBytes(); i < frame.WidthStep(); ++i) {
+      ASSERT_EQ(frame.Row(y)[i], kPadding) << "row " << y << ", byte " << i;
+    }
+  }
+}
+
+class ImageFrameOpsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    for (SimdLevel level : {SimdLevel::kSse4, SimdLevel::kAvx2}) {
+      if (SetSimdLevel(level) == level) simd_levels_.push_back(level);
+    }
+    if (simd_levels_.empty()) GTEST_SKIP() << "No SIMD kernels on this CPU.";
+  }
+  void TearDown() override { SetSimdLevel(previous_level_); }
+
+  // Runs op at every level, writing to an output made with layout each
+  // time, and compares the output with the scalar one.
+  template <typename Op>
+  void ExpectSameAtAllLevels(ImageFormat output_format, int width,
+                             int height, Layout layout, Op op) {
+    SetSimdLevel(SimdLevel::kScalar);
+    ImageFrame expected = factory_.Make(output_format, width, height, layout);
+    ASSERT_TRUE(op(&expected).ok());
+    for (SimdLevel level : simd_levels_) {
+      SCOPED_TRACE(absl::StrCat("SIMD level ", static_cast<int>(level)));
+      SetSimdLevel(level);
+      ImageFrame actual = factory_.Make(output_format, width, height, layout);
+      ASSERT_TRUE(op(&actual).ok());
+      ExpectSameFrames(expected, actual);
+      if (layout == Layout::kUnaligned) ExpectPaddingIntact(actual);
+    }
+  }
+
+  const SimdLevel previous_level_ = GetSimdLevel();
+  std::vector<SimdLevel> simd_levels_;
+  FrameFactory factory_;
+};
+
+TEST_F(ImageFrameOpsTest, ConvertMatchesScalar) {
+  for (Layout layout : {Layout::kAligned, Layout::kUnaligned}) {
+    for (int width : kWidths) {
+      for (ImageFormat from : k8BitFormats) {
+        for (ImageFormat to : k8BitFormats) {
+          if (from == to) continue;
+          SCOPED_TRACE(absl::StrCat(ImageFormatName(from), " to ",
+                                    ImageFormatName(to), ", width ", width,
+                                    ", layout ", static_cast<int>(layout)));
+          const ImageFrame input =
+              factory_.MakeFilled(from, width, kHeight, layout);
+          ExpectSameAtAllLevels(to, width, kHeight, layout,
+                                [&](ImageFrame* output) {
+                                  return ConvertImageFrame(input, to, output);
+                                });
+        }
+      }
+    }
+  }
+}
+
+TEST_F(ImageFrameOpsTest, ResizeMatchesScalar) {
+  for (Layout layout : {Layout::kAligned, Layout::kUnaligned}) {
+    for (int width : kWidths) {
+      for (ImageFormat format : k8BitFormats) {
+        const ImageFrame input =
+            factory_.MakeFilled(format, width, kHeight, layout);
+        // Down, up, and to the odd widths around the vector sizes.
+        for (int output_width : {1, width / 2 + 1, 2 * width + 1, 17, 33}) {
+          SCOPED_TRACE(absl::StrCat(ImageFormatName(format), " ", width,
+                                    " to ", output_width, ", layout ",
+                                    static_cast<int>(layout)));
+          ExpectSameAtAllLevels(
+              format, output_width, 2 * kHeight + 1, layout,
+              [&](ImageFrame* output) {
+                return ResizeImageFrame(input, output_width, 2 * kHeight + 1,
+                                        output);
+              });
+        }
+      }
+    }
+  }
+}
+
+TEST_F(ImageFrameOpsTest, NormalizeMatchesScalar) {
+  const ImageFormat kFloatFormats[] = {ImageFormat::kVec32f3,
+                                       ImageFormat::kVec32f4,
+                                       ImageFormat::kVec32f1};
+  for (Layout layout : {Layout::kAligned, Layout::kUnaligned}) {
+    for (int width : kWidths) {
+      for (int i = 0; i < 3; ++i) {
+        SCOPED_TRACE(absl::StrCat(ImageFormatName(k8BitFormats[i]),
+                                  ", width ", width, ", layout ",
+                                  static_cast<int>(layout)));
+        const ImageFrame input =
+            factory_.MakeFilled(k8BitFormats[i], width, kHeight, layout);
+        ExpectSameAtAllLevels(kFloatFormats[i], width, kHeight, layout,
+                              [&](ImageFrame* output) {
+                                return NormalizeImageFrame(input, 2 / 255.0f,
+                                                           -1, output);
+                              });
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,55 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/image_frame.h"
+
+#include <cstring>
+
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(ImageFrameTest, CopyFromCopiesPixels) {
+  ImageFrame source(ImageFormat::kSrgb, 5, 3);
+  for (int y = 0; y < 3; ++y) std::memset(source.MutableRow(y), y + 1, 15);
+  ImageFrame copy;
+  copy.CopyFrom(source);
+  ASSERT_EQ(copy.Format(), ImageFormat::kSrgb);
+  ASSERT_EQ(copy.Width(), 5);
+  ASSERT_EQ(copy.Height(), 3);
+  for (int y = 0; y < 3; ++y) {
+    EXPECT_EQ(std::memcmp(copy.Row(y), source.Row(y), 15), 0);
+  }
+}
+
+TEST(ImageFrameTest, CopyFromEmptyEmpties) {
+  ImageFrame copy(ImageFormat::kGray8, 4, 4);
+  copy.CopyFrom(ImageFrame());
+  EXPECT_TRUE(copy.IsEmpty());
+}
+
+TEST(ImageFrameTest, GetMutableCopiesSharedEmptyFrame) {
+  Packet packet = MakePacket<ImageFrame>();
+  Packet shared = packet;
+  bool copied = false;
+  ImageFrame* frame = shared.GetMutable<ImageFrame>(&copied);
+  EXPECT_TRUE(copied);
+  EXPECT_TRUE(frame->IsEmpty());
+  EXPECT_NE(frame, &packet.Get<ImageFrame>());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,86 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/tensor.h"
+
+#include <cstring>
+#include <utility>
+
+#include "mediapipe/framework/type_map.h"
+
+namespace mediapipe {
+
+    int Tensor::Shape::num_elements() const {
+      int num_elements = 1;
+      for (int dim : dims) num_elements *= dim;
+      return num_elements;
+    }
+
+    size_t Tensor::ElementSize(ElementType type) {
+      switch (type) {
+        case ElementType::kFloat32:
+        case ElementType::kInt32:
+          return 4;
+        case ElementType::kUInt8:
+        case ElementType::kInt8:
+          return 1;
+        case ElementType::kNone:
+          break;
+      }
+      return 0;
+    }
+
+    absl::string_view Tensor::ElementTypeName(ElementType type) {
+      switch (type) {
+        case ElementType::kFloat32:
+          return "FLOAT32";
+        case ElementType::kInt32:
+          return "INT32";
+        case ElementType::kUInt8:
+          return "UINT8";
+        case ElementType::kInt8:
+          return "INT8";
+        case ElementType::kNone:
+          break;
+      }
+      return "NONE";
+    }
+
+    Tensor::Tensor(ElementType element_type, Shape shape, BufferPool* pool)
+        : element_type_(element_type), shape_(std::move(shape)) {
+      ABSL_CHECK(element_type_ != ElementType::kNone);
+      for (int dim : shape_.dims) ABSL_CHECK_GT(dim, 0);
+      num_elements_ = shape_.num_elements();
+      const size_t bytes = num_elements_ * ElementSize(element_type_);
+      buffer_ = pool != nullptr ? pool->Acquire(bytes)
+                                : BufferPool::AcquireUnpooled(bytes);
+    }
+
+    void Tensor::CopyFrom(const Tensor& tensor, BufferPool* pool) {
+      if (tensor.IsEmpty()) {
+        *this = Tensor();
+        return;
+      }
+      if (IsEmpty() || element_type_ != tensor.element_type_ ||
+          shape_ != tensor.shape_) {
+        *this = Tensor(tensor.element_type_, tensor.shape_, pool);
+      }
+      std::memcpy(buffer_.data(), tensor.buffer_.data(), bytes());
+    }
+
+    void Tensor::SetToZero() { std::memset(buffer_.data(), 0, bytes()); }
+
+}  // namespace mediapipe
+
+MEDIAPIPE_REGISTER_TYPE(::mediapipe::Tensor, "::mediapipe::Tensor");
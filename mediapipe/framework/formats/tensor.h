@@ -0,0 +1,135 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Tensor: a dense, row-major CPU array, e.g. a model input or output.
+
+#ifndef CUSTOM_MEDIAPIPE_FORMATS_TENSOR_H
+#define CUSTOM_MEDIAPIPE_FORMATS_TENSOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <type_traits>
+
+#include "absl/container/inlined_vector.h"
+#include "absl/log/absl_check.h"
+#include "absl/strings/string_view.h"
+#include "mediapipe/framework/buffer_pool.h"
+
+namespace mediapipe {
+    // A tensor of elements of one type, stored contiguously in row-major
+    // order, starting on a BufferPool::kAlignment boundary. A 2-D tensor is a
+    // matrix.
+    //
+    // Tensors take their storage from a BufferPool, normally the graph's:
+    //
+    //   Tensor tensor(Tensor::ElementType::kFloat32, {1, 224, 224, 3},
+    //                 &cc->GetBufferPool());
+    //
+    // so that the tensors of one frame reuse the memory of the tensors of an
+    // earlier one. Neither a Tensor nor its shape allocate memory otherwise,
+    // for tensors of up to kInlineDims dimensions.
+    //
+    // Tensors are movable but not copyable; use CopyFrom() to copy elements.
+    class Tensor {
+      public:
+        enum class ElementType { kNone, kFloat32, kInt32, kUInt8, kInt8 };
+
+        // Dimensions stored without allocating.
+        static constexpr int kInlineDims = 4;
+
+        struct Shape {
+          Shape() = default;
+          Shape(std::initializer_list<int> dimensions) : dims(dimensions) {}
+
+          int num_elements() const;
+          bool operator==(const Shape& other) const {
+            return dims == other.dims;
+          }
+          bool operator!=(const Shape& other) const {
+            return dims != other.dims;
+          }
+
+          absl::InlinedVector<int, kInlineDims> dims;
+        };
+
+        static size_t ElementSize(ElementType type);
+        static absl::string_view ElementTypeName(ElementType type);
+
+        // An empty tensor.
+        Tensor() = default;
+        // Allocates uninitialized elements from pool, or from the heap if pool
+        // is null. Dimensions must be positive.
+        Tensor(ElementType element_type, Shape shape, BufferPool* pool);
+        Tensor(Tensor&& other) = default;
+        Tensor& operator=(Tensor&& other) = default;
+        Tensor(const Tensor&) = delete;
+        Tensor& operator=(const Tensor&) = delete;
+
+        bool IsEmpty() const { return buffer_.empty(); }
+        ElementType element_type() const { return element_type_; }
+        const Shape& shape() const { return shape_; }
+        int num_elements() const { return num_elements_; }
+        size_t bytes() const { return buffer_.size(); }
+
+        // The elements, as T, which must match element_type().
+        template <typename T>
+        const T* data() const {
+          CheckType<T>();
+          return reinterpret_cast<const T*>(buffer_.data());
+        }
+        template <typename T>
+        T* mutable_data() {
+          CheckType<T>();
+          return reinterpret_cast<T*>(buffer_.data());
+        }
+        const uint8_t* raw_data() const { return buffer_.data(); }
+        uint8_t* mutable_raw_data() { return buffer_.data(); }
+
+        // Allocates like tensor, from pool, and copies its elements.
+        void CopyFrom(const Tensor& tensor, BufferPool* pool);
+        // Same, from the pool tensor's storage came from. Lets packets copy
+        // a shared Tensor on write; see Packet::GetMutable().
+        void CopyFrom(const Tensor& tensor) {
+          CopyFrom(tensor, tensor.buffer_.pool());
+        }
+        void SetToZero();
+
+      private:
+        template <typename T>
+        static constexpr ElementType ElementTypeOf() {
+          if constexpr (std::is_same_v<T, float>) return ElementType::kFloat32;
+          if constexpr (std::is_same_v<T, int32_t>) return ElementType::kInt32;
+          if constexpr (std::is_same_v<T, uint8_t>) return ElementType::kUInt8;
+          if constexpr (std::is_same_v<T, int8_t>) return ElementType::kInt8;
+          return ElementType::kNone;
+        }
+
+        template <typename T>
+        void CheckType() const {
+          static_assert(ElementTypeOf<T>() != ElementType::kNone,
+                        "Not a tensor element type");
+          ABSL_CHECK(ElementTypeOf<T>() == element_type_)
+              << "Tensor of " << ElementTypeName(element_type_)
+              << " accessed as " << ElementTypeName(ElementTypeOf<T>()) << ".";
+        }
+
+        ElementType element_type_ = ElementType::kNone;
+        Shape shape_;
+        int num_elements_ = 0;
+        BufferPool::Buffer buffer_;
+    };
+}  // namespace mediapipe
+
+#endif  // CUSTOM_MEDIAPIPE_FORMATS_TENSOR_H
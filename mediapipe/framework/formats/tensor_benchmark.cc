@@ -0,0 +1,65 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// The tensors of one frame of a CPU inference pipeline, from a BufferPool or
+// from the heap, alone and from several threads at once.
+
+#include <memory>
+
+#include "mediapipe/framework/buffer_pool.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/benchmark.h"
+
+namespace mediapipe {
+namespace {
+
+// An input tensor the size of state.range(0) x state.range(0) RGB, copied
+// for a second model, and a classifier output.
+void RunFrame(benchmark::State& state, BufferPool* pool) {
+  const int size = static_cast<int>(state.range(0));
+  Tensor input(Tensor::ElementType::kFloat32, {1, size, size, 3}, pool);
+  input.mutable_data<float>()[0] = 1;
+  Tensor copy;
+  copy.CopyFrom(input);
+  Tensor output(Tensor::ElementType::kFloat32, {1, 1001}, pool);
+  output.mutable_data<float>()[0] = copy.data<float>()[0];
+  benchmark::DoNotOptimize(output.raw_data());
+}
+
+std::shared_ptr<BufferPool> shared_pool = BufferPool::Create();
+
+void BM_TensorFrame(benchmark::State& state, bool pooled) {
+  BufferPool* pool = pooled ? shared_pool.get() : nullptr;
+  for (auto _ : state) RunFrame(state, pool);
+  state.SetItemsProcessed(state.iterations());
+  if (pooled && state.thread_index() == 0) {
+    CounterSet* counters = shared_pool->GetCounterSet();
+    const double hits = counters->Get("BufferPool/hits")->Get();
+    const double misses = counters->Get("BufferPool/misses")->Get();
+    state.counters["hit_rate"] = hits / (hits + misses);
+  }
+}
+BENCHMARK_CAPTURE(BM_TensorFrame, Heap, false)
+    ->Arg(224)
+    ->Arg(512)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(BM_TensorFrame, Pooled, true)
+    ->Arg(224)
+    ->Arg(512)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace mediapipe
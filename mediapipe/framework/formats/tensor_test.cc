@@ -0,0 +1,106 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/tensor.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+#include "mediapipe/framework/buffer_pool.h"
+#include "mediapipe/framework/port/gtest.h"
+
+// Counts every allocation of the test binary. Only the operators the test
+// relies on are replaced; the others forward to them.
+namespace {
+std::atomic<int64_t> num_allocations{0};
+}  // namespace
+
+void* operator new(size_t size) {
+  num_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size == 0 ? 1 : size)) return p;
+  throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+  num_allocations.fetch_add(1, std::memory_order_relaxed);
+  const size_t align = static_cast<size_t>(alignment);
+  // aligned_alloc() needs a multiple of the alignment.
+  if (void* p = std::aligned_alloc(align, (size + align - 1) / align * align)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+namespace mediapipe {
+namespace {
+
+constexpr int kWarmUpFrames = 3;
+constexpr int kFrames = 30;
+
+// One frame of a CPU inference pipeline: an input tensor is filled, copied
+// for a second model, and an output tensor is produced.
+void RunFrame(BufferPool* pool) {
+  Tensor input(Tensor::ElementType::kFloat32, {1, 224, 224, 3}, pool);
+  input.SetToZero();
+  Tensor copy;
+  copy.CopyFrom(input);
+  Tensor output(Tensor::ElementType::kFloat32, {1, 1001}, pool);
+  output.mutable_data<float>()[0] = copy.data<float>()[0];
+}
+
+int64_t CounterValue(BufferPool* pool, const char* name) {
+  return pool->GetCounterSet()->Get(name)->Get();
+}
+
+TEST(TensorTest, SteadyStateFramesDoNotAllocate) {
+  std::shared_ptr<BufferPool> pool = BufferPool::Create();
+  for (int i = 0; i < kWarmUpFrames; ++i) RunFrame(pool.get());
+  const int64_t misses = CounterValue(pool.get(), "BufferPool/misses");
+  const int64_t hits = CounterValue(pool.get(), "BufferPool/hits");
+
+  const int64_t allocations_before = num_allocations.load();
+  for (int i = 0; i < kFrames; ++i) RunFrame(pool.get());
+  const int64_t allocations_after = num_allocations.load();
+
+  EXPECT_EQ(allocations_after, allocations_before);
+  EXPECT_EQ(CounterValue(pool.get(), "BufferPool/misses"), misses);
+  EXPECT_EQ(CounterValue(pool.get(), "BufferPool/hits"), hits + 3 * kFrames);
+}
+
+TEST(TensorTest, UnpooledTensorsAllocateEveryFrame) {
+  const int64_t allocations_before = num_allocations.load();
+  for (int i = 0; i < kFrames; ++i) RunFrame(nullptr);
+  EXPECT_GE(num_allocations.load() - allocations_before, 3 * kFrames);
+}
+
+TEST(TensorTest, TrimFreesAllBytesHeld) {
+  std::shared_ptr<BufferPool> pool = BufferPool::Create();
+  RunFrame(pool.get());
+  EXPECT_GT(CounterValue(pool.get(), "BufferPool/bytes_held"), 0);
+  pool->Trim();
+  EXPECT_EQ(CounterValue(pool.get(), "BufferPool/bytes_held"), 0);
+}
+
+}  // namespace
+}  // namespace mediapipe
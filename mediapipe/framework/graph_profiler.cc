@@ -0,0 +1,229 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/graph_profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+
+#include "absl/log/absl_check.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+
+namespace mediapipe {
+    namespace {
+
+    constexpr int kDefaultTraceBufferSize = 16384;
+    constexpr const char* kEventNames[] = {"Open", "Process", "Close"};
+    constexpr const char* kHistogramNames[] = {"open_time_us", "process_time_us",
+                                               "close_time_us"};
+
+    std::atomic<uint64_t> next_profiler_id{1};
+
+    size_t RoundUpToPowerOfTwo(size_t n) {
+      size_t result = 1;
+      while (result < n) result <<= 1;
+      return result;
+    }
+
+    void AppendJsonString(absl::string_view value, std::string* out) {
+      out->push_back('"');
+      for (char c : value) {
+        if (c == '"' || c == '\\') {
+          out->push_back('\\');
+          out->push_back(c);
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+          absl::StrAppendFormat(out, "\\u%04x", c);
+        } else {
+          out->push_back(c);
+        }
+      }
+      out->push_back('"');
+    }
+
+    }  // namespace
+
+    // A ring of the most recent calls of one thread. Only that thread writes
+    // to it; any thread may read it. Every slot is a seqlock, so a reader
+    // detects and skips a slot that is overwritten while it copies it.
+    class GraphProfiler::TraceBuffer {
+      public:
+        TraceBuffer(size_t size, int thread_id)
+            : mask_(size - 1), slots_(new Slot[size]), thread_id_(thread_id) {}
+
+        void Write(const TraceEvent& event) {
+          const uint64_t index = written_.load(std::memory_order_relaxed);
+          Slot& slot = slots_[index & mask_];
+          slot.sequence.store(0, std::memory_order_relaxed);
+          std::atomic_thread_fence(std::memory_order_release);
+          slot.start_ns.store(event.start_ns, std::memory_order_relaxed);
+          slot.end_ns.store(event.end_ns, std::memory_order_relaxed);
+          slot.input_timestamp.store(event.input_timestamp.Value(),
+                                     std::memory_order_relaxed);
+          slot.node_and_type.store(
+              (static_cast<int64_t>(event.node_id) << 8) | event.type,
+              std::memory_order_relaxed);
+          slot.sequence.store(index + 1, std::memory_order_release);
+          written_.store(index + 1, std::memory_order_release);
+        }
+
+        void Read(std::vector<TraceEvent>* events) const {
+          const uint64_t written = written_.load(std::memory_order_acquire);
+          const uint64_t size = mask_ + 1;
+          for (uint64_t index = written > size ? written - size : 0;
+               index < written; ++index) {
+            const Slot& slot = slots_[index & mask_];
+            if (slot.sequence.load(std::memory_order_acquire) != index + 1) {
+              continue;
+            }
+            TraceEvent event;
+            event.start_ns = slot.start_ns.load(std::memory_order_relaxed);
+            event.end_ns = slot.end_ns.load(std::memory_order_relaxed);
+            event.input_timestamp =
+                Timestamp(slot.input_timestamp.load(std::memory_order_relaxed));
+            const int64_t node_and_type =
+                slot.node_and_type.load(std::memory_order_relaxed);
+            event.node_id = static_cast<int>(node_and_type >> 8);
+            event.type = static_cast<TraceEvent::Type>(node_and_type & 0xff);
+            event.thread_id = thread_id_;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != index + 1) {
+              continue;
+            }
+            events->push_back(event);
+          }
+        }
+
+      private:
+        // The call at index i is complete when sequence is i + 1.
+        struct Slot {
+          std::atomic<uint64_t> sequence{0};
+          std::atomic<int64_t> start_ns{0};
+          std::atomic<int64_t> end_ns{0};
+          std::atomic<int64_t> input_timestamp{0};
+          std::atomic<int64_t> node_and_type{0};
+        };
+
+        const uint64_t mask_;
+        const std::unique_ptr<Slot[]> slots_;
+        const int thread_id_;
+        std::atomic<uint64_t> written_{0};
+    };
+
+    GraphProfiler::GraphProfiler(const ProfilerConfig& config,
+                                 CounterFactory* counter_factory)
+        : config_(config),
+          enabled_(config.enabled()),
+          sample_every_n_(std::max(1, config.sample_every_n())),
+          buffer_size_(RoundUpToPowerOfTwo(config.trace_buffer_size() > 0
+                                               ? config.trace_buffer_size()
+                                               : kDefaultTraceBufferSize)),
+          id_(next_profiler_id.fetch_add(1, std::memory_order_relaxed)),
+          origin_(std::chrono::steady_clock::now()),
+          counter_factory_(counter_factory) {}
+
+    GraphProfiler::~GraphProfiler() = default;
+
+    void GraphProfiler::AddNode(int node_id, absl::string_view node_name) {
+      ABSL_CHECK_EQ(node_id, static_cast<int>(nodes_.size()));
+      NodeStats stats;
+      stats.name = std::string(node_name);
+      for (int type = 0; type < 3; ++type) {
+        stats.times[type] =
+            enabled_ ? counter_factory_->GetHistogram(absl::StrCat(
+                           "Node/", node_name, "/", kHistogramNames[type]))
+                     : nullptr;
+      }
+      nodes_.push_back(std::move(stats));
+    }
+
+    void GraphProfiler::Record(int node_id, TraceEvent::Type type,
+                               Timestamp input_timestamp, int64_t start) {
+      TraceEvent event;
+      event.node_id = node_id;
+      event.type = type;
+      event.input_timestamp = input_timestamp;
+      event.start_ns = start;
+      event.end_ns = NowNanos();
+      nodes_[node_id].times[type]->Record((event.end_ns - start) / 1000);
+      ThisThreadBuffer()->Write(event);
+    }
+
+    GraphProfiler::TraceBuffer* GraphProfiler::ThisThreadBuffer() {
+      // Worker threads belong to one graph, so this rarely misses.
+      struct CachedBuffer {
+        uint64_t profiler_id = 0;
+        TraceBuffer* buffer = nullptr;
+      };
+      thread_local CachedBuffer cached;
+      if (ABSL_PREDICT_TRUE(cached.profiler_id == id_)) return cached.buffer;
+      absl::MutexLock lock(&buffers_mu_);
+      std::unique_ptr<TraceBuffer>& buffer =
+          buffers_[std::this_thread::get_id()];
+      if (buffer == nullptr) {
+        buffer = std::make_unique<TraceBuffer>(
+            buffer_size_, static_cast<int>(buffers_.size()) - 1);
+      }
+      cached = {id_, buffer.get()};
+      return buffer.get();
+    }
+
+    std::vector<TraceEvent> GraphProfiler::CollectTrace() const {
+      std::vector<TraceEvent> events;
+      {
+        absl::MutexLock lock(&buffers_mu_);
+        for (const auto& entry : buffers_) entry.second->Read(&events);
+      }
+      std::sort(events.begin(), events.end(),
+                [](const TraceEvent& a, const TraceEvent& b) {
+                  return a.start_ns < b.start_ns;
+                });
+      return events;
+    }
+
+    absl::Status GraphProfiler::WriteChromeTrace(const std::string& path) const {
+      std::string json = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+      bool first = true;
+      for (const TraceEvent& event : CollectTrace()) {
+        if (!first) json.push_back(',');
+        first = false;
+        json += "\n{\"name\":";
+        AppendJsonString(nodes_[event.node_id].name, &json);
+        absl::StrAppendFormat(
+            &json,
+            ",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,"
+            "\"dur\":%.3f,\"args\":{\"input_timestamp\":",
+            kEventNames[event.type], event.thread_id, event.start_ns / 1e3,
+            (event.end_ns - event.start_ns) / 1e3);
+        AppendJsonString(event.input_timestamp.DebugString(), &json);
+        json += "}}";
+      }
+      json += "\n]}\n";
+
+      std::ofstream file(path, std::ios::trunc);
+      if (!file) {
+        return absl::UnavailableError(
+            absl::StrCat("Failed to open trace file \"", path, "\"."));
+      }
+      file << json;
+      file.close();
+      if (!file) {
+        return absl::UnavailableError(
+            absl::StrCat("Failed to write trace file \"", path, "\"."));
+      }
+      return absl::OkStatus();
+    }
+
+}  // namespace mediapipe
@@ -0,0 +1,161 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Timing of the calculator calls of a graph, as latency histograms and as a
+// trace that can be viewed in chrome://tracing.
+
+#ifndef CUSTOM_MEDIAPIPE_GRAPH_PROFILER_H
+#define CUSTOM_MEDIAPIPE_GRAPH_PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/base/optimization.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/counter_factory.h"
+#include "mediapipe/framework/histogram.h"
+#include "mediapipe/framework/timestamp.h"
+
+namespace mediapipe {
+    // One recorded calculator call.
+    struct TraceEvent {
+      enum Type : uint8_t { kOpen, kProcess, kClose };
+
+      int node_id = 0;
+      Type type = kProcess;
+      // Of the first item of a batch.
+      Timestamp input_timestamp;
+      // Nanoseconds since the profiler was created.
+      int64_t start_ns = 0;
+      int64_t end_ns = 0;
+      // Numbers the threads of the graph from 0, in order of their first
+      // recorded call.
+      int thread_id = 0;
+    };
+
+    // Records the Open(), Process() and Close() calls of the nodes of a graph,
+    // as configured by CalculatorGraphConfig.profiler_config. For every node,
+    // the durations of the recorded calls go to the histograms
+    //   Node/<node>/open_time_us
+    //   Node/<node>/process_time_us
+    //   Node/<node>/close_time_us
+    // of the graph's counter factory. The calls themselves go to a ring buffer
+    // of the calling thread, from which CollectTrace() and WriteChromeTrace()
+    // read the most recent ones.
+    //
+    // Recording takes no lock and does not allocate, except for the first call
+    // on a thread. A disabled profiler costs one predictable branch per call.
+    //
+    // Usage, around a call:
+    //   int64_t start = profiler->StartEvent(TraceEvent::kProcess);
+    //   status = calculator->Process(cc);
+    //   profiler->EndEvent(node_id, TraceEvent::kProcess, timestamp, start);
+    //
+    // This class is thread safe.
+    class GraphProfiler {
+      public:
+        GraphProfiler(const ProfilerConfig& config,
+                      CounterFactory* counter_factory);
+        GraphProfiler(const GraphProfiler&) = delete;
+        GraphProfiler& operator=(const GraphProfiler&) = delete;
+        ~GraphProfiler();
+
+        bool IsEnabled() const { return enabled_; }
+        // Whether packets carry their ingestion time; see
+        // ProfilerConfig.trace_packet_latency.
+        bool TracesPacketLatency() const {
+          return config_.trace_packet_latency();
+        }
+        const ProfilerConfig& Config() const { return config_; }
+
+        // Registers node node_id, which must be the next id, from 0. Not
+        // thread safe; call while the graph is initialized.
+        void AddNode(int node_id, absl::string_view node_name);
+
+        // Returns the start time of a call of the given type, or -1 if the
+        // call is not to be recorded.
+        int64_t StartEvent(TraceEvent::Type type) {
+          if (ABSL_PREDICT_TRUE(!enabled_)) return -1;
+          if (type == TraceEvent::kProcess && sample_every_n_ > 1) {
+            // Random rather than every n-th call, which would pick the same
+            // nodes over and over when nodes take turns on a thread.
+            thread_local uint32_t random = 2463534242u;
+            random ^= random << 13;
+            random ^= random >> 17;
+            random ^= random << 5;
+            if (random % sample_every_n_ != 0) return -1;
+          }
+          return NowNanos();
+        }
+
+        // Records the call that StartEvent() returned start for.
+        void EndEvent(int node_id, TraceEvent::Type type,
+                      Timestamp input_timestamp, int64_t start) {
+          if (start >= 0) Record(node_id, type, input_timestamp, start);
+        }
+
+        // Returns the recorded calls still in the buffers, ordered by start
+        // time. Calls that are overwritten while copying are left out.
+        std::vector<TraceEvent> CollectTrace() const
+            ABSL_LOCKS_EXCLUDED(buffers_mu_);
+
+        // Writes CollectTrace() as a Chrome trace event JSON file: one
+        // complete event per call, on a track per thread, named after the node
+        // and carrying the input timestamp.
+        absl::Status WriteChromeTrace(const std::string& path) const;
+
+      private:
+        class TraceBuffer;
+        struct NodeStats {
+          std::string name;
+          Histogram* times[3];
+        };
+
+        int64_t NowNanos() const {
+          return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now() - origin_)
+              .count();
+        }
+
+        void Record(int node_id, TraceEvent::Type type,
+                    Timestamp input_timestamp, int64_t start);
+        TraceBuffer* ThisThreadBuffer() ABSL_LOCKS_EXCLUDED(buffers_mu_);
+
+        const ProfilerConfig config_;
+        const bool enabled_;
+        const uint32_t sample_every_n_;
+        const size_t buffer_size_;
+        // Identifies the profiler in the threads' buffer caches.
+        const uint64_t id_;
+        const std::chrono::steady_clock::time_point origin_;
+        CounterFactory* const counter_factory_;
+        // By node id.
+        std::vector<NodeStats> nodes_;
+
+        mutable absl::Mutex buffers_mu_;
+        absl::flat_hash_map<std::thread::id, std::unique_ptr<TraceBuffer>>
+            buffers_ ABSL_GUARDED_BY(buffers_mu_);
+    };
+}  // namespace mediapipe
+
+#endif  // CUSTOM_MEDIAPIPE_GRAPH_PROFILER_H
@@ -0,0 +1,108 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// The cost of profiling with the profiler off, sampling one in 10 Process()
+// calls, and recording every call: per profiled call, and in frames per
+// second through a chain of 10 PassThroughCalculators.
+
+#include <cstdint>
+#include <string>
+
+#include "absl/log/absl_check.h"
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_graph.h"
+#include "mediapipe/framework/counter_factory.h"
+#include "mediapipe/framework/graph_profiler.h"
+#include "mediapipe/framework/port/benchmark.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kChainLength = 10;
+constexpr int kNumFrames = 1000;
+
+enum ProfilerMode { kOff, kSampled, kFull };
+
+ProfilerConfig ProfilerConfigFor(ProfilerMode mode) {
+  ProfilerConfig config;
+  config.set_enabled(mode != kOff);
+  if (mode == kSampled) config.set_sample_every_n(10);
+  return config;
+}
+
+// What CalculatorNode does around every Process() call.
+void BM_ProfileCall(benchmark::State& state) {
+  BasicCounterFactory counters;
+  GraphProfiler profiler(
+      ProfilerConfigFor(static_cast<ProfilerMode>(state.range(0))), &counters);
+  profiler.AddNode(0, "node");
+  int64_t timestamp = 0;
+  for (auto _ : state) {
+    int64_t start = profiler.StartEvent(TraceEvent::kProcess);
+    profiler.EndEvent(0, TraceEvent::kProcess, Timestamp(timestamp++), start);
+  }
+}
+BENCHMARK(BM_ProfileCall)
+    ->ArgName("mode")
+    ->Arg(kOff)
+    ->Arg(kSampled)
+    ->Arg(kFull);
+
+CalculatorGraphConfig ChainConfig(ProfilerMode mode) {
+  CalculatorGraphConfig config;
+  config.set_num_threads(1);
+  config.add_input_stream("in");
+  std::string previous = "in";
+  for (int i = 1; i <= kChainLength; ++i) {
+    CalculatorGraphConfig::Node* node = config.add_node();
+    node->set_calculator("PassThroughCalculator");
+    node->add_input_stream(previous);
+    previous = absl::StrCat("pass_", i);
+    node->add_output_stream(previous);
+  }
+  *config.mutable_profiler_config() = ProfilerConfigFor(mode);
+  return config;
+}
+
+// Only sending the frames and draining the graph is timed.
+void BM_Profiler(benchmark::State& state) {
+  const CalculatorGraphConfig config =
+      ChainConfig(static_cast<ProfilerMode>(state.range(0)));
+  for (auto _ : state) {
+    state.PauseTiming();
+    CalculatorGraph graph;
+    ABSL_CHECK_OK(graph.Initialize(config));
+    ABSL_CHECK_OK(graph.StartRun());
+    state.ResumeTiming();
+    for (int i = 0; i < kNumFrames; ++i) {
+      ABSL_CHECK_OK(graph.AddPacketToInputStream(
+          "in", MakePacket<int>(i).At(Timestamp(i))));
+    }
+    ABSL_CHECK_OK(graph.CloseAllInputStreams());
+    ABSL_CHECK_OK(graph.WaitUntilDone());
+  }
+  state.SetItemsProcessed(state.iterations() * kNumFrames);
+}
+BENCHMARK(BM_Profiler)
+    ->ArgName("mode")
+    ->Arg(kOff)
+    ->Arg(kSampled)
+    ->Arg(kFull)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace mediapipe
@@ -1,19 +1,65 @@
+// Copyright 2019 The MediaPipe Authors.
 //
-// Created by MSD on 31/01/2025.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
 //
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Graph services are objects that the application shares with all
+// calculators of a graph, such as model caches or thread pools.
+
+#ifndef CUSTOM_MEDIAPIPE_GRAPH_SERVICE_H
+#define CUSTOM_MEDIAPIPE_GRAPH_SERVICE_H
+
+#include <cstdint>
+
+#include "absl/strings/string_view.h"
+#include "mediapipe/framework/tool/type_util.h"
+
+namespace mediapipe {
+    // The untyped part of a GraphService.
+    class GraphServiceBase {
+      public:
+        constexpr absl::string_view key() const { return key_; }
 
-#ifndef GRAPH_SERVICE_H
-#define GRAPH_SERVICE_H
+        // Identifies the service: a hash of its key and type, computed at
+        // compile time for services declared constexpr.
+        constexpr uint64_t id() const { return id_; }
 
-#include <memory>
-#include <type_traits>
-#include <utility>
+      protected:
+        constexpr GraphServiceBase(absl::string_view key, TypeId type_id)
+            : key_(key),
+              id_(type_util_internal::Fnv1a({key.data(), key.size()}) ^
+                  type_id.hash_value()) {}
 
-#include "absl/log/absl_check.h"
-#include "absl/strings/str_cat.h"
-#include "mediapipe/framework/packet.h"
-#include "mediapipe/framework/port/status.h"
+      private:
+        absl::string_view key_;
+        uint64_t id_;
+    };
 
+    // The key of a service holding a T. Declare keys as constants, e.g.
+    //
+    //   inline constexpr GraphService<ModelCache> kModelCacheService(
+    //       "mediapipe::ModelCacheService");
+    //
+    // and provide the object with CalculatorGraph::SetServiceObject() before
+    // the run starts. Calculators get it with CalculatorContext::Service().
+    // The key must outlive the service, which string literals do.
+    template <typename T>
+    class GraphService : public GraphServiceBase {
+      public:
+        using type = T;
 
+        constexpr explicit GraphService(absl::string_view key)
+            : GraphServiceBase(key, kTypeId<T>) {}
+    };
+}  // namespace mediapipe
 
-#endif //GRAPH_SERVICE_H
+#endif  // CUSTOM_MEDIAPIPE_GRAPH_SERVICE_H
@@ -0,0 +1,44 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/graph_service_manager.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace mediapipe {
+
+    absl::Status GraphServiceManager::SetServiceObjectInternal(
+        const GraphServiceBase& service, std::shared_ptr<void> object) {
+      if (frozen_) {
+        return absl::FailedPreconditionError(absl::StrCat(
+            "Service \"", service.key(),
+            "\" set after the graph started; services must be set before."));
+      }
+      auto it = std::lower_bound(
+          entries_.begin(), entries_.end(), service.id(),
+          [](const Entry& entry, uint64_t id) { return entry.id < id; });
+      if (it != entries_.end() && it->id == service.id()) {
+        if (it->key != service.key()) {
+          return absl::InvalidArgumentError(absl::StrCat(
+              "Services \"", it->key, "\" and \"", service.key(),
+              "\" have the same id; rename one of them."));
+        }
+        it->object = std::move(object);
+        return absl::OkStatus();
+      }
+      entries_.insert(it, Entry{service.id(), service.key(), std::move(object)});
+      return absl::OkStatus();
+    }
+
+}  // namespace mediapipe
@@ -0,0 +1,90 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CUSTOM_MEDIAPIPE_GRAPH_SERVICE_MANAGER_H
+#define CUSTOM_MEDIAPIPE_GRAPH_SERVICE_MANAGER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "mediapipe/framework/graph_service.h"
+
+namespace mediapipe {
+    // Holds the service objects of a graph. Objects are set while the graph
+    // is being set up; Freeze() then makes the manager immutable, so that
+    // lookups from any number of threads need no lock. A lookup is a binary
+    // search over a sorted array of service ids, usually a handful of
+    // entries that share one or two cache lines, followed by a comparison of
+    // the keys.
+    //
+    // SetServiceObject() and Freeze() are not thread safe. Lookups are thread
+    // safe once frozen, provided the freezing thread published the manager to
+    // the others, as starting the graph's workers does.
+    class GraphServiceManager {
+      public:
+        GraphServiceManager() = default;
+        GraphServiceManager(const GraphServiceManager&) = delete;
+        GraphServiceManager& operator=(const GraphServiceManager&) = delete;
+
+        // Sets or replaces the object of service. Fails once frozen.
+        template <typename T>
+        absl::Status SetServiceObject(const GraphService<T>& service,
+                                      std::shared_ptr<T> object) {
+          return SetServiceObjectInternal(service, std::move(object));
+        }
+
+        // Returns the object of service, or null if it is not set. The object
+        // lives at least as long as the manager.
+        template <typename T>
+        T* GetServiceObject(const GraphService<T>& service) const {
+          return static_cast<T*>(GetServiceObjectInternal(service));
+        }
+
+        void Freeze() { frozen_ = true; }
+        bool IsFrozen() const { return frozen_; }
+
+      private:
+        struct Entry {
+          uint64_t id;
+          absl::string_view key;
+          std::shared_ptr<void> object;
+        };
+
+        absl::Status SetServiceObjectInternal(const GraphServiceBase& service,
+                                              std::shared_ptr<void> object);
+
+        void* GetServiceObjectInternal(const GraphServiceBase& service) const {
+          auto it = std::lower_bound(
+              entries_.begin(), entries_.end(), service.id(),
+              [](const Entry& entry, uint64_t id) { return entry.id < id; });
+          // SetServiceObject() rejects ids that collide, but a service that
+          // was never set may still share its id with one that was.
+          return it != entries_.end() && it->id == service.id() &&
+                         it->key == service.key()
+                     ? it->object.get()
+                     : nullptr;
+        }
+
+        // Sorted by id.
+        std::vector<Entry> entries_;
+        bool frozen_ = false;
+    };
+}  // namespace mediapipe
+
+#endif  // CUSTOM_MEDIAPIPE_GRAPH_SERVICE_MANAGER_H
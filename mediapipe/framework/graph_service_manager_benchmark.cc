@@ -0,0 +1,98 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Service lookups from many threads at once, as calculators do in every
+// Process() call, against a mutex-guarded map.
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/log/absl_check.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/graph_service.h"
+#include "mediapipe/framework/graph_service_manager.h"
+#include "mediapipe/framework/port/benchmark.h"
+
+namespace mediapipe {
+namespace {
+
+inline constexpr GraphService<int> kServices[] = {
+    GraphService<int>("bench::Service0"), GraphService<int>("bench::Service1"),
+    GraphService<int>("bench::Service2"), GraphService<int>("bench::Service3"),
+    GraphService<int>("bench::Service4"), GraphService<int>("bench::Service5"),
+    GraphService<int>("bench::Service6"), GraphService<int>("bench::Service7"),
+};
+constexpr int kNumServices = sizeof(kServices) / sizeof(kServices[0]);
+
+// A frozen manager holding every service, shared by all threads.
+const GraphServiceManager& Manager() {
+  static const GraphServiceManager* manager = [] {
+    auto* manager = new GraphServiceManager;
+    for (int i = 0; i < kNumServices; ++i) {
+      ABSL_CHECK_OK(
+          manager->SetServiceObject(kServices[i], std::make_shared<int>(i)));
+    }
+    manager->Freeze();
+    return manager;
+  }();
+  return *manager;
+}
+
+// The baseline: services by key, behind a lock.
+class LockedServiceMap {
+ public:
+  LockedServiceMap() {
+    for (int i = 0; i < kNumServices; ++i) {
+      objects_[std::string(kServices[i].key())] = std::make_shared<int>(i);
+    }
+  }
+
+  int* Get(const GraphService<int>& service) {
+    absl::MutexLock lock(&mu_);
+    auto it = objects_.find(service.key());
+    return it == objects_.end() ? nullptr : it->second.get();
+  }
+
+ private:
+  absl::Mutex mu_;
+  std::map<std::string, std::shared_ptr<int>, std::less<>> objects_
+      ABSL_GUARDED_BY(mu_);
+};
+
+void BM_GetServiceObject(benchmark::State& state) {
+  const GraphServiceManager& manager = Manager();
+  int i = state.thread_index();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        manager.GetServiceObject(kServices[i++ % kNumServices]));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetServiceObject)->ThreadRange(1, 16)->UseRealTime();
+
+void BM_LockedLookup(benchmark::State& state) {
+  static LockedServiceMap* services = new LockedServiceMap;
+  int i = state.thread_index();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(services->Get(kServices[i++ % kNumServices]));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LockedLookup)->ThreadRange(1, 16)->UseRealTime();
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,72 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mediapipe {
+
+    void HistogramSnapshot::Merge(const HistogramSnapshot& other) {
+      if (other.count_ == 0) return;
+      count_ += other.count_;
+      sum_ += other.sum_;
+      min_ = std::min(min_, other.min_);
+      max_ = std::max(max_, other.max_);
+      for (int i = 0; i < HistogramBuckets::kNumBuckets; ++i) {
+        buckets_[i] += other.buckets_[i];
+      }
+    }
+
+    int64_t HistogramSnapshot::Percentile(double fraction) const {
+      if (count_ == 0) return 0;
+      fraction = std::clamp(fraction, 0.0, 1.0);
+      const int64_t rank = std::max<int64_t>(
+          1, static_cast<int64_t>(std::ceil(fraction * count_)));
+      int64_t seen = 0;
+      for (int i = 0; i < HistogramBuckets::kNumBuckets; ++i) {
+        seen += buckets_[i];
+        if (seen >= rank) {
+          return std::clamp(HistogramBuckets::UpperBound(i), min_, max_);
+        }
+      }
+      return max_;
+    }
+
+    Histogram::Histogram()
+        : num_shards_(std::min(NumThreadShards(), kMaxHistogramShards)),
+          shards_(new Shard[num_shards_]) {}
+
+    Histogram::~Histogram() {}
+
+    HistogramSnapshot Histogram::Snapshot() const {
+      HistogramSnapshot snapshot;
+      for (int i = 0; i < num_shards_; ++i) {
+        const Shard* shard = &shards_[i];
+        snapshot.count_ += shard->count.load(std::memory_order_relaxed);
+        snapshot.sum_ += shard->sum.load(std::memory_order_relaxed);
+        snapshot.min_ = std::min(snapshot.min_,
+                                 shard->min.load(std::memory_order_relaxed));
+        snapshot.max_ = std::max(snapshot.max_,
+                                 shard->max.load(std::memory_order_relaxed));
+        for (int b = 0; b < HistogramBuckets::kNumBuckets; ++b) {
+          snapshot.buckets_[b] +=
+              shard->buckets[b].load(std::memory_order_relaxed);
+        }
+      }
+      return snapshot;
+    }
+
+}  // namespace mediapipe
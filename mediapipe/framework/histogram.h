@@ -0,0 +1,175 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// A histogram metric for distributions such as Process() latency or input
+// queue depth. Histograms are registered and enumerated through CounterSet
+// alongside ordinary counters.
+
+#ifndef CUSTOM_MEDIAPIPE_HISTOGRAM_H
+#define CUSTOM_MEDIAPIPE_HISTOGRAM_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "mediapipe/framework/deps/thread_shard.h"
+
+namespace mediapipe {
+    // Maps non-negative int64 values onto log-linear buckets, in the style of
+    // HdrHistogram. Values below kSubBuckets get one exact bucket each; every
+    // power of two above that is split into kSubBuckets / 2 linear buckets, so
+    // the relative error of any reported value is below 2 / kSubBuckets.
+    class HistogramBuckets {
+      public:
+        static constexpr int kSubBucketBits = 5;
+        static constexpr int kSubBuckets = 1 << kSubBucketBits;
+        static constexpr int kHalfSubBuckets = kSubBuckets / 2;
+        static constexpr int kNumBuckets =
+            (64 - kSubBucketBits) * kHalfSubBuckets + kSubBuckets;
+
+        // Returns the bucket index of value. Negative values map to bucket 0.
+        static int Index(int64_t value) {
+          if (value < kSubBuckets) return value < 0 ? 0 : static_cast<int>(value);
+          const int shift = 63 - __builtin_clzll(static_cast<uint64_t>(value)) -
+                            (kSubBucketBits - 1);
+          return shift * kHalfSubBuckets + static_cast<int>(value >> shift);
+        }
+
+        // Returns the smallest value mapped to bucket index.
+        static int64_t LowerBound(int index) {
+          if (index < kSubBuckets) return index;
+          const int shift = index / kHalfSubBuckets - 1;
+          return static_cast<int64_t>(index - shift * kHalfSubBuckets) << shift;
+        }
+
+        // Returns the largest value mapped to bucket index.
+        static int64_t UpperBound(int index) {
+          if (index < kSubBuckets) return index;
+          const int shift = index / kHalfSubBuckets - 1;
+          return LowerBound(index) + ((int64_t{1} << shift) - 1);
+        }
+    };
+
+    // A point-in-time copy of a Histogram. Snapshots are plain values: they can
+    // be merged (e.g. across nodes or graph runs) and queried for percentiles.
+    class HistogramSnapshot {
+      public:
+        HistogramSnapshot() : buckets_(HistogramBuckets::kNumBuckets, 0) {}
+
+        // Adds the samples of other to this snapshot.
+        void Merge(const HistogramSnapshot& other);
+
+        int64_t count() const { return count_; }
+        int64_t sum() const { return sum_; }
+        // Min and max are 0 when the snapshot is empty.
+        int64_t min() const { return count_ ? min_ : 0; }
+        int64_t max() const { return max_; }
+        double Mean() const {
+          return count_ ? static_cast<double>(sum_) / count_ : 0.0;
+        }
+
+        // Returns a value v such that at least the given fraction of samples
+        // (0.0 to 1.0) is <= v. Accurate to the bucket resolution and clamped to
+        // [min(), max()]. Returns 0 when the snapshot is empty.
+        int64_t Percentile(double fraction) const;
+        int64_t P50() const { return Percentile(0.50); }
+        int64_t P90() const { return Percentile(0.90); }
+        int64_t P99() const { return Percentile(0.99); }
+
+        // Sample counts per bucket, indexed as in HistogramBuckets.
+        const std::vector<int64_t>& buckets() const { return buckets_; }
+
+      private:
+        friend class Histogram;
+
+        int64_t count_ = 0;
+        int64_t sum_ = 0;
+        int64_t min_ = INT64_MAX;
+        int64_t max_ = 0;
+        std::vector<int64_t> buckets_;
+    };
+
+    // Upper bound on the number of shards of a Histogram. Each shard holds all
+    // buckets (about 8 KB), so histograms use fewer shards than counters;
+    // threads beyond this share shards.
+    inline constexpr int kMaxHistogramShards = 4;
+
+    // A concurrent histogram of int64 samples.
+    // Record() is lock-free and allocation-free: each thread shard records into
+    // its own cache-line-aligned buffer of relaxed atomics, so concurrent
+    // recorders on different shards do not contend. All shard buffers are
+    // allocated up front. Snapshot() sums all shard buffers and may miss
+    // samples that race with it.
+    // This class is thread safe.
+    class Histogram {
+      public:
+        Histogram();
+        ~Histogram();
+        Histogram(const Histogram&) = delete;
+        Histogram& operator=(const Histogram&) = delete;
+
+        // Records one sample. Negative values are recorded as 0.
+        void Record(int64_t value);
+
+        // Records a duration in microseconds, the unit used for all latency
+        // histograms in the framework.
+        void RecordDuration(absl::Duration duration) {
+          Record(absl::ToInt64Microseconds(duration));
+        }
+
+        // Returns the merged contents of all shards.
+        HistogramSnapshot Snapshot() const;
+
+      private:
+        struct Shard;
+
+        // A power of two, so that shard indices can be masked.
+        const int num_shards_;
+        std::unique_ptr<Shard[]> shards_;
+    };
+
+    struct alignas(kCacheLineSize) Histogram::Shard {
+      void Record(int64_t value) {
+        if (value < 0) value = 0;
+        buckets[HistogramBuckets::Index(value)].fetch_add(
+            1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(value, std::memory_order_relaxed);
+        int64_t seen = min.load(std::memory_order_relaxed);
+        while (value < seen &&
+               !min.compare_exchange_weak(seen, value,
+                                          std::memory_order_relaxed)) {
+        }
+        seen = max.load(std::memory_order_relaxed);
+        while (value > seen &&
+               !max.compare_exchange_weak(seen, value,
+                                          std::memory_order_relaxed)) {
+        }
+      }
+
+      std::atomic<int64_t> count{0};
+      std::atomic<int64_t> sum{0};
+      std::atomic<int64_t> min{INT64_MAX};
+      std::atomic<int64_t> max{0};
+      std::atomic<int64_t> buckets[HistogramBuckets::kNumBuckets] = {};
+    };
+
+    inline void Histogram::Record(int64_t value) {
+      shards_[ThisThreadShard() & (num_shards_ - 1)].Record(value);
+    }
+}  // namespace mediapipe
+
+#endif  // CUSTOM_MEDIAPIPE_HISTOGRAM_H
@@ -0,0 +1,97 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Declares InputStreamHandler, which decides when a node's calculator can
+// run and which input packets it gets.
+
+#ifndef CUSTOM_MEDIAPIPE_INPUT_STREAM_HANDLER_H
+#define CUSTOM_MEDIAPIPE_INPUT_STREAM_HANDLER_H
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "mediapipe/framework/deps/registration.h"
+#include "mediapipe/framework/input_stream_manager.h"
+#include "mediapipe/framework/input_stream_shard.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/timestamp.h"
+
+namespace mediapipe {
+    // A node asks its handler what to do whenever one of its input streams
+    // changes (a packet arrived, the timestamp bound moved or the stream was
+    // closed) and whenever a Process() call finishes. Handlers are told which
+    // input changed, so they can keep incremental state instead of scanning
+    // every input each time.
+    //
+    // Select a handler with Node.input_stream_handler in the graph config;
+    // the default is "DefaultInputStreamHandler".
+    //
+    // The node serializes all calls to its handler. What a handler has read
+    // from an input stream can only be stale towards smaller timestamps,
+    // since a stream's next timestamp never decreases.
+    class InputStreamHandler {
+      public:
+        enum class NodeReadiness { kNotReady, kReadyForProcess, kReadyForClose };
+
+        InputStreamHandler() = default;
+        virtual ~InputStreamHandler() = default;
+        InputStreamHandler(const InputStreamHandler&) = delete;
+        InputStreamHandler& operator=(const InputStreamHandler&) = delete;
+
+        // Called once, before any other method.
+        virtual void Initialize(std::vector<InputStreamManager*> inputs) {
+          inputs_ = std::move(inputs);
+        }
+
+        // The input stream with the given id changed.
+        virtual void InputChanged(int id) = 0;
+
+        // For kReadyForProcess, sets *timestamp to the input timestamp to
+        // process next. For kNotReady, sets it to the smallest timestamp that
+        // the node may still process; everything below is settled.
+        virtual NodeReadiness GetNodeReadiness(Timestamp* timestamp) = 0;
+
+        // Moves the packets at timestamp, as just returned by
+        // GetNodeReadiness(), into inputs.
+        virtual void FillInputSet(Timestamp timestamp,
+                                  InputStreamShardSet* inputs) = 0;
+
+      protected:
+        static void SetPacket(InputStreamShard* shard, Packet packet) {
+          shard->packet_ = std::move(packet);
+        }
+
+        std::vector<InputStreamManager*> inputs_;
+    };
+
+    using InputStreamHandlerRegistry =
+        GlobalFactoryRegistry<std::unique_ptr<InputStreamHandler>>;
+
+    namespace internal {
+        template <typename T>
+        std::unique_ptr<InputStreamHandler> CreateInputStreamHandler() {
+          return std::make_unique<T>();
+        }
+    }  // namespace internal
+}  // namespace mediapipe
+
+// Makes an input stream handler class available to graphs under its class
+// name. Use at namespace scope, in the namespace of the handler.
+#define REGISTER_INPUT_STREAM_HANDLER(name)                                 \
+  MEDIAPIPE_STATIC_REGISTER_FACTORY_FUNCTION_QUALIFIED(                     \
+      ::mediapipe::InputStreamHandlerRegistry, input_handler_registration,  \
+      name, &::mediapipe::internal::CreateInputStreamHandler<name>)
+
+#endif  // CUSTOM_MEDIAPIPE_INPUT_STREAM_HANDLER_H
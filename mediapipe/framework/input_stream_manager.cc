@@ -0,0 +1,138 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/input_stream_manager.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+
+namespace mediapipe {
+
+    absl::Status InputStreamManager::AddPackets(const std::vector<Packet>& packets) {
+      return AddPacketRange(packets.begin(), packets.end());
+    }
+
+    absl::Status InputStreamManager::AddPackets(std::vector<Packet>&& packets) {
+      return AddPacketRange(std::make_move_iterator(packets.begin()),
+                            std::make_move_iterator(packets.end()));
+    }
+
+    template <typename Iterator>
+    absl::Status InputStreamManager::AddPacketRange(Iterator begin,
+                                                    Iterator end) {
+      if (closed_.load(std::memory_order_relaxed)) {
+        return absl::FailedPreconditionError(absl::StrCat(
+            "Packet added to input stream \"", name_, "\" after it was closed."));
+      }
+      if (detached_.load(std::memory_order_acquire)) return absl::OkStatus();
+      for (Iterator it = begin; it != end; ++it) {
+        const Packet& packet = *it;
+        if (packet.Timestamp() < bound_) {
+          return absl::InvalidArgumentError(absl::StrCat(
+              "Packet timestamp ", packet.Timestamp().DebugString(),
+              " on input stream \"", name_, "\" is below the timestamp bound ",
+              bound_.DebugString(), "."));
+        }
+        bound_ = packet.Timestamp().NextAllowedInStream();
+        if (policy_ == InputStreamInfo::DROP_NEWEST && IsBounded() &&
+            QueueSize() >= max_queue_size_) {
+          dropped_packets_->Increment();
+          continue;
+        }
+        queue_.Push(*it);
+      }
+      int64_t size = QueueSize();
+      if (size > high_water_) {
+        // Counters only grow, so publish the high water mark by deltas.
+        high_water_mark_->IncrementBy(static_cast<int>(size - high_water_));
+        high_water_ = size;
+      }
+      if (Blocks() && size >= max_queue_size_) UpdateFull();
+      next_timestamp_bound_.store(bound_, std::memory_order_release);
+      notify_();
+      return absl::OkStatus();
+    }
+
+    void InputStreamManager::SetNextTimestampBound(Timestamp bound) {
+      if (bound <= bound_ || closed_.load(std::memory_order_relaxed)) return;
+      bound_ = bound;
+      next_timestamp_bound_.store(bound_, std::memory_order_release);
+      notify_();
+    }
+
+    void InputStreamManager::Close() {
+      if (closed_.exchange(true, std::memory_order_release)) return;
+      notify_();
+    }
+
+    void InputStreamManager::DropOldestPackets() {
+      if (policy_ != InputStreamInfo::DROP_OLDEST || !IsBounded()) return;
+      while (QueueSize() > max_queue_size_) {
+        popped_bound_ = queue_.Pop().Timestamp().NextAllowedInStream();
+        dropped_packets_->Increment();
+      }
+    }
+
+    Timestamp InputStreamManager::NextTimestamp(bool* has_packet) {
+      if (detached_.load(std::memory_order_relaxed)) {
+        *has_packet = false;
+        return Timestamp::Done();
+      }
+      // Read before the queue: every packet below the bound, and every packet
+      // once closed, is visible.
+      bool closed = closed_.load(std::memory_order_acquire);
+      Timestamp bound = next_timestamp_bound_.load(std::memory_order_acquire);
+      const Packet* front = queue_.Front();
+      *has_packet = front != nullptr;
+      if (front != nullptr) return front->Timestamp();
+      return closed ? Timestamp::Done() : std::max(bound, popped_bound_);
+    }
+
+    Packet InputStreamManager::PopPacketAtTimestamp(Timestamp timestamp) {
+      const Packet* front = queue_.Front();
+      if (front == nullptr || front->Timestamp() != timestamp) return Packet();
+      Packet packet = queue_.Pop();
+      popped_bound_ = timestamp.NextAllowedInStream();
+      if (Blocks()) {
+        // Pairs with the fence in UpdateFull(): either the producer sees
+        // this pop, or this sees the producer's full_ and re-evaluates.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (full_.load(std::memory_order_relaxed)) UpdateFull();
+      }
+      return packet;
+    }
+
+    void InputStreamManager::Detach() {
+      detached_.store(true, std::memory_order_release);
+      // A packet the producer adds concurrently may stay queued until the
+      // stream is destroyed.
+      while (queue_.Front() != nullptr) queue_.Pop();
+      if (Blocks() && full_.load(std::memory_order_relaxed)) UpdateFull();
+    }
+
+    void InputStreamManager::UpdateFull() {
+      absl::MutexLock lock(&full_mu_);
+      bool was_full = full_.load(std::memory_order_relaxed);
+      // Claim fullness before reading the size; see PopPacketAtTimestamp().
+      full_.store(true, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      bool full = QueueSize() >= max_queue_size_;
+      full_.store(full, std::memory_order_relaxed);
+      if (full != was_full && becomes_full_callback_) becomes_full_callback_(full);
+    }
+
+}  // namespace mediapipe
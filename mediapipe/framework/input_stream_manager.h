@@ -0,0 +1,153 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CUSTOM_MEDIAPIPE_INPUT_STREAM_MANAGER_H
+#define CUSTOM_MEDIAPIPE_INPUT_STREAM_MANAGER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/counter.h"
+#include "mediapipe/framework/deps/spsc_queue.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/timestamp.h"
+
+namespace mediapipe {
+    // The queue of packets waiting on one input stream of a node. The
+    // upstream output stream adds packets; the node pops them in timestamp
+    // order.
+    //
+    // The queue is a lock-free single-producer/single-consumer ring buffer:
+    // the producer side (AddPackets, Close) must be serialized by the caller,
+    // and so must the consumer side (NextTimestamp, PopPacketAtTimestamp).
+    // The two sides may run concurrently. Locks are only taken when a
+    // BLOCK_UPSTREAM stream crosses its size limit.
+    //
+    // BLOCK_UPSTREAM streams accept every packet: holding back the producer
+    // is up to the becomes-full callback.
+    class InputStreamManager {
+      public:
+        using QueueFullPolicy = InputStreamInfo::QueueFullPolicy;
+
+        // notify is called, without locks held, after packets are added or the
+        // stream is closed. Packets discarded by the queue full policy are
+        // counted in dropped_packets; the largest queue size seen so far is
+        // kept in high_water_mark.
+        InputStreamManager(std::string name, std::function<void()> notify,
+                           Counter* dropped_packets, Counter* high_water_mark)
+            : name_(std::move(name)),
+              notify_(std::move(notify)),
+              dropped_packets_(dropped_packets),
+              high_water_mark_(high_water_mark) {}
+        InputStreamManager(const InputStreamManager&) = delete;
+        InputStreamManager& operator=(const InputStreamManager&) = delete;
+
+        const std::string& Name() const { return name_; }
+
+        // Limits the queue to max_queue_size packets, or none if negative.
+        // Must be called before packets flow.
+        void SetMaxQueueSize(int max_queue_size, QueueFullPolicy policy) {
+          max_queue_size_ = max_queue_size;
+          policy_ = policy;
+        }
+        // For BLOCK_UPSTREAM streams: callback(true) is called when the queue
+        // reaches the limit, callback(false) when it drops below again. Must
+        // be called before packets flow.
+        void SetBecomesFullCallback(std::function<void(bool)> callback) {
+          becomes_full_callback_ = std::move(callback);
+        }
+
+        // Producer side.
+        //
+        // Appends packets, whose timestamps must increase.
+        absl::Status AddPackets(const std::vector<Packet>& packets);
+        // Same, moving the packets into the queue.
+        absl::Status AddPackets(std::vector<Packet>&& packets);
+        // Promises that no packet below bound will be added. Lower bounds are
+        // ignored.
+        void SetNextTimestampBound(Timestamp bound);
+        // No packets can be added after this.
+        void Close();
+
+        // Consumer side.
+        //
+        // For DROP_OLDEST streams, discards the oldest packets beyond the
+        // limit. Should be called whenever packets may have been added, even
+        // while the consumer is busy.
+        void DropOldestPackets();
+        // The timestamp of the first queued packet, with *has_packet set to
+        // true. Otherwise the smallest timestamp a packet may still arrive
+        // at: the timestamp bound, or Timestamp::Done() once the stream is
+        // closed. Never decreases.
+        Timestamp NextTimestamp(bool* has_packet);
+        // Pops the first packet if it has the given timestamp, else returns an
+        // empty packet.
+        Packet PopPacketAtTimestamp(Timestamp timestamp);
+        // Stops consuming, e.g. a back edge of a node that is about to close:
+        // discards the queued packets, and the stream looks closed from then
+        // on. Packets the producer adds later are discarded without error.
+        void Detach();
+
+        // Any thread. A snapshot.
+        int QueueSize() const { return static_cast<int>(queue_.Size()); }
+
+      private:
+        bool IsBounded() const { return max_queue_size_ >= 0; }
+        bool Blocks() const {
+          return IsBounded() && policy_ == InputStreamInfo::BLOCK_UPSTREAM;
+        }
+        // Does the work of AddPackets(), copying or moving the packets as
+        // dereferencing the iterators does.
+        template <typename Iterator>
+        absl::Status AddPacketRange(Iterator begin, Iterator end);
+        // Re-evaluates whether the queue is full and reports changes.
+        void UpdateFull() ABSL_LOCKS_EXCLUDED(full_mu_);
+
+        const std::string name_;
+        const std::function<void()> notify_;
+        Counter* const dropped_packets_;
+        Counter* const high_water_mark_;
+        int max_queue_size_ = -1;
+        QueueFullPolicy policy_ = InputStreamInfo::BLOCK_UPSTREAM;
+        std::function<void(bool)> becomes_full_callback_;
+
+        SpscQueue<Packet> queue_;
+        // Set by the producer after its last packet.
+        std::atomic<bool> closed_{false};
+        // Set by the consumer; see Detach().
+        std::atomic<bool> detached_{false};
+        // Raised by the producer after the packets below it are queued.
+        std::atomic<Timestamp> next_timestamp_bound_{Timestamp::PreStream()};
+
+        // Producer state.
+        Timestamp bound_ = Timestamp::PreStream();
+        // Consumer state: the bound implied by the packets popped so far.
+        // The producer may not have published it yet.
+        Timestamp popped_bound_ = Timestamp::PreStream();
+        int64_t high_water_ = 0;
+
+        // Written under full_mu_ only, read by the consumer without it.
+        std::atomic<bool> full_{false};
+        absl::Mutex full_mu_;
+    };
+}  // namespace mediapipe
+
+#endif  // CUSTOM_MEDIAPIPE_INPUT_STREAM_MANAGER_H
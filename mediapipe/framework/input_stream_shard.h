@@ -0,0 +1,63 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CUSTOM_MEDIAPIPE_INPUT_STREAM_SHARD_H
+#define CUSTOM_MEDIAPIPE_INPUT_STREAM_SHARD_H
+
+#include <string>
+#include <utility>
+
+#include "mediapipe/framework/collection.h"
+#include "mediapipe/framework/packet.h"
+
+namespace mediapipe {
+    // The input packet of one input stream for a single Process() call. Empty
+    // if the stream has no packet at the input timestamp.
+    class InputStreamShard {
+      public:
+        InputStreamShard() = default;
+
+        const Packet& Value() const { return packet_; }
+        template <typename T>
+        const T& Get() const {
+          return packet_.Get<T>();
+        }
+        bool IsEmpty() const { return packet_.IsEmpty(); }
+
+        // The payload for modification, copied first only if other packets
+        // share it; see Packet::GetMutable(). Forward the modified payload
+        // with Consume().
+        template <typename T>
+        T* GetMutable(bool* copied = nullptr) {
+          return packet_.GetMutable<T>(copied);
+        }
+
+        // Moves the packet out, leaving the shard empty. Forwarding a packet
+        // this way hands on its payload without touching the reference count.
+        Packet Consume() { return std::move(packet_); }
+
+        const std::string& Name() const { return *name_; }
+
+      private:
+        friend class CalculatorContext;
+        friend class InputStreamHandler;
+
+        Packet packet_;
+        const std::string* name_ = nullptr;
+    };
+
+    using InputStreamShardSet = internal::Collection<InputStreamShard>;
+}  // namespace mediapipe
+
+#endif  // CUSTOM_MEDIAPIPE_INPUT_STREAM_SHARD_H
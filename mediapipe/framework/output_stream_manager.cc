@@ -0,0 +1,83 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/output_stream_manager.h"
+
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+
+namespace mediapipe {
+
+    absl::Status OutputStreamManager::PropagatePackets(
+        std::vector<Packet> packets) {
+      if (packets.empty()) return absl::OkStatus();
+      if (closed_) {
+        return absl::FailedPreconditionError(absl::StrCat(
+            "Packet added to output stream \"", name_, "\" after it was closed."));
+      }
+      for (const Packet& packet : packets) {
+        Timestamp timestamp = packet.Timestamp();
+        if (!timestamp.IsAllowedInStream()) {
+          return absl::InvalidArgumentError(absl::StrCat(
+              "Timestamp ", timestamp.DebugString(),
+              " is not allowed in a stream; packet added to \"", name_, "\"."));
+        }
+        if (timestamp < next_timestamp_bound_) {
+          return absl::InvalidArgumentError(absl::StrCat(
+              "Packet timestamp ", timestamp.DebugString(), " on stream \"", name_,
+              "\" is below the timestamp bound ",
+              next_timestamp_bound_.DebugString(),
+              "; timestamps must increase, and PreStream and PostStream packets "
+              "must be alone in their stream."));
+        }
+        next_timestamp_bound_ = timestamp.NextAllowedInStream();
+      }
+      if (latency_histogram_ != nullptr) {
+        const absl::Time now = absl::Now();
+        for (const Packet& packet : packets) {
+          if (packet.IngestionTime() == absl::InfinitePast()) continue;
+          latency_histogram_->RecordDuration(now - packet.IngestionTime());
+        }
+      }
+      for (const auto& observer : observers_) {
+        for (const Packet& packet : packets) {
+          absl::Status status = observer(packet);
+          if (!status.ok()) return status;
+        }
+      }
+      for (size_t i = 0; i < mirrors_.size(); ++i) {
+        absl::Status status =
+            i + 1 < mirrors_.size() ? mirrors_[i]->AddPackets(packets)
+                                    : mirrors_[i]->AddPackets(std::move(packets));
+        if (!status.ok()) return status;
+      }
+      return absl::OkStatus();
+    }
+
+    void OutputStreamManager::SetNextTimestampBound(Timestamp bound) {
+      if (closed_ || bound <= next_timestamp_bound_) return;
+      next_timestamp_bound_ = bound;
+      for (InputStreamManager* mirror : mirrors_) {
+        mirror->SetNextTimestampBound(bound);
+      }
+    }
+
+    void OutputStreamManager::Close() {
+      if (closed_) return;
+      closed_ = true;
+      for (InputStreamManager* mirror : mirrors_) mirror->Close();
+    }
+
+}  // namespace mediapipe
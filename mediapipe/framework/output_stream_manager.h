@@ -0,0 +1,78 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CUSTOM_MEDIAPIPE_OUTPUT_STREAM_MANAGER_H
+#define CUSTOM_MEDIAPIPE_OUTPUT_STREAM_MANAGER_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "mediapipe/framework/histogram.h"
+#include "mediapipe/framework/input_stream_manager.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/timestamp.h"
+
+namespace mediapipe {
+    // Sends the packets of one stream to every input stream reading it
+    // (its mirrors) and to any observers.
+    // Not thread safe: a stream has a single producer at a time. Mirrors and
+    // observers must be added before packets flow.
+    class OutputStreamManager {
+      public:
+        explicit OutputStreamManager(std::string name) : name_(std::move(name)) {}
+        OutputStreamManager(const OutputStreamManager&) = delete;
+        OutputStreamManager& operator=(const OutputStreamManager&) = delete;
+
+        const std::string& Name() const { return name_; }
+
+        void AddMirror(InputStreamManager* mirror) { mirrors_.push_back(mirror); }
+        void AddObserver(std::function<absl::Status(const Packet&)> observer) {
+          observers_.push_back(std::move(observer));
+        }
+        // Records the time from the ingestion of every packet with an
+        // ingestion time to its propagation in latency_histogram, in
+        // microseconds.
+        void SetLatencyHistogram(Histogram* latency_histogram) {
+          latency_histogram_ = latency_histogram;
+        }
+
+        // Checks that the packets have increasing timestamps allowed in a
+        // stream, at or above the timestamp bound, then hands them to the
+        // observers and mirrors. The last mirror gets the packets themselves,
+        // the others copies of their handles.
+        absl::Status PropagatePackets(std::vector<Packet> packets);
+
+        // Raises the timestamp bound, the smallest timestamp the next packet
+        // may have, and forwards it to the mirrors. Lower bounds, and bounds
+        // set after Close(), are ignored.
+        void SetNextTimestampBound(Timestamp bound);
+        Timestamp NextTimestampBound() const { return next_timestamp_bound_; }
+
+        // Closes all mirrors. Idempotent.
+        void Close();
+        bool IsClosed() const { return closed_; }
+
+      private:
+        const std::string name_;
+        std::vector<InputStreamManager*> mirrors_;
+        std::vector<std::function<absl::Status(const Packet&)>> observers_;
+        Histogram* latency_histogram_ = nullptr;
+        Timestamp next_timestamp_bound_ = Timestamp::PreStream();
+        bool closed_ = false;
+    };
+}  // namespace mediapipe
+
+#endif  // CUSTOM_MEDIAPIPE_OUTPUT_STREAM_MANAGER_H
@@ -0,0 +1,77 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CUSTOM_MEDIAPIPE_OUTPUT_STREAM_SHARD_H
+#define CUSTOM_MEDIAPIPE_OUTPUT_STREAM_SHARD_H
+
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mediapipe/framework/collection.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/timestamp.h"
+
+namespace mediapipe {
+    // Collects the packets a calculator outputs on one stream during a single
+    // Open(), Process() or Close() call. They are sent downstream once the
+    // call returns. Packets must carry increasing timestamps.
+    //
+    // Downstream nodes can only process a timestamp once every one of their
+    // inputs has a packet there or is known not to get one. A stream tells
+    // them the latter through its timestamp bound: the smallest timestamp
+    // its next packet may have. Adding a packet moves the bound past it;
+    // SetNextTimestampBound() and SetOffset() move it without a packet.
+    class OutputStreamShard {
+      public:
+        OutputStreamShard() = default;
+
+        void AddPacket(const Packet& packet) { packets_.push_back(packet); }
+        void AddPacket(Packet&& packet) { packets_.push_back(std::move(packet)); }
+
+        // Takes ownership of ptr.
+        template <typename T>
+        void Add(T* ptr, Timestamp timestamp) {
+          AddPacket(Adopt(ptr).At(timestamp));
+        }
+
+        // Promises that no packet with a timestamp below bound will follow the
+        // packets of this call, e.g. when Process() decides to skip the input
+        // timestamp.
+        void SetNextTimestampBound(Timestamp bound) {
+          next_timestamp_bound_ = bound;
+        }
+
+        // In Open() only. Promises that every packet on the stream will have
+        // the input timestamp plus offset, if it is output at all. The
+        // framework then advances the stream's bound along with the node's
+        // input bounds, with no Process() call or packet needed.
+        void SetOffset(TimestampDiff offset) { offset_ = offset; }
+
+        const std::string& Name() const { return *name_; }
+
+      private:
+        friend class CalculatorNode;
+
+        std::vector<Packet> packets_;
+        Timestamp next_timestamp_bound_ = Timestamp::Unset();
+        std::optional<TimestampDiff> offset_;
+        const std::string* name_ = nullptr;
+    };
+
+    using OutputStreamShardSet = internal::Collection<OutputStreamShard>;
+}  // namespace mediapipe
+
+#endif  // CUSTOM_MEDIAPIPE_OUTPUT_STREAM_SHARD_H
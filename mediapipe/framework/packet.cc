@@ -0,0 +1,37 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/packet.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace mediapipe {
+
+    std::string Packet::DebugString() const {
+      std::string result = absl::StrCat("mediapipe::Packet with timestamp: ",
+                                        timestamp_.DebugString());
+      if (IsEmpty()) {
+        absl::StrAppend(&result, " and no data");
+      } else {
+        absl::StrAppend(&result, holder_ ? " and shared data" : " and inline data",
+                        " of type ", MediaPipeTypeStringOrDemangled(type_id_));
+      }
+      return result;
+    }
+
+    std::ostream& operator<<(std::ostream& os, const Packet& packet) {
+      return os << packet.DebugString();
+    }
+
+}  // namespace mediapipe
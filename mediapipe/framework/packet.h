@@ -1,45 +1,452 @@
+// Copyright 2019 The MediaPipe Authors.
 //
-// Created by MSD on 31/01/2025.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
 //
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Defines Packet, a container capable of holding an object of any type.
 
 #ifndef PACKET_H
 #define PACKET_H
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <memory>
+#include <new>
 #include <ostream>
 #include <string>
 #include <type_traits>
 #include <utility>
-#include <vector>
 
 #include "absl/base/attributes.h"
 #include "absl/base/macros.h"
 #include "absl/base/optimization.h"
-#include "absl/functional/any_invocable.h"
 #include "absl/log/absl_check.h"
-#include "absl/log/absl_log.h"
-#include "absl/memory/memory.h"
 #include "absl/status/status.h"
-#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
-#include "absl/synchronization/mutex.h"
-#include "google/protobuf/message.h"
-#include "google/protobuf/message_lite.h"
-#include "mediapipe/framework/deps/no_destructor.h"
-#include "mediapipe/framework/deps/registration.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/packet_pool.h"
 #include "mediapipe/framework/port.h"
-#include "mediapipe/framework/port/canonical_errors.h"
-#include "mediapipe/framework/port/logging.h"
-#include "mediapipe/framework/port/proto_ns.h"
-#include "mediapipe/framework/port/ret_check.h"
-#include "mediapipe/framework/port/status.h"
-#include "mediapipe/framework/port/status_builder.h"
-#include "mediapipe/framework/port/status_macros.h"
-#include "mediapipe/framework/port/statusor.h"
 #include "mediapipe/framework/timestamp.h"
-#include "mediapipe/framework/tool/type_util.h"
 #include "mediapipe/framework/type_map.h"
+#include "mediapipe/framework/tool/type_util.h"
+
+namespace mediapipe {
+    class Packet;
+
+    namespace packet_internal {
+        // The heap-allocated part of a packet: an intrusively reference counted
+        // holder of an immutable payload. Packets that share a payload share
+        // the holder; there is no separate control block.
+        class HolderBase {
+          public:
+            HolderBase(const HolderBase&) = delete;
+            HolderBase& operator=(const HolderBase&) = delete;
+
+            void AddRef() const {
+              ref_count_.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            // Drops a reference and destroys the holder with the last one.
+            void Release() const {
+              if (ref_count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                Destroy();
+              }
+            }
+
+            // Only meaningful while the caller owns a reference.
+            bool HasOneRef() const {
+              return ref_count_.load(std::memory_order_acquire) == 1;
+            }
+
+            TypeId type_id() const { return type_id_; }
+            const void* data() const { return data_; }
+
+          protected:
+            // Starts with one reference, owned by the creator. pool is the
+            // pool the holder's block came from, or null if it came from the
+            // heap.
+            HolderBase(TypeId type_id, const void* data, HolderPool* pool)
+                : type_id_(type_id), data_(data), pool_(pool) {}
+            virtual ~HolderBase() = default;
+
+            // Frees the holder and its payload.
+            virtual void Destroy() const { delete this; }
+
+            HolderPool* pool() const { return pool_; }
+
+          private:
+            mutable std::atomic<int32_t> ref_count_{1};
+            const TypeId type_id_;
+            // Cached so that accessing the payload needs no virtual call.
+            const void* const data_;
+            HolderPool* const pool_;
+        };
+
+        // Allocates a holder of type H from its pool if it has one, else from
+        // the heap. Pair with DeleteHolder().
+        template <typename H, typename... Args>
+        H* NewHolder(Args&&... args) {
+          if constexpr (HolderPool::kPooled<H>) {
+            HolderPool& pool = HolderPool::For<H>();
+            return new (pool.Allocate()) H(&pool, std::forward<Args>(args)...);
+          } else {
+            return new (::operator new(sizeof(H)))
+                H(nullptr, std::forward<Args>(args)...);
+          }
+        }
+
+        // Destroys a holder created by NewHolder() and releases its block to
+        // the pool it came from, whichever thread this runs on.
+        template <typename H>
+        void DeleteHolder(const H* holder, HolderPool* pool) {
+          void* block = const_cast<H*>(holder);
+          holder->~H();
+          if (pool != nullptr) {
+            pool->Deallocate(block);
+          } else {
+            ::operator delete(block);
+          }
+        }
+
+        // Holds a payload constructed in place, so that holder and payload
+        // share a single allocation.
+        template <typename T>
+        class Holder : public HolderBase {
+          public:
+            template <typename... Args>
+            explicit Holder(HolderPool* pool, Args&&... args)
+                : HolderBase(kTypeId<T>, &value_, pool),
+                  value_(std::forward<Args>(args)...) {}
+
+          protected:
+            void Destroy() const override { DeleteHolder(this, pool()); }
+
+          private:
+            T value_;
+        };
+
+        // Holds a payload allocated elsewhere, taking ownership of it.
+        template <typename T>
+        class AdoptedHolder : public HolderBase {
+          public:
+            AdoptedHolder(HolderPool* pool, const T* ptr)
+                : HolderBase(kTypeId<T>, ptr, pool), ptr_(ptr) {}
+            ~AdoptedHolder() override { delete ptr_; }
+
+          protected:
+            void Destroy() const override { DeleteHolder(this, pool()); }
+
+          private:
+            const T* const ptr_;
+        };
+
+        // Payloads of at most this size are stored inside the Packet itself.
+        inline constexpr size_t kInlineSize = 16;
+
+        // Small trivially copyable payloads (ints, floats, small structs) are
+        // stored inline: creating, copying and destroying such packets never
+        // touches the heap or an atomic reference count.
+        template <typename T>
+        inline constexpr bool kStoredInline =
+            sizeof(T) <= kInlineSize && alignof(T) <= alignof(int64_t) &&
+            std::is_trivially_copyable_v<T> &&
+            std::is_trivially_destructible_v<T>;
+
+        template <typename T>
+        Packet Create(HolderBase* holder);
+        template <typename T, typename... Args>
+        Packet CreateInline(Args&&... args);
+    }  // namespace packet_internal
+
+    // A Packet is a value type holding an immutable payload of any type and a
+    // Timestamp. Copying a packet never copies the payload: large payloads are
+    // shared between copies through an atomic reference count, small trivially
+    // copyable ones are stored inline in the packet (see kStoredInline).
+    //
+    // Create packets with MakePacket<T>(...) or Adopt(T*), and give them a
+    // timestamp with At(). Holders come from per-type pools (packet_pool.h),
+    // so steady-state packet creation does not call malloc. Packets are thread
+    // compatible; a payload is never modified while packets share it, see
+    // GetMutable().
+    class Packet {
+      public:
+        // An empty packet, with Timestamp::Unset().
+        Packet() = default;
+
+        Packet(const Packet& packet);
+        Packet& operator=(const Packet& packet);
+        Packet(Packet&& packet) noexcept;
+        Packet& operator=(Packet&& packet) noexcept;
+        ~Packet() { Reset(); }
+
+        // Returns a packet with the same payload and the given timestamp.
+        // Re-stamping only copies the payload handle, never the payload.
+        Packet At(class Timestamp timestamp) const&;
+        // Same as above, but moves the payload handle out of this packet.
+        Packet At(class Timestamp timestamp) &&;
+
+        // Returns true iff the packet has no payload.
+        bool IsEmpty() const { return type_id_.IsEmpty(); }
+
+        // Returns the payload. The packet must hold a T; check with
+        // ValidateAsType<T>() first if that is not known. The check compares
+        // two compile-time type ids and needs no RTTI.
+        template <typename T>
+        const T& Get() const;
+
+        // Returns the payload for modification, e.g. to draw on an image before
+        // forwarding the packet. If this packet is the only one holding the
+        // payload, returns it in place. Otherwise, first gives this packet a
+        // copy of its own, so that packets sharing the payload, e.g. the ones
+        // of other consumers of the same stream, never see the change. A
+        // calculator in a linear pipeline thus modifies its input without
+        // copying; with fan-out, only consumers that modify a shared payload
+        // pay for a copy.
+        //
+        // T must be copy constructible or have a CopyFrom(const T&) method.
+        // Sets *copied, if given, to whether the payload was copied.
+        template <typename T>
+        T* GetMutable(bool* copied = nullptr);
+
+        // Returns an error if the packet does not hold a T.
+        template <typename T>
+        absl::Status ValidateAsType() const;
+
+        // The id of the payload type; empty for an empty packet.
+        TypeId GetTypeId() const { return type_id_; }
+
+        class Timestamp Timestamp() const { return timestamp_; }
+
+        // When the data of the packet entered the graph, for tracing the
+        // latency of graphs; see ProfilerConfig.trace_packet_latency.
+        // Packets derived from others, such as the outputs of a calculator,
+        // carry the ingestion time of the earliest input they derive from.
+        // absl::InfinitePast() if unknown.
+        absl::Time IngestionTime() const {
+          return ingestion_ns_ == 0 ? absl::InfinitePast()
+                                    : absl::FromUnixNanos(ingestion_ns_);
+        }
+        // Returns a packet with the same payload and timestamp and the given
+        // ingestion time.
+        Packet WithIngestionTime(absl::Time time) const& {
+          Packet result(*this);
+          result.ingestion_ns_ = IngestionNanos(time);
+          return result;
+        }
+        Packet WithIngestionTime(absl::Time time) && {
+          ingestion_ns_ = IngestionNanos(time);
+          return std::move(*this);
+        }
+
+        // Returns a string with the timestamp and how the payload is stored.
+        std::string DebugString() const;
+
+      private:
+        template <typename T>
+        friend Packet packet_internal::Create(packet_internal::HolderBase* holder);
+        template <typename T, typename... Args>
+        friend Packet packet_internal::CreateInline(Args&&... args);
+
+        void Reset() {
+          if (holder_ != nullptr) {
+            holder_->Release();
+            holder_ = nullptr;
+          }
+          type_id_ = TypeId();
+        }
+
+        const void* data() const { return holder_ ? holder_->data() : inline_; }
+
+        static int64_t IngestionNanos(absl::Time time) {
+          return time == absl::InfinitePast() ? 0 : absl::ToUnixNanos(time);
+        }
+
+        // Owns one reference if not null. Null for inline and empty packets.
+        const packet_internal::HolderBase* holder_ = nullptr;
+        TypeId type_id_;
+        class Timestamp timestamp_;
+        // Unix time in nanoseconds; 0 if unknown.
+        int64_t ingestion_ns_ = 0;
+        alignas(int64_t) unsigned char inline_[packet_internal::kInlineSize];
+    };
+
+    // Returns a packet holding a T constructed from args, with
+    // Timestamp::Unset().
+    template <typename T, typename... Args>
+    Packet MakePacket(Args&&... args) {
+      if constexpr (packet_internal::kStoredInline<T>) {
+        return packet_internal::CreateInline<T>(std::forward<Args>(args)...);
+      } else {
+        return packet_internal::Create<T>(
+            packet_internal::NewHolder<packet_internal::Holder<T>>(
+                std::forward<Args>(args)...));
+      }
+    }
+
+    // Returns a packet that takes ownership of ptr, with Timestamp::Unset().
+    template <typename T>
+    Packet Adopt(const T* ptr) {
+      ABSL_CHECK(ptr != nullptr);
+      return packet_internal::Create<T>(
+          packet_internal::NewHolder<packet_internal::AdoptedHolder<T>>(ptr));
+    }
+
+    namespace packet_internal {
+        template <typename T, typename = void>
+        inline constexpr bool kHasCopyFrom = false;
+        template <typename T>
+        inline constexpr bool kHasCopyFrom<
+            T, std::void_t<decltype(std::declval<T&>().CopyFrom(
+                   std::declval<const T&>()))>> = true;
+
+        // Returns a packet holding a copy of value.
+        template <typename T>
+        Packet MakeCopy(const T& value) {
+          if constexpr (std::is_copy_constructible_v<T>) {
+            return MakePacket<T>(value);
+          } else {
+            static_assert(kHasCopyFrom<T>,
+                          "GetMutable() needs T(const T&) or T::CopyFrom()");
+            Packet packet = MakePacket<T>();
+            const_cast<T&>(packet.Get<T>()).CopyFrom(value);
+            return packet;
+          }
+        }
+    }  // namespace packet_internal
+
+    std::ostream& operator<<(std::ostream& os, const Packet& packet);
+
+    // Implementation details.
+
+    namespace packet_internal {
+        template <typename T>
+        Packet Create(HolderBase* holder) {
+          type_map_internal::Recorded<T>();
+          Packet packet;
+          packet.holder_ = holder;
+          packet.type_id_ = kTypeId<T>;
+          return packet;
+        }
+
+        template <typename T, typename... Args>
+        Packet CreateInline(Args&&... args) {
+          type_map_internal::Recorded<T>();
+          Packet packet;
+          new (packet.inline_) T(std::forward<Args>(args)...);
+          packet.type_id_ = kTypeId<T>;
+          return packet;
+        }
+    }  // namespace packet_internal
+
+    inline Packet::Packet(const Packet& packet)
+        : holder_(packet.holder_),
+          type_id_(packet.type_id_),
+          timestamp_(packet.timestamp_),
+          ingestion_ns_(packet.ingestion_ns_) {
+      if (holder_ != nullptr) {
+        holder_->AddRef();
+      } else {
+        std::memcpy(inline_, packet.inline_, sizeof(inline_));
+      }
+    }
+
+    inline Packet& Packet::operator=(const Packet& packet) {
+      if (this != &packet) {
+        if (packet.holder_ != nullptr) packet.holder_->AddRef();
+        Reset();
+        holder_ = packet.holder_;
+        type_id_ = packet.type_id_;
+        timestamp_ = packet.timestamp_;
+        ingestion_ns_ = packet.ingestion_ns_;
+        std::memcpy(inline_, packet.inline_, sizeof(inline_));
+      }
+      return *this;
+    }
+
+    inline Packet::Packet(Packet&& packet) noexcept
+        : holder_(packet.holder_),
+          type_id_(packet.type_id_),
+          timestamp_(packet.timestamp_),
+          ingestion_ns_(packet.ingestion_ns_) {
+      std::memcpy(inline_, packet.inline_, sizeof(inline_));
+      packet.holder_ = nullptr;
+      packet.type_id_ = TypeId();
+      packet.timestamp_ = ::mediapipe::Timestamp::Unset();
+      packet.ingestion_ns_ = 0;
+    }
+
+    inline Packet& Packet::operator=(Packet&& packet) noexcept {
+      if (this != &packet) {
+        Reset();
+        holder_ = packet.holder_;
+        type_id_ = packet.type_id_;
+        timestamp_ = packet.timestamp_;
+        ingestion_ns_ = packet.ingestion_ns_;
+        std::memcpy(inline_, packet.inline_, sizeof(inline_));
+        packet.holder_ = nullptr;
+        packet.type_id_ = TypeId();
+        packet.timestamp_ = ::mediapipe::Timestamp::Unset();
+        packet.ingestion_ns_ = 0;
+      }
+      return *this;
+    }
+
+    inline Packet Packet::At(class Timestamp timestamp) const& {
+      Packet result(*this);
+      result.timestamp_ = timestamp;
+      return result;
+    }
+
+    inline Packet Packet::At(class Timestamp timestamp) && {
+      timestamp_ = timestamp;
+      return std::move(*this);
+    }
+
+    template <typename T>
+    T* Packet::GetMutable(bool* copied) {
+      ABSL_CHECK(type_id_ == kTypeId<T>) << DebugString() << ", requested "
+                                         << MediaPipeTypeStringOrDemangled<T>();
+      const bool copy = holder_ != nullptr && !holder_->HasOneRef();
+      if (copy) {
+        Packet packet = packet_internal::MakeCopy<T>(Get<T>());
+        std::swap(holder_, packet.holder_);
+      }
+      if (copied != nullptr) *copied = copy;
+      return const_cast<T*>(&Get<T>());
+    }
+
+    template <typename T>
+    absl::Status Packet::ValidateAsType() const {
+      if (ABSL_PREDICT_FALSE(IsEmpty())) {
+        return absl::InternalError(
+            "Expected a Packet of a different type, but the Packet is empty.");
+      }
+      if (ABSL_PREDICT_FALSE(type_id_ != kTypeId<T>)) {
+        return absl::InvalidArgumentError(absl::StrCat(
+            "The Packet stores \"", MediaPipeTypeStringOrDemangled(type_id_),
+            "\", but \"", MediaPipeTypeStringOrDemangled<T>(),
+            "\" was requested."));
+      }
+      return absl::OkStatus();
+    }
+
+    template <typename T>
+    inline const T& Packet::Get() const {
+      ABSL_CHECK(type_id_ == kTypeId<T>)
+          << DebugString() << ", requested " << MediaPipeTypeStringOrDemangled<T>();
+      return *std::launder(static_cast<const T*>(data()));
+    }
+}  // namespace mediapipe
 
 #endif //PACKET_H
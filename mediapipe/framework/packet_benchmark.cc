@@ -0,0 +1,191 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Packet create/copy/destroy throughput against a naive shared_ptr<void>
+// design, for an inline payload (int), a small struct and a large struct, and
+// the cost of the type check in Get<T>().
+
+#include <cstdint>
+#include <memory>
+#include <typeindex>
+#include <typeinfo>
+#include <vector>
+
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/timestamp.h"
+
+namespace mediapipe {
+namespace {
+
+struct Small {
+  float x, y, z;
+};
+
+struct Large {
+  int64_t values[32];
+};
+
+// The design Packet replaces: a type-erased shared_ptr with a separate
+// control block, plus a timestamp.
+struct NaivePacket {
+  std::shared_ptr<void> payload;
+  Timestamp timestamp;
+};
+
+template <typename T>
+void BM_PacketCreateDestroy(benchmark::State& state) {
+  int64_t t = 0;
+  for (auto _ : state) {
+    Packet packet = MakePacket<T>().At(Timestamp(++t));
+    benchmark::DoNotOptimize(packet);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_PacketCreateDestroy, int);
+BENCHMARK_TEMPLATE(BM_PacketCreateDestroy, Small);
+BENCHMARK_TEMPLATE(BM_PacketCreateDestroy, Large);
+
+template <typename T>
+void BM_NaiveCreateDestroy(benchmark::State& state) {
+  int64_t t = 0;
+  for (auto _ : state) {
+    NaivePacket packet{std::shared_ptr<void>(new T()), Timestamp(++t)};
+    benchmark::DoNotOptimize(packet);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_NaiveCreateDestroy, int);
+BENCHMARK_TEMPLATE(BM_NaiveCreateDestroy, Small);
+BENCHMARK_TEMPLATE(BM_NaiveCreateDestroy, Large);
+
+// make_shared co-allocates the control block, the best case for shared_ptr.
+template <typename T>
+void BM_MakeSharedCreateDestroy(benchmark::State& state) {
+  int64_t t = 0;
+  for (auto _ : state) {
+    NaivePacket packet{std::make_shared<T>(), Timestamp(++t)};
+    benchmark::DoNotOptimize(packet);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_MakeSharedCreateDestroy, int);
+BENCHMARK_TEMPLATE(BM_MakeSharedCreateDestroy, Large);
+
+// Fans one packet out to 8 consumers, as an output stream with 8 readers.
+template <typename T>
+void BM_PacketCopy(benchmark::State& state) {
+  const Packet packet = MakePacket<T>().At(Timestamp(0));
+  std::vector<Packet> copies(8);
+  for (auto _ : state) {
+    for (Packet& copy : copies) copy = packet;
+    for (Packet& copy : copies) copy = Packet();
+  }
+  state.SetItemsProcessed(state.iterations() * copies.size());
+}
+BENCHMARK_TEMPLATE(BM_PacketCopy, int);
+BENCHMARK_TEMPLATE(BM_PacketCopy, Large);
+
+// libstdc++ skips the atomic reference count updates of shared_ptr while the
+// process has a single thread, so compare with the contended cases below.
+template <typename T>
+void BM_NaiveCopy(benchmark::State& state) {
+  const NaivePacket packet{std::make_shared<T>(), Timestamp(0)};
+  std::vector<NaivePacket> copies(8);
+  for (auto _ : state) {
+    for (NaivePacket& copy : copies) copy = packet;
+    for (NaivePacket& copy : copies) copy = NaivePacket();
+  }
+  state.SetItemsProcessed(state.iterations() * copies.size());
+}
+BENCHMARK_TEMPLATE(BM_NaiveCopy, int);
+BENCHMARK_TEMPLATE(BM_NaiveCopy, Large);
+
+// Copies of a shared packet made and dropped concurrently, which is what
+// contends on the reference count.
+void BM_PacketCopyContended(benchmark::State& state) {
+  static const Packet* packet = new Packet(MakePacket<Large>());
+  for (auto _ : state) {
+    Packet copy = *packet;
+    benchmark::DoNotOptimize(copy);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PacketCopyContended)->ThreadRange(1, 8)->UseRealTime();
+
+void BM_NaiveCopyContended(benchmark::State& state) {
+  static const NaivePacket* packet =
+      new NaivePacket{std::make_shared<Large>(), Timestamp(0)};
+  for (auto _ : state) {
+    NaivePacket copy = *packet;
+    benchmark::DoNotOptimize(copy);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_NaiveCopyContended)->ThreadRange(1, 8)->UseRealTime();
+
+void BM_PacketAt(benchmark::State& state) {
+  Packet packet = MakePacket<Large>();
+  int64_t t = 0;
+  for (auto _ : state) {
+    packet = std::move(packet).At(Timestamp(++t));
+    benchmark::DoNotOptimize(packet);
+  }
+}
+BENCHMARK(BM_PacketAt);
+
+template <typename T>
+void BM_PacketGet(benchmark::State& state) {
+  const Packet packet = MakePacket<T>();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(&packet.Get<T>());
+  }
+}
+BENCHMARK_TEMPLATE(BM_PacketGet, int);
+BENCHMARK_TEMPLATE(BM_PacketGet, Large);
+
+void BM_PacketValidateAsType(benchmark::State& state) {
+  const Packet packet = MakePacket<Large>();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(packet.ValidateAsType<Large>().ok());
+  }
+}
+BENCHMARK(BM_PacketValidateAsType);
+
+// A mismatch builds an error status with both type names.
+void BM_PacketValidateAsTypeMismatch(benchmark::State& state) {
+  const Packet packet = MakePacket<Large>();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(packet.ValidateAsType<Small>().ok());
+  }
+}
+BENCHMARK(BM_PacketValidateAsTypeMismatch);
+
+#if MEDIAPIPE_HAS_RTTI
+// The check Get<T>() would make with RTTI: compare std::type_index values.
+void BM_TypeidGet(benchmark::State& state) {
+  const std::type_index type = typeid(Large);
+  const std::shared_ptr<void> payload = std::make_shared<Large>();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(type);
+    if (type != std::type_index(typeid(Large))) state.SkipWithError("type");
+    benchmark::DoNotOptimize(static_cast<const Large*>(payload.get()));
+  }
+}
+BENCHMARK(BM_TypeidGet);
+#endif  // MEDIAPIPE_HAS_RTTI
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,169 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/packet_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "mediapipe/framework/counter_factory.h"
+
+namespace mediapipe {
+
+    namespace {
+        // Hits are counted on every allocation, so the counters must not
+        // contend between threads.
+        CounterFactory* PacketPoolCounterFactory() {
+          static CounterFactory* factory = new ShardedCounterFactory();
+          return factory;
+        }
+
+        std::atomic<int> next_pool_id{0};
+
+        // "mediapipe::packet_internal::Holder<Foo>" -> "Holder<Foo>".
+        std::string CounterPrefix(absl::string_view name) {
+          absl::ConsumePrefix(&name, "mediapipe::packet_internal::");
+          return absl::StrCat("PacketPool/", name, "/");
+        }
+    }  // namespace
+
+    CounterSet* PacketPoolCounters() {
+      return PacketPoolCounterFactory()->GetCounterSet();
+    }
+
+    namespace packet_internal {
+        // The free blocks the calling thread caches, for every pool. Returned
+        // to the depots when the thread exits.
+        struct ThreadCaches {
+          struct Cache {
+            HolderPool* pool = nullptr;
+            std::vector<void*> blocks;
+          };
+
+          ~ThreadCaches() {
+            destroyed = true;
+            for (Cache& cache : caches) {
+              if (cache.pool != nullptr) cache.pool->ReturnToDepot(&cache.blocks, 0);
+            }
+          }
+
+          // Returns the calling thread's cache for pool, or null while the
+          // thread is exiting.
+          static std::vector<void*>* For(HolderPool* pool) {
+            if (destroyed) return nullptr;
+            thread_local ThreadCaches thread_caches;
+            std::vector<Cache>& caches = thread_caches.caches;
+            if (pool->id_ >= static_cast<int>(caches.size())) {
+              caches.resize(pool->id_ + 1);
+            }
+            Cache& cache = caches[pool->id_];
+            cache.pool = pool;
+            return &cache.blocks;
+          }
+
+          static thread_local bool destroyed;
+          std::vector<Cache> caches;
+        };
+
+        thread_local bool ThreadCaches::destroyed = false;
+
+        HolderPool::HolderPool(std::string name, size_t block_size)
+            : id_(next_pool_id.fetch_add(1, std::memory_order_relaxed)),
+              block_size_(block_size),
+              hits_(PacketPoolCounterFactory()->GetCounter(
+                  absl::StrCat(CounterPrefix(name), "hits"))),
+              misses_(PacketPoolCounterFactory()->GetCounter(
+                  absl::StrCat(CounterPrefix(name), "misses"))),
+              high_water_(PacketPoolCounterFactory()->GetCounter(
+                  absl::StrCat(CounterPrefix(name), "high_water_blocks"))) {}
+
+        void* HolderPool::Allocate() {
+          std::vector<void*>* cache = ThreadCaches::For(this);
+          if (cache != nullptr) {
+            if (cache->empty()) TakeFromDepot(cache, kMaxCachedBlocks / 2);
+            if (!cache->empty()) {
+              void* block = cache->back();
+              cache->pop_back();
+              hits_->Increment();
+              return block;
+            }
+          } else {
+            std::vector<void*> blocks;
+            TakeFromDepot(&blocks, 1);
+            if (!blocks.empty()) {
+              hits_->Increment();
+              return blocks.front();
+            }
+          }
+          return AllocateFromHeap();
+        }
+
+        void HolderPool::Deallocate(void* block) {
+          std::vector<void*>* cache = ThreadCaches::For(this);
+          if (cache != nullptr) {
+            cache->push_back(block);
+            if (cache->size() > kMaxCachedBlocks) {
+              ReturnToDepot(cache, kMaxCachedBlocks / 2);
+            }
+          } else {
+            std::vector<void*> blocks = {block};
+            ReturnToDepot(&blocks, 0);
+          }
+        }
+
+        void HolderPool::TakeFromDepot(std::vector<void*>* blocks,
+                                       size_t max_blocks) {
+          absl::MutexLock lock(&mu_);
+          size_t count = std::min(max_blocks, depot_.size());
+          blocks->insert(blocks->end(), depot_.end() - count, depot_.end());
+          depot_.resize(depot_.size() - count);
+        }
+
+        void HolderPool::ReturnToDepot(std::vector<void*>* blocks, size_t first) {
+          size_t count = blocks->size() - first;
+          size_t kept = 0;
+          {
+            absl::MutexLock lock(&mu_);
+            kept = std::min(count, kMaxDepotBlocks - std::min(kMaxDepotBlocks,
+                                                              depot_.size()));
+            depot_.insert(depot_.end(), blocks->begin() + first,
+                          blocks->begin() + first + kept);
+          }
+          for (size_t i = first + kept; i < blocks->size(); ++i) {
+            ::operator delete((*blocks)[i]);
+          }
+          owned_blocks_.fetch_sub(count - kept, std::memory_order_relaxed);
+          blocks->resize(first);
+        }
+
+        void* HolderPool::AllocateFromHeap() {
+          misses_->Increment();
+          int64_t owned = owned_blocks_.fetch_add(1, std::memory_order_relaxed) + 1;
+          int64_t high_water = high_water_blocks_.load(std::memory_order_relaxed);
+          while (owned > high_water) {
+            if (high_water_blocks_.compare_exchange_weak(
+                    high_water, owned, std::memory_order_relaxed)) {
+              // Counters only grow, so publish the high water mark by deltas.
+              high_water_->IncrementBy(static_cast<int>(owned - high_water));
+              break;
+            }
+          }
+          return ::operator new(block_size_);
+        }
+    }  // namespace packet_internal
+
+}  // namespace mediapipe
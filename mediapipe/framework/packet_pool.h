@@ -0,0 +1,125 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Per-type pools of packet holder blocks. Every packet holder type (a holder
+// and its payload, which share one block) gets its own pool, so a block freed
+// by one packet is reused as-is by the next packet of the same type without
+// going through malloc. Each thread keeps a small cache of free blocks per
+// pool; blocks move between threads through a shared depot in batches.
+//
+// Pools report, per holder type (e.g. "Holder<Foo>" for MakePacket<Foo> and
+// "AdoptedHolder<Foo>" for Adopt), to PacketPoolCounters():
+//   PacketPool/<type>/hits               allocations served from a free block
+//   PacketPool/<type>/misses             allocations that went to the heap
+//   PacketPool/<type>/high_water_blocks  most blocks ever owned at once
+//
+// Define MEDIAPIPE_DISABLE_PACKET_POOL to allocate every holder with plain
+// operator new instead, e.g. for heap checkers.
+
+#ifndef CUSTOM_MEDIAPIPE_PACKET_POOL_H
+#define CUSTOM_MEDIAPIPE_PACKET_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/counter.h"
+#include "mediapipe/framework/tool/type_util.h"
+
+namespace mediapipe {
+    class CounterSet;
+
+    // The counters of all packet pools in the process.
+    CounterSet* PacketPoolCounters();
+
+    namespace packet_internal {
+        // A pool of equally sized blocks of raw memory. Pools are never
+        // destroyed, and blocks never go back to the heap while the pool holds
+        // fewer than kMaxDepotBlocks spare ones.
+        // This class is thread safe.
+        class HolderPool {
+          public:
+            // Blocks larger than this, or over-aligned, are not pooled.
+            static constexpr size_t kMaxBlockSize = 1024;
+            // Free blocks a thread keeps per pool before spilling half of them.
+            static constexpr size_t kMaxCachedBlocks = 64;
+            // Free blocks a pool keeps for all threads before freeing the rest.
+            static constexpr size_t kMaxDepotBlocks = 1024;
+
+            // Whether holders of type H are allocated from a pool.
+            template <typename H>
+            static constexpr bool kPooled =
+#ifdef MEDIAPIPE_DISABLE_PACKET_POOL
+                false;
+#else
+                sizeof(H) <= kMaxBlockSize &&
+                alignof(H) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+#endif  // MEDIAPIPE_DISABLE_PACKET_POOL
+
+            // Returns the pool for holders of type H. Requires kPooled<H>.
+            template <typename H>
+            static HolderPool& For() {
+              static_assert(kPooled<H>, "Holder type is not pooled");
+              static HolderPool* pool =
+                  new HolderPool(std::string(TypeName<H>()), sizeof(H));
+              return *pool;
+            }
+
+            HolderPool(const HolderPool&) = delete;
+            HolderPool& operator=(const HolderPool&) = delete;
+
+            // Returns an uninitialized block of block_size() bytes.
+            void* Allocate();
+            // Returns a block obtained from Allocate() on any thread.
+            void Deallocate(void* block);
+
+            size_t block_size() const { return block_size_; }
+
+          private:
+            HolderPool(std::string name, size_t block_size);
+
+            // Moves up to max_blocks spare blocks into blocks.
+            void TakeFromDepot(std::vector<void*>* blocks, size_t max_blocks)
+                ABSL_LOCKS_EXCLUDED(mu_);
+            // Moves blocks[first, end) to the depot, freeing what it can't take.
+            void ReturnToDepot(std::vector<void*>* blocks, size_t first)
+                ABSL_LOCKS_EXCLUDED(mu_);
+            void* AllocateFromHeap();
+
+            friend struct ThreadCaches;
+
+            // Index of this pool in the per-thread caches.
+            const int id_;
+            const size_t block_size_;
+
+            Counter* const hits_;
+            Counter* const misses_;
+            Counter* const high_water_;
+
+            // Blocks currently allocated from the heap, in use or spare.
+            std::atomic<int64_t> owned_blocks_{0};
+            std::atomic<int64_t> high_water_blocks_{0};
+
+            absl::Mutex mu_;
+            std::vector<void*> depot_ ABSL_GUARDED_BY(mu_);
+        };
+    }  // namespace packet_internal
+}  // namespace mediapipe
+
+#endif  // CUSTOM_MEDIAPIPE_PACKET_POOL_H
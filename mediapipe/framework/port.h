@@ -25,7 +25,7 @@
 // we also try to set platform-specific defines in this header if missing.
 #if !defined(MEDIAPIPE_MOBILE) && \
     (defined(__ANDROID__) || defined(__EMSCRIPTEN__))
-#define MEFIAPIPE_MOBILE
+#define MEDIAPIPE_MOBILE
 #endif
 
 #if !defined(MEDIAPIPE_ANDROID) && defined(__ANDROID__)
@@ -50,9 +50,9 @@
 // These platforms do not support OpenGL ES Compute Shaders (v3.1 and up),
 // but may or may not still be able to run other OpenGL code.
 #if !defined(MEDIAPIPE_DISABLE_GL_COMPUTE) &&                                \
-    (defined(__APPLE__) || defined(__EMSCRIPTEN__) || MEDIAPIPE_DISABLE_GPU) \
-    MEDIAPIPE_USING_LEGACY_SWIFTSHADER)
-#define MEDIAIPE_DISABLE_GL_COMPUTE
+    (defined(__APPLE__) || defined(__EMSCRIPTEN__) || MEDIAPIPE_DISABLE_GPU || \
+     MEDIAPIPE_USING_LEGACY_SWIFTSHADER)
+#define MEDIAPIPE_DISABLE_GL_COMPUTE
 #endif
 
 // Compile time target platform definitions.
@@ -82,7 +82,7 @@
 #elif defined(MEDIAPIPE_OSX)
 #define MEDIAPIPE_OPENGL_ES_VERSION 0
 #define MEDIAPIPE_METAL_ENABLED 1
-#elif defined(__EMSCRIPTEN)
+#elif defined(__EMSCRIPTEN__)
 // WebGL config.
 #define MEDIAPIPE_OPENGL_ES_VERSION MEDIAPIPE_OPENGL_ES_30
 #define MEDIAPIPE_METAL_ENABLED 0
@@ -104,7 +104,7 @@
 // Detect if RTTI is disabled in the compiler.
 #if defined(__clang__) && defined(__has_feature)
 #define MEDIAPIPE_HAS_RTTI __has_feature(cxx_rtti)
-#if defined(__GNUC__) && !defined(__GXX_RTTI)
+#elif defined(__GNUC__) && !defined(__GXX_RTTI)
 #define MEDIAPIPE_HAS_RTTI 0
 #elif defined(_MSC_VER) && !defined(_CPPRTTI)
 #define MEDIAPIPE_HAS_RTTI 0
@@ -0,0 +1,22 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_PORT_GTEST_H_
+#define MEDIAPIPE_PORT_GTEST_H_
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+#endif  // MEDIAPIPE_PORT_GTEST_H_
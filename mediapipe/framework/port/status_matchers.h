@@ -0,0 +1,25 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_PORT_STATUS_MATCHERS_H_
+#define MEDIAPIPE_PORT_STATUS_MATCHERS_H_
+
+#include "gtest/gtest.h"
+#include "mediapipe/framework/port/status.h"
+
+// Macros for testing the results of functions that return absl::Status.
+#define MP_EXPECT_OK(expression) EXPECT_EQ(absl::OkStatus(), (expression))
+#define MP_ASSERT_OK(expression) ASSERT_EQ(absl::OkStatus(), (expression))
+
+#endif  // MEDIAPIPE_PORT_STATUS_MATCHERS_H_
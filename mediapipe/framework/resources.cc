@@ -0,0 +1,209 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/resources.h"
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+
+#ifdef _WIN32
+#include <fstream>
+#include <sstream>
+#else
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mediapipe {
+    namespace {
+
+    absl::Status ErrnoError(absl::string_view what, const std::string& path) {
+      int error = errno;
+      std::string message =
+          absl::StrCat("Failed to ", what, " \"", path, "\": ", strerror(error));
+      return error == ENOENT ? absl::NotFoundError(message)
+                             : absl::UnavailableError(message);
+    }
+
+    // A whole file, mapped read-only. Once mapped, removes itself from the
+    // cache when the last handle to it is gone.
+    class MappedFile {
+      public:
+        explicit MappedFile(std::string path) : path_(std::move(path)) {}
+        ~MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        absl::Status Map();
+        // Asynchronous; returns before any data is read.
+        void Prefetch() const;
+
+        absl::string_view data() const { return {data_, size_}; }
+
+      private:
+        const std::string path_;
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+        bool mapped_ = false;
+#ifdef _WIN32
+        std::string contents_;
+#endif
+    };
+
+    // Maps each file once per process. Entries do not keep their file
+    // mapped; the handles do.
+    class MappedFileCache {
+      public:
+        static MappedFileCache& Get() {
+          // Never destroyed: handles may outlive static destruction.
+          static MappedFileCache* cache = new MappedFileCache();
+          return *cache;
+        }
+
+        absl::StatusOr<std::shared_ptr<const MappedFile>> Load(
+            absl::string_view path) ABSL_LOCKS_EXCLUDED(mu_);
+        void Remove(const std::string& path) ABSL_LOCKS_EXCLUDED(mu_);
+
+      private:
+        absl::Mutex mu_;
+        absl::flat_hash_map<std::string, std::weak_ptr<const MappedFile>> files_
+            ABSL_GUARDED_BY(mu_);
+    };
+
+    absl::StatusOr<std::string> CanonicalPath(absl::string_view path) {
+      std::string path_string(path);
+#ifdef _WIN32
+      return path_string;
+#else
+      char* resolved = realpath(path_string.c_str(), nullptr);
+      if (resolved == nullptr) return ErrnoError("resolve", path_string);
+      std::string result(resolved);
+      free(resolved);
+      return result;
+#endif
+    }
+
+    absl::StatusOr<std::shared_ptr<const MappedFile>> MappedFileCache::Load(
+        absl::string_view path) {
+      absl::StatusOr<std::string> key = CanonicalPath(path);
+      if (!key.ok()) return key.status();
+      absl::MutexLock lock(&mu_);
+      std::weak_ptr<const MappedFile>& entry = files_[*key];
+      if (std::shared_ptr<const MappedFile> file = entry.lock()) return file;
+      // Maps under the lock, so that concurrent first loads of a file share
+      // one mapping. Mapping does not read the file, so this is quick.
+      auto file = std::make_shared<MappedFile>(*key);
+      absl::Status status = file->Map();
+      if (!status.ok()) {
+        files_.erase(*key);
+        return status;
+      }
+      entry = file;
+      return std::shared_ptr<const MappedFile>(std::move(file));
+    }
+
+    void MappedFileCache::Remove(const std::string& path) {
+      absl::MutexLock lock(&mu_);
+      auto it = files_.find(path);
+      // A new mapping of the file may have replaced the entry already.
+      if (it != files_.end() && it->second.expired()) files_.erase(it);
+    }
+
+#ifdef _WIN32
+    MappedFile::~MappedFile() {
+      if (mapped_) MappedFileCache::Get().Remove(path_);
+    }
+
+    absl::Status MappedFile::Map() {
+      std::ifstream stream(path_, std::ios::binary);
+      if (!stream) return ErrnoError("open", path_);
+      std::ostringstream contents;
+      contents << stream.rdbuf();
+      contents_ = std::move(contents).str();
+      data_ = contents_.data();
+      size_ = contents_.size();
+      mapped_ = true;
+      return absl::OkStatus();
+    }
+
+    void MappedFile::Prefetch() const {}
+#else
+    MappedFile::~MappedFile() {
+      if (!mapped_) return;
+      if (size_ > 0) munmap(const_cast<char*>(data_), size_);
+      MappedFileCache::Get().Remove(path_);
+    }
+
+    absl::Status MappedFile::Map() {
+      int fd = open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+      if (fd < 0) return ErrnoError("open", path_);
+      struct stat info;
+      if (fstat(fd, &info) != 0) {
+        absl::Status status = ErrnoError("stat", path_);
+        close(fd);
+        return status;
+      }
+      size_ = static_cast<size_t>(info.st_size);
+      // An empty file cannot be mapped, nor does it need to be.
+      if (size_ > 0) {
+        void* data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED) {
+          absl::Status status = ErrnoError("map", path_);
+          size_ = 0;
+          close(fd);
+          return status;
+        }
+        data_ = static_cast<const char*>(data);
+      }
+      // The mapping keeps the file open.
+      close(fd);
+      mapped_ = true;
+      return absl::OkStatus();
+    }
+
+    void MappedFile::Prefetch() const {
+      if (size_ > 0) madvise(const_cast<char*>(data_), size_, MADV_WILLNEED);
+    }
+#endif
+
+    class DefaultResources : public Resources {
+      public:
+        absl::StatusOr<Resource> Get(absl::string_view resource_id,
+                                     const Options& options) const override {
+          absl::StatusOr<std::shared_ptr<const MappedFile>> file =
+              MappedFileCache::Get().Load(resource_id);
+          if (!file.ok()) return file.status();
+          if (options.prefetch) (*file)->Prefetch();
+          absl::string_view data = (*file)->data();
+          return Resource(*std::move(file), data);
+        }
+    };
+
+    }  // namespace
+
+    std::unique_ptr<Resources> CreateDefaultResources() {
+      return std::make_unique<DefaultResources>();
+    }
+
+}  // namespace mediapipe
@@ -0,0 +1,81 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Read-only data that calculators load by name, such as model files.
+
+#ifndef CUSTOM_MEDIAPIPE_RESOURCES_H
+#define CUSTOM_MEDIAPIPE_RESOURCES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "mediapipe/framework/graph_service.h"
+
+namespace mediapipe {
+    // A handle to the contents of a resource. Copies are cheap and share the
+    // data, which stays valid as long as any handle to it exists.
+    class Resource {
+      public:
+        Resource() = default;
+        // data must stay valid as long as owner does.
+        Resource(std::shared_ptr<const void> owner, absl::string_view data)
+            : owner_(std::move(owner)), data_(data) {}
+
+        absl::string_view data() const { return data_; }
+        absl::Span<const uint8_t> bytes() const {
+          return {reinterpret_cast<const uint8_t*>(data_.data()), data_.size()};
+        }
+        size_t size() const { return data_.size(); }
+
+      private:
+        std::shared_ptr<const void> owner_;
+        absl::string_view data_;
+    };
+
+    // Loads resources by id. Implementations must be thread safe.
+    class Resources {
+      public:
+        struct Options {
+          // Asks the OS to start reading the data in the background, so that
+          // the first accesses do not wait for the disk.
+          bool prefetch = false;
+        };
+
+        virtual ~Resources() = default;
+
+        virtual absl::StatusOr<Resource> Get(absl::string_view resource_id,
+                                             const Options& options) const = 0;
+        absl::StatusOr<Resource> Get(absl::string_view resource_id) const {
+          return Get(resource_id, Options());
+        }
+    };
+
+    // Returns Resources that read the file at path resource_id. Files are
+    // memory-mapped read-only, and a file is mapped once per process: every
+    // Get() of it, from any graph, shares the mapping until the last handle
+    // is gone. The data is paged in on first access, not when loaded.
+    std::unique_ptr<Resources> CreateDefaultResources();
+
+    // The Resources of a graph; see CalculatorContext::GetResources(). Unless
+    // the application sets its own, the graph uses CreateDefaultResources().
+    inline constexpr GraphService<Resources> kResourcesService(
+        "mediapipe::kResourcesService");
+}  // namespace mediapipe
+
+#endif  // CUSTOM_MEDIAPIPE_RESOURCES_H
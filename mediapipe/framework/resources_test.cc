@@ -0,0 +1,149 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/resources.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_graph.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kNumGraphs = 50;
+// A model file of realistic size. It is sparse, so it takes neither disk
+// space nor time to write, and reads as zeros.
+constexpr int64_t kModelBytes = int64_t{500} << 20;
+// Read through every graph's handle. Private copies would make this
+// kNumGraphs times resident.
+constexpr int64_t kTouchedBytes = int64_t{16} << 20;
+
+// Creates the model file and returns its canonical path, as /proc/self/maps
+// shows it.
+std::string MakeModelFile() {
+  const std::string path =
+      absl::StrCat(::testing::TempDir(), "/resources_test_model.bin");
+  const int fd = open(path.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+  EXPECT_GE(fd, 0);
+  EXPECT_EQ(ftruncate(fd, kModelBytes), 0);
+  close(fd);
+  char* resolved = realpath(path.c_str(), nullptr);
+  EXPECT_NE(resolved, nullptr);
+  std::string result(resolved);
+  free(resolved);
+  return result;
+}
+
+// The number of mappings of path in this process.
+int NumMappings(const std::string& path) {
+  std::ifstream maps("/proc/self/maps");
+  int count = 0;
+  for (std::string line; std::getline(maps, line);) {
+    if (line.size() >= path.size() &&
+        line.compare(line.size() - path.size(), path.size(), path) == 0) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+// A size from /proc/self/status, e.g. "VmSize" or "RssFile", in bytes.
+int64_t StatusBytes(absl::string_view field) {
+  std::ifstream status("/proc/self/status");
+  const std::string prefix = absl::StrCat(field, ":");
+  for (std::string line; std::getline(status, line);) {
+    absl::string_view rest = line;
+    if (!absl::ConsumePrefix(&rest, prefix)) continue;
+    absl::ConsumeSuffix(&rest, "kB");
+    int64_t kb = 0;
+    EXPECT_TRUE(absl::SimpleAtoi(rest, &kb)) << line;
+    return kb * 1024;
+  }
+  ADD_FAILURE() << "No " << field << " in /proc/self/status.";
+  return 0;
+}
+
+// Reads a byte of every page of the first bytes of data.
+int TouchPages(absl::string_view data, int64_t bytes) {
+  int sum = 0;
+  for (int64_t i = 0; i < bytes; i += 4096) {
+    sum += static_cast<const volatile char*>(data.data())[i];
+  }
+  return sum;
+}
+
+TEST(ResourcesTest, GraphsShareOneMappingOfAFile) {
+#ifndef __linux__
+  GTEST_SKIP() << "Reads /proc/self/maps and /proc/self/status.";
+#endif
+  const std::string path = MakeModelFile();
+  ASSERT_EQ(NumMappings(path), 0);
+  const int64_t vm_size_before = StatusBytes("VmSize");
+
+  CalculatorGraphConfig config;
+  config.set_num_threads(1);
+  config.add_prefetch_resource(path);
+  std::vector<std::unique_ptr<CalculatorGraph>> graphs;
+  std::vector<Resource> resources;
+  for (int i = 0; i < kNumGraphs; ++i) {
+    graphs.push_back(std::make_unique<CalculatorGraph>());
+    MP_ASSERT_OK(graphs.back()->Initialize(config));
+    // Every graph has its own Resources, yet gets the same data.
+    absl::StatusOr<Resource> resource =
+        graphs.back()->GetServiceObject(kResourcesService)->Get(path);
+    MP_ASSERT_OK(resource.status());
+    ASSERT_EQ(resource->size(), kModelBytes);
+    if (!resources.empty()) {
+      EXPECT_EQ(resource->data().data(), resources.front().data().data());
+    }
+    resources.push_back(*std::move(resource));
+  }
+  EXPECT_EQ(NumMappings(path), 1);
+  // kNumGraphs mappings would take kNumGraphs * kModelBytes of address
+  // space.
+  EXPECT_LT(StatusBytes("VmSize") - vm_size_before, 2 * kModelBytes);
+
+  const int64_t rss_file_before = StatusBytes("RssFile");
+  int sum = 0;
+  for (const Resource& resource : resources) {
+    sum += TouchPages(resource.data(), kTouchedBytes);
+  }
+  EXPECT_EQ(sum, 0);
+  EXPECT_LT(StatusBytes("RssFile") - rss_file_before, 2 * kTouchedBytes);
+
+  resources.clear();
+  graphs.resize(1);
+  EXPECT_EQ(NumMappings(path), 1);
+  graphs.clear();
+  EXPECT_EQ(NumMappings(path), 0);
+  unlink(path.c_str());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,167 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/scheduler.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/log/absl_check.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+
+namespace mediapipe {
+    namespace internal {
+
+        Scheduler::Executor::Executor(const ExecutorOptions& options,
+                                      CounterFactory* counter_factory)
+            : queue_depth(counter_factory->GetHistogram(
+                  absl::StrCat("Executor/", options.name, "/queue_depth"))),
+              busy_us(counter_factory->GetCounter(
+                  absl::StrCat("Executor/", options.name, "/busy_us"))),
+              pool(options.name, options.num_threads, options.thread_options) {}
+
+        Scheduler::Scheduler(const std::vector<ExecutorOptions>& executors,
+                             CounterFactory* counter_factory) {
+          ABSL_CHECK(!executors.empty());
+          for (const ExecutorOptions& options : executors) {
+            executors_.push_back(
+                std::make_unique<Executor>(options, counter_factory));
+          }
+        }
+
+        Scheduler::~Scheduler() {
+          std::thread timer_thread;
+          {
+            absl::MutexLock lock(&timer_mu_);
+            stop_timers_ = true;
+            timer_thread = std::move(timer_thread_);
+          }
+          timer_cv_.Signal();
+          if (timer_thread.joinable()) timer_thread.join();
+        }
+
+        void Scheduler::Start(int num_nodes) {
+          {
+            absl::MutexLock lock(&state_mu_);
+            num_open_nodes_ = num_nodes;
+          }
+          for (const auto& executor : executors_) executor->pool.StartWorkers();
+        }
+
+        void Scheduler::Schedule(std::function<void()> task, int priority,
+                                 int executor) {
+          num_pending_tasks_.fetch_add(1, std::memory_order_relaxed);
+          Dispatch(std::move(task), priority, executor);
+        }
+
+        int64_t Scheduler::ScheduleAfter(absl::Duration delay,
+                                         std::function<void()> task,
+                                         int priority, int executor) {
+          num_pending_tasks_.fetch_add(1, std::memory_order_relaxed);
+          absl::MutexLock lock(&timer_mu_);
+          int64_t id = next_timer_id_++;
+          timers_.emplace(absl::Now() + delay,
+                          DelayedTask{id, std::move(task), priority, executor});
+          if (!timer_thread_.joinable()) {
+            timer_thread_ = std::thread([this] { RunTimers(); });
+          }
+          timer_cv_.Signal();
+          return id;
+        }
+
+        void Scheduler::CancelDelayed(int64_t id) {
+          {
+            absl::MutexLock lock(&timer_mu_);
+            // Only a few tasks wait at any time, at most one per node.
+            auto it = std::find_if(
+                timers_.begin(), timers_.end(),
+                [id](const auto& timer) { return timer.second.id == id; });
+            if (it == timers_.end()) return;
+            timers_.erase(it);
+          }
+          TaskDone();
+        }
+
+        void Scheduler::RunTimers() {
+          absl::MutexLock lock(&timer_mu_);
+          while (!stop_timers_) {
+            if (timers_.empty()) {
+              timer_cv_.Wait(&timer_mu_);
+              continue;
+            }
+            auto first = timers_.begin();
+            if (absl::Now() < first->first) {
+              timer_cv_.WaitWithDeadline(&timer_mu_, first->first);
+              continue;
+            }
+            DelayedTask delayed = std::move(first->second);
+            timers_.erase(first);
+            Dispatch(std::move(delayed.task), delayed.priority,
+                     delayed.executor);
+          }
+        }
+
+        void Scheduler::Dispatch(std::function<void()> task, int priority,
+                                 int executor) {
+          Executor* target = executors_[executor].get();
+          target->queue_depth->Record(target->pool.NumQueued());
+          target->pool.Schedule(
+              [this, target, task = std::move(task)] {
+                // Differences of truncated readings, so that short tasks
+                // add up without a bias.
+                int64_t start = absl::GetCurrentTimeNanos() / 1000;
+                task();
+                target->busy_us->IncrementBy(static_cast<int>(
+                    absl::GetCurrentTimeNanos() / 1000 - start));
+                TaskDone();
+              },
+              priority);
+        }
+
+        void Scheduler::TaskDone() {
+          if (num_pending_tasks_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            {
+              // Lets waiters re-evaluate IsIdle().
+              absl::MutexLock lock(&state_mu_);
+            }
+            if (idle_callback_) idle_callback_();
+          }
+        }
+
+        void Scheduler::RecordError(const absl::Status& error) {
+          absl::MutexLock lock(&state_mu_);
+          if (error_.ok()) error_ = error;
+          has_error_.store(true, std::memory_order_release);
+        }
+
+        void Scheduler::NodeClosed() {
+          absl::MutexLock lock(&state_mu_);
+          --num_open_nodes_;
+        }
+
+        absl::Status Scheduler::WaitUntilIdle() {
+          absl::MutexLock lock(&state_mu_);
+          state_mu_.Await(absl::Condition(this, &Scheduler::IsIdle));
+          return error_;
+        }
+
+        absl::Status Scheduler::WaitUntilDone() {
+          absl::MutexLock lock(&state_mu_);
+          state_mu_.Await(absl::Condition(this, &Scheduler::IsDone));
+          return error_;
+        }
+
+    }  // namespace internal
+}  // namespace mediapipe
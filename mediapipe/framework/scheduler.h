@@ -0,0 +1,169 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CUSTOM_MEDIAPIPE_SCHEDULER_H
+#define CUSTOM_MEDIAPIPE_SCHEDULER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/counter.h"
+#include "mediapipe/framework/counter_factory.h"
+#include "mediapipe/framework/deps/work_stealing_thread_pool.h"
+#include "mediapipe/framework/histogram.h"
+
+namespace mediapipe {
+    namespace internal {
+        // A named work-stealing thread pool of the scheduler.
+        struct ExecutorOptions {
+          std::string name;
+          int num_threads = 1;
+          WorkStealingThreadPool::ThreadOptions thread_options;
+        };
+
+        // Runs the tasks of one graph run on executors, which are
+        // work-stealing thread pools, and tracks when the run is idle (no task
+        // queued, waiting for its delay or running) and done (every node
+        // closed, or an error occurred, and the run is idle).
+        //
+        // Each executor reports to the counter factory:
+        //   Executor/<name>/queue_depth  histogram of the tasks waiting for a
+        //                                worker, sampled as tasks are queued
+        //   Executor/<name>/busy_us      microseconds its workers spent
+        //                                running tasks; divided by the
+        //                                elapsed time and the number of
+        //                                threads, the executor's utilization
+        // This class is thread safe.
+        class Scheduler {
+          public:
+            // Executor 0 is the default one. There must be at least one.
+            Scheduler(const std::vector<ExecutorOptions>& executors,
+                      CounterFactory* counter_factory);
+            // Waits for all scheduled tasks to finish. Delayed tasks that are
+            // still waiting are dropped.
+            ~Scheduler();
+            Scheduler(const Scheduler&) = delete;
+            Scheduler& operator=(const Scheduler&) = delete;
+
+            // Called, without locks held, whenever the last pending task
+            // finishes. Must be set before Start().
+            void SetIdleCallback(std::function<void()> callback) {
+              idle_callback_ = std::move(callback);
+            }
+
+            // Starts the worker threads. num_nodes is the number of
+            // NodeClosed() calls that complete the run.
+            void Start(int num_nodes) ABSL_LOCKS_EXCLUDED(state_mu_);
+
+            // Runs task on a worker of the given executor. Tasks with a
+            // higher priority run first among those of the executor.
+            void Schedule(std::function<void()> task, int priority,
+                          int executor = 0);
+            // Same, once delay has passed. The task is pending, and the run
+            // not idle, while it waits. Returns an id for CancelDelayed().
+            int64_t ScheduleAfter(absl::Duration delay, std::function<void()> task,
+                                  int priority, int executor = 0)
+                ABSL_LOCKS_EXCLUDED(timer_mu_);
+            // Drops a task of ScheduleAfter() that is still waiting. Tasks
+            // already handed to a worker run regardless.
+            void CancelDelayed(int64_t id) ABSL_LOCKS_EXCLUDED(timer_mu_);
+
+            // Records an error for the run. Only the first one is kept. Tasks
+            // should check HasError() and skip calculator code after an error.
+            void RecordError(const absl::Status& error) ABSL_LOCKS_EXCLUDED(state_mu_);
+            bool HasError() const {
+              return has_error_.load(std::memory_order_acquire);
+            }
+
+            void NodeClosed() ABSL_LOCKS_EXCLUDED(state_mu_);
+
+            // Whether no task is queued or running. A snapshot.
+            bool IsIdleNow() const {
+              return num_pending_tasks_.load(std::memory_order_acquire) == 0;
+            }
+
+            // Both return the error of the run, if any.
+            absl::Status WaitUntilIdle() ABSL_LOCKS_EXCLUDED(state_mu_);
+            absl::Status WaitUntilDone() ABSL_LOCKS_EXCLUDED(state_mu_);
+
+          private:
+            struct DelayedTask {
+              int64_t id;
+              std::function<void()> task;
+              int priority;
+              int executor;
+            };
+
+            struct Executor {
+              Executor(const ExecutorOptions& options,
+                       CounterFactory* counter_factory);
+
+              Histogram* const queue_depth;
+              Counter* const busy_us;
+              WorkStealingThreadPool pool;
+            };
+
+            // Hands a task counted in num_pending_tasks_ to an executor.
+            void Dispatch(std::function<void()> task, int priority,
+                          int executor);
+            // Uncounts a finished or dropped task.
+            void TaskDone();
+            // Body of the timer thread: dispatches delayed tasks when due.
+            void RunTimers() ABSL_LOCKS_EXCLUDED(timer_mu_);
+
+            bool IsIdle() const ABSL_SHARED_LOCKS_REQUIRED(state_mu_) {
+              return IsIdleNow();
+            }
+            // Also waits for running tasks, which may still use their node
+            // after calling NodeClosed().
+            bool IsDone() const ABSL_SHARED_LOCKS_REQUIRED(state_mu_) {
+              return (num_open_nodes_ == 0 || !error_.ok()) && IsIdle();
+            }
+
+            // Scheduled tasks that have not finished yet.
+            std::atomic<int64_t> num_pending_tasks_{0};
+            std::atomic<bool> has_error_{false};
+            std::function<void()> idle_callback_;
+
+            mutable absl::Mutex state_mu_;
+            absl::Status error_ ABSL_GUARDED_BY(state_mu_);
+            int num_open_nodes_ ABSL_GUARDED_BY(state_mu_) = 0;
+
+            // Delayed tasks by deadline. The timer thread is only started by
+            // the first ScheduleAfter().
+            absl::Mutex timer_mu_;
+            absl::CondVar timer_cv_;
+            std::multimap<absl::Time, DelayedTask> timers_
+                ABSL_GUARDED_BY(timer_mu_);
+            int64_t next_timer_id_ ABSL_GUARDED_BY(timer_mu_) = 0;
+            bool stop_timers_ ABSL_GUARDED_BY(timer_mu_) = false;
+            std::thread timer_thread_ ABSL_GUARDED_BY(timer_mu_);
+
+            // Destroyed first, so the workers finish before the state goes.
+            std::vector<std::unique_ptr<Executor>> executors_;
+        };
+    }  // namespace internal
+}  // namespace mediapipe
+
+#endif  // CUSTOM_MEDIAPIPE_SCHEDULER_H
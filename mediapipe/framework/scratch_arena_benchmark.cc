@@ -0,0 +1,119 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// A calculator that builds many small temporaries per frame, as feature
+// extraction and post-processing calculators do, allocating them from the
+// heap or from its scratch arena (CalculatorContext::Scratch()).
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_graph.h"
+#include "mediapipe/framework/deps/arena.h"
+#include "mediapipe/framework/port/benchmark.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kNumFrames = 200;
+constexpr int kNumTemporaries = 64;
+
+// Fills kNumTemporaries growing vectors, allocated with allocator, and
+// returns a value depending on all of them.
+template <typename Allocator>
+float BuildTemporaries(const Allocator& allocator) {
+  using Vector = std::vector<float, Allocator>;
+  using VectorAllocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<Vector>;
+  std::vector<Vector, VectorAllocator> rows{VectorAllocator(allocator)};
+  float sum = 0;
+  for (int i = 0; i < kNumTemporaries; ++i) {
+    rows.emplace_back(allocator);
+    for (int j = 0; j < 32 + i; ++j) rows.back().push_back(j);
+    sum += rows.back().back();
+  }
+  return sum;
+}
+
+class HeapTemporariesCalculator : public CalculatorBase {
+ public:
+  absl::Status Process(CalculatorContext* /*cc*/) override {
+    benchmark::DoNotOptimize(BuildTemporaries(std::allocator<float>()));
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(HeapTemporariesCalculator);
+
+class ScratchTemporariesCalculator : public CalculatorBase {
+ public:
+  absl::Status Process(CalculatorContext* cc) override {
+    benchmark::DoNotOptimize(
+        BuildTemporaries(ArenaAllocator<float>(cc->Scratch())));
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(ScratchTemporariesCalculator);
+
+// Only sending the frames and draining the graph is timed. Reports the
+// node's scratch counters per frame.
+void BM_Temporaries(benchmark::State& state, const char* calculator) {
+  CalculatorGraphConfig config;
+  config.set_num_threads(1);
+  config.add_input_stream("in");
+  CalculatorGraphConfig::Node* node = config.add_node();
+  node->set_name("temporaries");
+  node->set_calculator(calculator);
+  node->add_input_stream("in");
+  int64_t scratch_allocations = 0;
+  int64_t scratch_heap_allocations = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    CalculatorGraph graph;
+    ABSL_CHECK_OK(graph.Initialize(config));
+    ABSL_CHECK_OK(graph.StartRun());
+    state.ResumeTiming();
+    for (int i = 0; i < kNumFrames; ++i) {
+      ABSL_CHECK_OK(graph.AddPacketToInputStream(
+          "in", MakePacket<int>(i).At(Timestamp(i))));
+    }
+    ABSL_CHECK_OK(graph.CloseAllInputStreams());
+    ABSL_CHECK_OK(graph.WaitUntilDone());
+    state.PauseTiming();
+    CounterFactory* counters = graph.GetCounterFactory();
+    scratch_allocations +=
+        counters->GetCounter("Node/temporaries/scratch_allocations")->Get();
+    scratch_heap_allocations +=
+        counters->GetCounter("Node/temporaries/scratch_heap_allocations")
+            ->Get();
+    state.ResumeTiming();
+  }
+  const double num_frames = static_cast<double>(state.iterations()) * kNumFrames;
+  state.SetItemsProcessed(state.iterations() * kNumFrames);
+  state.counters["scratch_allocs_per_frame"] =
+      scratch_allocations / num_frames;
+  state.counters["scratch_heap_allocs_per_frame"] =
+      scratch_heap_allocations / num_frames;
+}
+BENCHMARK_CAPTURE(BM_Temporaries, Heap, "HeapTemporariesCalculator")
+    ->UseRealTime();
+BENCHMARK_CAPTURE(BM_Temporaries, Scratch, "ScratchTemporariesCalculator")
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,54 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/stream_handler/default_input_stream_handler.h"
+
+namespace mediapipe {
+
+    REGISTER_INPUT_STREAM_HANDLER(DefaultInputStreamHandler);
+
+    void DefaultInputStreamHandler::Initialize(
+        std::vector<InputStreamManager*> inputs) {
+      InputStreamHandler::Initialize(std::move(inputs));
+      heap_ = std::make_unique<IndexedMinHeap<Key>>(
+          static_cast<int>(inputs_.size()), Key(Timestamp::PreStream(), false));
+    }
+
+    void DefaultInputStreamHandler::InputChanged(int id) {
+      bool has_packet;
+      Timestamp timestamp = inputs_[id]->NextTimestamp(&has_packet);
+      heap_->Update(id, Key(timestamp, has_packet));
+    }
+
+    InputStreamHandler::NodeReadiness DefaultInputStreamHandler::GetNodeReadiness(
+        Timestamp* timestamp) {
+      if (heap_->Size() == 0) return NodeReadiness::kReadyForClose;
+      const Key& next = heap_->TopKey();
+      if (next.first == Timestamp::Done()) return NodeReadiness::kReadyForClose;
+      *timestamp = next.first;
+      return next.second ? NodeReadiness::kReadyForProcess
+                         : NodeReadiness::kNotReady;
+    }
+
+    void DefaultInputStreamHandler::FillInputSet(Timestamp timestamp,
+                                                 InputStreamShardSet* inputs) {
+      // The inputs with a packet at timestamp are exactly those at the top.
+      while (heap_->TopKey() == Key(timestamp, true)) {
+        int id = heap_->Top();
+        SetPacket(&inputs->Get(id), inputs_[id]->PopPacketAtTimestamp(timestamp));
+        InputChanged(id);
+      }
+    }
+
+}  // namespace mediapipe
@@ -0,0 +1,56 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CUSTOM_MEDIAPIPE_STREAM_HANDLER_DEFAULT_INPUT_STREAM_HANDLER_H
+#define CUSTOM_MEDIAPIPE_STREAM_HANDLER_DEFAULT_INPUT_STREAM_HANDLER_H
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "mediapipe/framework/deps/indexed_min_heap.h"
+#include "mediapipe/framework/input_stream_handler.h"
+
+namespace mediapipe {
+    // Synchronizes the input streams: Process() is called for timestamp T
+    // once some input has a packet at T and every other input is known to
+    // have none below or at T, either because its next packet is later or
+    // because its timestamp bound is past T. Inputs without a packet at T are
+    // empty in the context. Timestamps of successive Process() calls
+    // increase.
+    //
+    // The inputs are kept in a min-heap keyed by (next timestamp, has
+    // packet), where an input without a packet at its next timestamp sorts
+    // before inputs with one. The node is ready iff the top of the heap has a
+    // packet, so a change to one input costs O(log n) and a readiness check
+    // O(1), regardless of the number of inputs.
+    class DefaultInputStreamHandler : public InputStreamHandler {
+      public:
+        DefaultInputStreamHandler() = default;
+
+        void Initialize(std::vector<InputStreamManager*> inputs) override;
+        void InputChanged(int id) override;
+        NodeReadiness GetNodeReadiness(Timestamp* timestamp) override;
+        void FillInputSet(Timestamp timestamp,
+                          InputStreamShardSet* inputs) override;
+
+      private:
+        // (next timestamp, whether the input has a packet there).
+        using Key = std::pair<Timestamp, bool>;
+
+        std::unique_ptr<IndexedMinHeap<Key>> heap_;
+    };
+}  // namespace mediapipe
+
+#endif  // CUSTOM_MEDIAPIPE_STREAM_HANDLER_DEFAULT_INPUT_STREAM_HANDLER_H
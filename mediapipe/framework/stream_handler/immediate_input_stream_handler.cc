@@ -0,0 +1,80 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "mediapipe/framework/deps/indexed_min_heap.h"
+#include "mediapipe/framework/input_stream_handler.h"
+
+namespace mediapipe {
+
+    // Calls Process() as soon as any input has a packet, with the queued
+    // packets at the smallest queued timestamp; all other inputs are empty.
+    // Inputs are not synchronized, so the input timestamps of successive
+    // Process() calls may decrease when packets arrive out of order across
+    // streams. Calculators using this handler must not set output offsets.
+    class ImmediateInputStreamHandler : public InputStreamHandler {
+      public:
+        ImmediateInputStreamHandler() = default;
+
+        void Initialize(std::vector<InputStreamManager*> inputs) override {
+          InputStreamHandler::Initialize(std::move(inputs));
+          const int size = static_cast<int>(inputs_.size());
+          packets_ = std::make_unique<IndexedMinHeap<Timestamp>>(
+              size, Timestamp::Done());
+          bounds_ = std::make_unique<IndexedMinHeap<Timestamp>>(
+              size, Timestamp::PreStream());
+        }
+
+        void InputChanged(int id) override {
+          bool has_packet;
+          Timestamp timestamp = inputs_[id]->NextTimestamp(&has_packet);
+          packets_->Update(id, has_packet ? timestamp : Timestamp::Done());
+          bounds_->Update(id, timestamp);
+        }
+
+        NodeReadiness GetNodeReadiness(Timestamp* timestamp) override {
+          if (packets_->Size() == 0) return NodeReadiness::kReadyForClose;
+          if (packets_->TopKey() != Timestamp::Done()) {
+            *timestamp = packets_->TopKey();
+            return NodeReadiness::kReadyForProcess;
+          }
+          if (bounds_->TopKey() == Timestamp::Done()) {
+            return NodeReadiness::kReadyForClose;
+          }
+          *timestamp = bounds_->TopKey();
+          return NodeReadiness::kNotReady;
+        }
+
+        void FillInputSet(Timestamp timestamp,
+                          InputStreamShardSet* inputs) override {
+          while (packets_->TopKey() == timestamp) {
+            int id = packets_->Top();
+            SetPacket(&inputs->Get(id),
+                      inputs_[id]->PopPacketAtTimestamp(timestamp));
+            InputChanged(id);
+          }
+        }
+
+      private:
+        // Timestamp of each input's first queued packet, or Done() if none.
+        std::unique_ptr<IndexedMinHeap<Timestamp>> packets_;
+        // Next timestamp of each input, packet or bound.
+        std::unique_ptr<IndexedMinHeap<Timestamp>> bounds_;
+    };
+    REGISTER_INPUT_STREAM_HANDLER(ImmediateInputStreamHandler);
+
+}  // namespace mediapipe
@@ -0,0 +1,44 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/timestamp.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace mediapipe {
+
+    std::string TimestampDiff::DebugString() const { return absl::StrCat(diff_); }
+
+    std::string Timestamp::DebugString() const {
+      if (!IsSpecialValue()) {
+        return absl::StrCat(timestamp_);
+      }
+      if (*this == Unset()) return "Timestamp::Unset()";
+      if (*this == Unstarted()) return "Timestamp::Unstarted()";
+      if (*this == PreStream()) return "Timestamp::PreStream()";
+      if (*this == PostStream()) return "Timestamp::PostStream()";
+      if (*this == OneOverPostStream()) return "Timestamp::OneOverPostStream()";
+      if (*this == Done()) return "Timestamp::Done()";
+      return absl::StrCat("Timestamp(", timestamp_, ")");
+    }
+
+    std::ostream& operator<<(std::ostream& os, Timestamp timestamp) {
+      return os << timestamp.DebugString();
+    }
+
+    std::ostream& operator<<(std::ostream& os, TimestampDiff diff) {
+      return os << diff.DebugString();
+    }
+
+}  // namespace mediapipe
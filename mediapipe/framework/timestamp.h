@@ -0,0 +1,213 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Timestamps are used by the framework to order the packets of a stream.
+// A Timestamp wraps a single int64 value, conventionally in microseconds.
+// A few values at both ends of the int64 range are reserved for special
+// timestamps (Unset, PreStream, PostStream, ...); every other value is a
+// regular timestamp usable by packets. Because the special values sit at the
+// ends of the range in their natural order, comparing two timestamps of any
+// kind is a single integer comparison.
+//
+// TimestampDiff is the difference between two regular timestamps.
+
+#ifndef CUSTOM_MEDIAPIPE_TIMESTAMP_H
+#define CUSTOM_MEDIAPIPE_TIMESTAMP_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace mediapipe {
+    namespace timestamp_internal {
+        // a + b, clamped to the int64 range instead of overflowing.
+        constexpr int64_t SaturatingAdd(int64_t a, int64_t b) {
+          uint64_t sum = static_cast<uint64_t>(a) + static_cast<uint64_t>(b);
+          // The sum overflowed iff its sign differs from both operands'.
+          bool overflow =
+              ((static_cast<uint64_t>(a) ^ sum) & (static_cast<uint64_t>(b) ^ sum)) >>
+              63;
+          return overflow ? (a < 0 ? INT64_MIN : INT64_MAX)
+                          : static_cast<int64_t>(sum);
+        }
+
+        constexpr int64_t SaturatingNegate(int64_t a) {
+          return a == INT64_MIN ? INT64_MAX : -a;
+        }
+    }  // namespace timestamp_internal
+
+    class TimestampDiff {
+      public:
+        constexpr TimestampDiff() : diff_(0) {}
+        explicit constexpr TimestampDiff(int64_t diff) : diff_(diff) {}
+
+        constexpr int64_t Value() const { return diff_; }
+        // Assumes the timestamps are in microseconds.
+        constexpr double Seconds() const { return diff_ / 1.0e6; }
+
+        constexpr TimestampDiff operator+(TimestampDiff other) const {
+          return TimestampDiff(
+              timestamp_internal::SaturatingAdd(diff_, other.diff_));
+        }
+        constexpr TimestampDiff operator-(TimestampDiff other) const {
+          return TimestampDiff(timestamp_internal::SaturatingAdd(
+              diff_, timestamp_internal::SaturatingNegate(other.diff_)));
+        }
+        constexpr TimestampDiff operator-() const {
+          return TimestampDiff(timestamp_internal::SaturatingNegate(diff_));
+        }
+
+        constexpr bool operator==(TimestampDiff other) const {
+          return diff_ == other.diff_;
+        }
+        constexpr bool operator!=(TimestampDiff other) const {
+          return diff_ != other.diff_;
+        }
+        constexpr bool operator<(TimestampDiff other) const {
+          return diff_ < other.diff_;
+        }
+        constexpr bool operator<=(TimestampDiff other) const {
+          return diff_ <= other.diff_;
+        }
+        constexpr bool operator>(TimestampDiff other) const {
+          return diff_ > other.diff_;
+        }
+        constexpr bool operator>=(TimestampDiff other) const {
+          return diff_ >= other.diff_;
+        }
+
+        std::string DebugString() const;
+
+      private:
+        int64_t diff_;
+    };
+
+    class Timestamp {
+      public:
+        // Constructs Timestamp::Unset().
+        constexpr Timestamp() : timestamp_(kUnsetValue) {}
+        explicit constexpr Timestamp(int64_t timestamp) : timestamp_(timestamp) {}
+
+        // The underlying value.
+        constexpr int64_t Value() const { return timestamp_; }
+        // Assumes the timestamp is in microseconds.
+        constexpr double Seconds() const { return timestamp_ / 1.0e6; }
+        constexpr int64_t Microseconds() const { return timestamp_; }
+        static Timestamp FromSeconds(double seconds) {
+          return Timestamp(static_cast<int64_t>(seconds * 1.0e6));
+        }
+
+        // Special values. Ordered as listed, from smallest to largest.
+        //
+        // The default for a Timestamp which has not been set.
+        static constexpr Timestamp Unset() { return Timestamp(kUnsetValue); }
+        // The timestamp of a stream before any packet has been seen.
+        static constexpr Timestamp Unstarted() {
+          return Timestamp(kUnsetValue + 1);
+        }
+        // A packet with this timestamp is the only packet of its stream and
+        // precedes all regular packets.
+        static constexpr Timestamp PreStream() {
+          return Timestamp(kUnsetValue + 2);
+        }
+        // The smallest and largest regular timestamps.
+        static constexpr Timestamp Min() { return Timestamp(kUnsetValue + 3); }
+        static constexpr Timestamp Max() { return Timestamp(kDoneValue - 3); }
+        // A packet with this timestamp is the only packet of its stream and
+        // follows all regular packets.
+        static constexpr Timestamp PostStream() {
+          return Timestamp(kDoneValue - 2);
+        }
+        // The timestamp bound after a PostStream packet.
+        static constexpr Timestamp OneOverPostStream() {
+          return Timestamp(kDoneValue - 1);
+        }
+        // The timestamp bound of a closed stream.
+        static constexpr Timestamp Done() { return Timestamp(kDoneValue); }
+
+        // True for timestamps outside [Min(), Max()].
+        constexpr bool IsSpecialValue() const {
+          return timestamp_ < Min().timestamp_ || timestamp_ > Max().timestamp_;
+        }
+        // True for regular timestamps and PreStream/PostStream, i.e. the
+        // timestamps a packet may carry.
+        constexpr bool IsAllowedInStream() const {
+          return timestamp_ >= PreStream().timestamp_ &&
+                 timestamp_ <= PostStream().timestamp_;
+        }
+
+        // The smallest timestamp a packet may have after a packet with this
+        // timestamp: the next integer for regular timestamps, and
+        // OneOverPostStream() after PreStream(), Max() and PostStream(), which
+        // must be the last packet of their stream. Requires
+        // IsAllowedInStream().
+        constexpr Timestamp NextAllowedInStream() const {
+          bool last = timestamp_ >= Max().timestamp_ || *this == PreStream();
+          return Timestamp(last ? OneOverPostStream().timestamp_
+                                : timestamp_ + 1);
+        }
+
+        // Arithmetic on regular timestamps saturates at Min() and Max().
+        // Special timestamps are left unchanged, so that e.g. Done() plus an
+        // offset is still Done().
+        constexpr Timestamp operator+(TimestampDiff offset) const {
+          int64_t sum =
+              timestamp_internal::SaturatingAdd(timestamp_, offset.Value());
+          sum = sum < Min().timestamp_ ? Min().timestamp_ : sum;
+          sum = sum > Max().timestamp_ ? Max().timestamp_ : sum;
+          return Timestamp(IsSpecialValue() ? timestamp_ : sum);
+        }
+        constexpr Timestamp operator-(TimestampDiff offset) const {
+          return *this + -offset;
+        }
+        constexpr TimestampDiff operator-(Timestamp other) const {
+          return TimestampDiff(timestamp_internal::SaturatingAdd(
+              timestamp_, timestamp_internal::SaturatingNegate(other.timestamp_)));
+        }
+
+        constexpr bool operator==(Timestamp other) const {
+          return timestamp_ == other.timestamp_;
+        }
+        constexpr bool operator!=(Timestamp other) const {
+          return timestamp_ != other.timestamp_;
+        }
+        constexpr bool operator<(Timestamp other) const {
+          return timestamp_ < other.timestamp_;
+        }
+        constexpr bool operator<=(Timestamp other) const {
+          return timestamp_ <= other.timestamp_;
+        }
+        constexpr bool operator>(Timestamp other) const {
+          return timestamp_ > other.timestamp_;
+        }
+        constexpr bool operator>=(Timestamp other) const {
+          return timestamp_ >= other.timestamp_;
+        }
+
+        // Returns "Timestamp::Unset()" etc. for special values and the number
+        // for regular ones.
+        std::string DebugString() const;
+
+      private:
+        static constexpr int64_t kUnsetValue = INT64_MIN;
+        static constexpr int64_t kDoneValue = INT64_MAX;
+
+        int64_t timestamp_;
+    };
+
+    std::ostream& operator<<(std::ostream& os, Timestamp timestamp);
+    std::ostream& operator<<(std::ostream& os, TimestampDiff diff);
+}  // namespace mediapipe
+
+#endif  // CUSTOM_MEDIAPIPE_TIMESTAMP_H
@@ -0,0 +1,114 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Scheduling latency through a chain of 20 nodes, each unblocked by the
+// timestamp bound of the previous one rather than by a packet.
+
+#include <cstdint>
+#include <string>
+
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_graph.h"
+#include "mediapipe/framework/port/benchmark.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kChainLength = 20;
+
+// "tick" runs through kChainLength PassThroughCalculators into "join", which
+// also reads "in" and so can only forward a packet of "in" once the end of
+// the chain has moved past its timestamp:
+//
+//   tick -> chain_1 -> ... -> chain_<kChainLength> --+
+//                                               in --+--> join -> out
+CalculatorGraphConfig ChainConfig(int num_threads) {
+  CalculatorGraphConfig config;
+  config.set_num_threads(num_threads);
+  config.add_input_stream("in");
+  config.add_input_stream("tick");
+  std::string previous = "tick";
+  for (int i = 1; i <= kChainLength; ++i) {
+    CalculatorGraphConfig::Node* node = config.add_node();
+    node->set_calculator("PassThroughCalculator");
+    node->add_input_stream(previous);
+    previous = absl::StrCat("chain_", i);
+    node->add_output_stream(previous);
+  }
+  CalculatorGraphConfig::Node* join = config.add_node();
+  join->set_calculator("PassThroughCalculator");
+  join->add_input_stream("in");
+  join->add_input_stream(previous);
+  join->add_output_stream("out");
+  join->add_output_stream("chain_out");
+  return config;
+}
+
+// Packets sent into and delivered out of the graph.
+struct Progress {
+  bool AllDelivered() const { return delivered == sent; }
+
+  int64_t sent = 0;
+  int64_t delivered = 0;
+};
+
+// Each iteration sends one packet into "in" and advances "tick" past it,
+// with a timestamp bound if range(1) is 0 or with a packet otherwise, then
+// waits for the packet to leave the graph.
+void BM_ChainLatency(benchmark::State& state) {
+  const bool send_packets = state.range(1) != 0;
+  absl::Mutex mu;
+  Progress progress;
+  CalculatorGraph graph;
+  ABSL_CHECK_OK(graph.Initialize(ChainConfig(state.range(0))));
+  ABSL_CHECK_OK(graph.ObserveOutputStream("out", [&](const Packet&) {
+    absl::MutexLock lock(&mu);
+    ++progress.delivered;
+    return absl::OkStatus();
+  }));
+  ABSL_CHECK_OK(graph.StartRun());
+
+  for (auto _ : state) {
+    Timestamp timestamp;
+    {
+      absl::MutexLock lock(&mu);
+      timestamp = Timestamp(progress.sent++);
+    }
+    ABSL_CHECK_OK(graph.AddPacketToInputStream(
+        "in", MakePacket<int>(0).At(timestamp)));
+    if (send_packets) {
+      ABSL_CHECK_OK(graph.AddPacketToInputStream(
+          "tick", MakePacket<int>(0).At(timestamp)));
+    } else {
+      ABSL_CHECK_OK(graph.SetInputStreamTimestampBound(
+          "tick", timestamp.NextAllowedInStream()));
+    }
+    absl::MutexLock lock(&mu);
+    mu.Await(absl::Condition(&progress, &Progress::AllDelivered));
+  }
+  ABSL_CHECK_OK(graph.CloseAllInputStreams());
+  ABSL_CHECK_OK(graph.WaitUntilDone());
+}
+BENCHMARK(BM_ChainLatency)
+    ->ArgNames({"threads", "packets"})
+    ->ArgsProduct({{1, 4}, {0, 1}})
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,173 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/tool/tag_map.h"
+
+#include <set>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+
+namespace mediapipe {
+    namespace tool {
+        namespace {
+            // [A-Z_][A-Z0-9_]*
+            bool IsValidTag(absl::string_view tag) {
+              if (tag.empty() || absl::ascii_isdigit(tag[0])) return false;
+              for (char c : tag) {
+                if (!absl::ascii_isupper(c) && !absl::ascii_isdigit(c) && c != '_') {
+                  return false;
+                }
+              }
+              return true;
+            }
+
+            // [a-z_][a-z0-9_]*
+            bool IsValidName(absl::string_view name) {
+              if (name.empty() || absl::ascii_isdigit(name[0])) return false;
+              for (char c : name) {
+                if (!absl::ascii_islower(c) && !absl::ascii_isdigit(c) && c != '_') {
+                  return false;
+                }
+              }
+              return true;
+            }
+        }  // namespace
+
+        absl::Status ParseTagIndexName(absl::string_view tag_index_name,
+                                       std::string* tag, int* index,
+                                       std::string* name) {
+          std::vector<absl::string_view> parts =
+              absl::StrSplit(tag_index_name, ':');
+          absl::string_view tag_part;
+          absl::string_view name_part;
+          *index = -1;
+          if (parts.size() == 1) {
+            name_part = parts[0];
+          } else if (parts.size() == 2) {
+            tag_part = parts[0];
+            name_part = parts[1];
+            *index = 0;
+          } else if (parts.size() == 3) {
+            tag_part = parts[0];
+            name_part = parts[2];
+            if (!absl::SimpleAtoi(parts[1], index) || *index < 0 ||
+                parts[1] != absl::StrCat(*index)) {
+              return absl::InvalidArgumentError(absl::StrCat(
+                  "Invalid index in \"", tag_index_name, "\"."));
+            }
+          } else {
+            return absl::InvalidArgumentError(absl::StrCat(
+                "\"", tag_index_name,
+                "\" is not of the form \"TAG:index:name\", \"TAG:name\" or "
+                "\"name\"."));
+          }
+          if (parts.size() > 1 && !IsValidTag(tag_part)) {
+            return absl::InvalidArgumentError(absl::StrCat(
+                "Invalid tag \"", tag_part, "\" in \"", tag_index_name,
+                "\"; tags must match [A-Z_][A-Z0-9_]*."));
+          }
+          if (!IsValidName(name_part)) {
+            return absl::InvalidArgumentError(absl::StrCat(
+                "Invalid name \"", name_part, "\" in \"", tag_index_name,
+                "\"; names must match [a-z_][a-z0-9_]*."));
+          }
+          *tag = std::string(tag_part);
+          *name = std::string(name_part);
+          return absl::OkStatus();
+        }
+
+        absl::Status ParseTagIndex(absl::string_view tag_index, std::string* tag,
+                                   int* index) {
+          std::vector<absl::string_view> parts = absl::StrSplit(tag_index, ':');
+          *index = 0;
+          if (parts.size() > 2 ||
+              (parts.size() == 2 &&
+               (!absl::SimpleAtoi(parts[1], index) || *index < 0 ||
+                parts[1] != absl::StrCat(*index)))) {
+            return absl::InvalidArgumentError(absl::StrCat(
+                "\"", tag_index,
+                "\" is not of the form \"TAG:index\", \"TAG\" or \":index\"."));
+          }
+          if (!(parts.size() == 2 && parts[0].empty()) && !IsValidTag(parts[0])) {
+            return absl::InvalidArgumentError(absl::StrCat(
+                "Invalid tag \"", parts[0], "\" in \"", tag_index,
+                "\"; tags must match [A-Z_][A-Z0-9_]*."));
+          }
+          *tag = std::string(parts[0]);
+          return absl::OkStatus();
+        }
+
+        absl::StatusOr<std::shared_ptr<TagMap>> TagMap::Create(
+            const std::vector<std::string>& tag_index_names) {
+          // Names by tag and then index.
+          std::map<std::string, std::map<int, std::string>> entries;
+          int next_untagged_index = 0;
+          for (const std::string& tag_index_name : tag_index_names) {
+            std::string tag;
+            int index;
+            std::string name;
+            absl::Status status = ParseTagIndexName(tag_index_name, &tag, &index,
+                                                    &name);
+            if (!status.ok()) return status;
+            if (tag.empty()) index = next_untagged_index++;
+            if (!entries[tag].emplace(index, name).second) {
+              return absl::InvalidArgumentError(absl::StrCat(
+                  "Tag \"", tag, "\" index ", index, " is specified twice."));
+            }
+          }
+
+          auto tag_map = std::shared_ptr<TagMap>(new TagMap());
+          for (const auto& [tag, names] : entries) {
+            // Indices must be 0, ..., n-1.
+            if (names.rbegin()->first != static_cast<int>(names.size()) - 1) {
+              return absl::InvalidArgumentError(absl::StrCat(
+                  "Tag \"", tag, "\" has ", names.size(),
+                  " entries but its indices are not 0 to ", names.size() - 1,
+                  "."));
+            }
+            tag_map->tags_[tag] = {tag_map->NumEntries(),
+                                   static_cast<int>(names.size())};
+            for (const auto& index_name : names) {
+              tag_map->names_.push_back(index_name.second);
+            }
+          }
+          return tag_map;
+        }
+
+        int TagMap::GetId(absl::string_view tag, int index) const {
+          auto it = tags_.find(std::string(tag));
+          if (it == tags_.end() || index < 0 || index >= it->second.count) {
+            return -1;
+          }
+          return it->second.id + index;
+        }
+
+        int TagMap::NumEntries(absl::string_view tag) const {
+          auto it = tags_.find(std::string(tag));
+          return it == tags_.end() ? 0 : it->second.count;
+        }
+
+        std::pair<std::string, int> TagMap::TagAndIndexFromId(int id) const {
+          for (const auto& [tag, data] : tags_) {
+            if (id >= data.id && id < data.id + data.count) {
+              return {tag, id - data.id};
+            }
+          }
+          return {"", -1};
+        }
+    }  // namespace tool
+}  // namespace mediapipe
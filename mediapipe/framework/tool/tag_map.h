@@ -0,0 +1,79 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Streams of a node are specified as "TAG:index:name", "TAG:name" (index 0)
+// or "name" (empty tag, indices in order of appearance). A TagMap assigns
+// each stream a dense id, ordered by tag and then by index, so that
+// per-stream data can live in flat vectors.
+
+#ifndef MEDIAPIPE_FRAMEWORK_TOOL_TAG_MAP_H_
+#define MEDIAPIPE_FRAMEWORK_TOOL_TAG_MAP_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+namespace mediapipe {
+    namespace tool {
+        // Parses "TAG:index:name", "TAG:name" or "name". index is -1 if it was
+        // not given, in which case it is implied by the position.
+        absl::Status ParseTagIndexName(absl::string_view tag_index_name,
+                                       std::string* tag, int* index,
+                                       std::string* name);
+
+        // Parses "TAG:index", "TAG" (index 0) or ":index" (untagged), which
+        // refer to a stream of a node without naming it.
+        absl::Status ParseTagIndex(absl::string_view tag_index, std::string* tag,
+                                   int* index);
+
+        // Maps (tag, index) pairs to dense ids. Immutable once created.
+        class TagMap {
+          public:
+            static absl::StatusOr<std::shared_ptr<TagMap>> Create(
+                const std::vector<std::string>& tag_index_names);
+
+            // Returns -1 if there is no such entry.
+            int GetId(absl::string_view tag, int index) const;
+            bool HasTag(absl::string_view tag) const {
+              return tags_.find(std::string(tag)) != tags_.end();
+            }
+            // Number of entries with the given tag.
+            int NumEntries(absl::string_view tag) const;
+            int NumEntries() const { return static_cast<int>(names_.size()); }
+
+            // Stream names, by id.
+            const std::vector<std::string>& Names() const { return names_; }
+            std::pair<std::string, int> TagAndIndexFromId(int id) const;
+
+          private:
+            TagMap() = default;
+
+            struct TagData {
+              int id;
+              int count;
+            };
+            // Ordered, which makes ids ordered by tag.
+            std::map<std::string, TagData> tags_;
+            std::vector<std::string> names_;
+        };
+    }  // namespace tool
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_TOOL_TAG_MAP_H_
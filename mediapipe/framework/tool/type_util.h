@@ -0,0 +1,126 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_TOOL_TYPE_UTIL_H_
+#define MEDIAPIPE_FRAMEWORK_TOOL_TYPE_UTIL_H_
+
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace mediapipe {
+    namespace type_util_internal {
+        // The signature of this function spells out T; see TypeName<T>().
+        template <typename T>
+        constexpr std::string_view RawTypeSignature() {
+#if defined(_MSC_VER) && !defined(__clang__)
+          return __FUNCSIG__;
+#else
+          return __PRETTY_FUNCTION__;
+#endif
+        }
+
+        // Where the type starts and how much follows it in RawTypeSignature,
+        // measured on a known type.
+        inline constexpr std::string_view kProbeSignature =
+            RawTypeSignature<double>();
+        inline constexpr size_t kTypeNamePrefix = kProbeSignature.find("double");
+        inline constexpr size_t kTypeNameSuffix =
+            kProbeSignature.size() - kTypeNamePrefix - 6;
+    }  // namespace type_util_internal
+
+    // Returns the compiler's spelling of the name of T, e.g.
+    // "mediapipe::ImageFrame". Computed at compile time without RTTI. The exact
+    // spelling may differ between compilers.
+    template <typename T>
+    constexpr std::string_view TypeName() {
+      using type_util_internal::kTypeNamePrefix;
+      using type_util_internal::kTypeNameSuffix;
+      constexpr std::string_view signature =
+          type_util_internal::RawTypeSignature<T>();
+      return signature.substr(
+          kTypeNamePrefix, signature.size() - kTypeNamePrefix - kTypeNameSuffix);
+    }
+
+    namespace type_util_internal {
+        // 64-bit FNV-1a.
+        constexpr uint64_t Fnv1a(std::string_view s) {
+          uint64_t hash = 0xcbf29ce484222325ull;
+          for (char c : s) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 0x100000001b3ull;
+          }
+          return hash;
+        }
+
+        template <typename T>
+        constexpr uint64_t TypeHash() {
+          uint64_t hash = Fnv1a(TypeName<T>());
+          // 0 is reserved for the empty id.
+          return hash != 0 ? hash : 1;
+        }
+    }  // namespace type_util_internal
+
+    // An identifier for a C++ type: a hash of the type's name, computed at
+    // compile time. It does not depend on RTTI, so ids are the same with and
+    // without -fno-rtti, and comparing two ids is a single integer compare.
+    // Because ids are derived from names rather than addresses, they also
+    // agree across shared libraries.
+    //
+    // Distinct types with identical names, e.g. two `Options` structs in
+    // anonymous namespaces of different files, get the same id. Such types
+    // must not be stored in packets of the same graph.
+    //
+    // Use kTypeId<T> to obtain the id of T.
+    class TypeId {
+      public:
+        constexpr TypeId() = default;
+
+        constexpr bool operator==(const TypeId& other) const {
+          return hash_ == other.hash_;
+        }
+        constexpr bool operator!=(const TypeId& other) const {
+          return hash_ != other.hash_;
+        }
+        constexpr bool operator<(const TypeId& other) const {
+          return hash_ < other.hash_;
+        }
+
+        // The id of no type, e.g. for an empty packet.
+        constexpr bool IsEmpty() const { return hash_ == 0; }
+
+        constexpr uint64_t hash_value() const { return hash_; }
+
+        template <typename H>
+        friend H AbslHashValue(H h, const TypeId& id) {
+          return H::combine(std::move(h), id.hash_);
+        }
+
+        template <typename T>
+        static constexpr TypeId Of() {
+          return TypeId(type_util_internal::TypeHash<T>());
+        }
+
+      private:
+        constexpr explicit TypeId(uint64_t hash) : hash_(hash) {}
+
+        uint64_t hash_ = 0;
+    };
+
+    template <typename T>
+    constexpr TypeId kTypeId = TypeId::Of<std::decay_t<T>>();
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_TOOL_TYPE_UTIL_H_
@@ -0,0 +1,90 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/type_map.h"
+
+#include <memory>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/absl_log.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+
+namespace mediapipe {
+
+    namespace {
+        struct TypeEntry {
+          std::string compiler_name;
+          // The registered name if any, else the compiler name.
+          std::string name;
+        };
+
+        // Entries are never removed, so pointers to them stay valid.
+        class TypeTable {
+          public:
+            static TypeTable& Get() {
+              static TypeTable* table = new TypeTable();
+              return *table;
+            }
+
+            void Record(TypeId id, std::string_view compiler_name,
+                        std::string_view registered_name) ABSL_LOCKS_EXCLUDED(mu_) {
+              absl::MutexLock lock(&mu_);
+              std::unique_ptr<TypeEntry>& entry = entries_[id];
+              if (entry == nullptr) {
+                entry = std::make_unique<TypeEntry>();
+                entry->compiler_name = std::string(compiler_name);
+                entry->name = std::string(compiler_name);
+              } else if (entry->compiler_name != compiler_name) {
+                ABSL_LOG(FATAL) << "Types \"" << entry->compiler_name << "\" and \""
+                                << compiler_name << "\" have the same TypeId "
+                                << id.hash_value() << ".";
+              }
+              if (!registered_name.empty()) entry->name = std::string(registered_name);
+            }
+
+            const std::string* Find(TypeId id) const ABSL_LOCKS_EXCLUDED(mu_) {
+              absl::MutexLock lock(&mu_);
+              auto it = entries_.find(id);
+              return it == entries_.end() ? nullptr : &it->second->name;
+            }
+
+          private:
+            mutable absl::Mutex mu_;
+            absl::flat_hash_map<TypeId, std::unique_ptr<TypeEntry>> entries_
+                ABSL_GUARDED_BY(mu_);
+        };
+    }  // namespace
+
+    namespace type_map_internal {
+        bool RecordType(TypeId id, std::string_view compiler_name,
+                        std::string_view registered_name) {
+          TypeTable::Get().Record(id, compiler_name, registered_name);
+          return true;
+        }
+    }  // namespace type_map_internal
+
+    const std::string* MediaPipeTypeStringFromTypeId(TypeId id) {
+      return TypeTable::Get().Find(id);
+    }
+
+    std::string MediaPipeTypeStringOrDemangled(TypeId id) {
+      if (const std::string* name = MediaPipeTypeStringFromTypeId(id)) {
+        return *name;
+      }
+      return absl::StrCat("<type id ", id.hash_value(), ">");
+    }
+
+}  // namespace mediapipe
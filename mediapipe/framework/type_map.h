@@ -0,0 +1,85 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Maps TypeIds back to type names, for error messages and debugging.
+//
+// Every type stored in a packet is recorded here during static initialization
+// under its compiler spelling (see TypeName<T>()). A type can additionally be
+// given a stable, compiler independent name:
+//
+//   MEDIAPIPE_REGISTER_TYPE(::mediapipe::ImageFrame, "::mediapipe::ImageFrame");
+//
+// Recording a type whose id is already taken by a differently named type is a
+// fatal error, so the (unlikely) hash collisions of TypeId cannot go unnoticed.
+
+#ifndef CUSTOM_MEDIAPIPE_TYPE_MAP_H
+#define CUSTOM_MEDIAPIPE_TYPE_MAP_H
+
+#include <string>
+#include <string_view>
+
+#include "absl/base/attributes.h"
+#include "mediapipe/framework/tool/type_util.h"
+
+namespace mediapipe {
+    namespace type_map_internal {
+        // Records the compiler spelling of the type with the given id, and the
+        // registered name if not empty. Always returns true.
+        bool RecordType(TypeId id, std::string_view compiler_name,
+                        std::string_view registered_name);
+
+        // Records T during static initialization of any program that calls
+        // Recorded<T>().
+        template <typename T>
+        struct TypeRecord {
+          static inline const bool kRecorded =
+              RecordType(kTypeId<T>, TypeName<T>(), "");
+        };
+
+        // Makes sure T is recorded. Costs nothing at run time.
+        template <typename T>
+        inline void Recorded() {
+          static_cast<void>(TypeRecord<T>::kRecorded);
+        }
+    }  // namespace type_map_internal
+
+    // Returns the registered name of the type with the given id, else its
+    // compiler spelling, or null if the type was never recorded.
+    const std::string* MediaPipeTypeStringFromTypeId(TypeId id);
+
+    // Returns the registered name of the type with the given id, else its
+    // compiler spelling, else a string with the raw id.
+    std::string MediaPipeTypeStringOrDemangled(TypeId id);
+
+    template <typename T>
+    std::string MediaPipeTypeStringOrDemangled() {
+      if (const std::string* name = MediaPipeTypeStringFromTypeId(kTypeId<T>)) {
+        return *name;
+      }
+      return std::string(TypeName<T>());
+    }
+}  // namespace mediapipe
+
+#define MEDIAPIPE_TYPE_MAP_CONCAT_INNER(a, b) a##b
+#define MEDIAPIPE_TYPE_MAP_CONCAT(a, b) MEDIAPIPE_TYPE_MAP_CONCAT_INNER(a, b)
+
+// Registers a stable name for a type. Use at namespace scope in a .cc file.
+#define MEDIAPIPE_REGISTER_TYPE(type, type_name)                          \
+  static const bool MEDIAPIPE_TYPE_MAP_CONCAT(mediapipe_type_registered_, \
+                                              __LINE__)                   \
+      ABSL_ATTRIBUTE_UNUSED = ::mediapipe::type_map_internal::RecordType( \
+          ::mediapipe::kTypeId<type>, ::mediapipe::TypeName<type>(),      \
+          type_name)
+
+#endif  // CUSTOM_MEDIAPIPE_TYPE_MAP_H